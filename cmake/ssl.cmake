@@ -40,6 +40,26 @@ macro(CHECK_ECDH)
   endif()
 endmacro()
 
+#
+# Kernel TLS needs Linux TLS ULP headers and OpenSSL 1.1.1 key log and
+# session ticket controls.
+#
+macro(CHECK_KTLS)
+  check_cxx_source_compiles(
+    "
+#include <openssl/ssl.h>
+#include <openssl/kdf.h>
+#include <netinet/tcp.h>
+#include <linux/tls.h>
+int main() { SSL_CTX* ctx=NULL; SSL_CTX_set_keylog_callback(ctx, NULL);
+return SSL_CTX_set_num_tickets(ctx, 0) + TCP_ULP + TLS_TX + TLS_1_3_VERSION +
+TLS_CIPHER_AES_GCM_256; }
+" KTLS_OK)
+  if (KTLS_OK)
+    add_definitions(-DHAVE_KTLS)
+  endif()
+endmacro()
+
 # Make sure not to build static version with system SSL libraries.
 if (GALERA_STATIC)
   if (NOT OPENSSL_ROOT_DIR)
@@ -65,6 +85,7 @@ if (CMAKE_VERSION VERSION_GREATER "3.3.1")
   message(STATUS "GALERA_SSL_LIBS: ${GALERA_SSL_LIBS}")
   list(APPEND CMAKE_REQUIRED_LIBRARIES ${GALERA_SSL_LIBS})
   CHECK_ECDH()
+  CHECK_KTLS()
   return()
 endif()
 
@@ -110,6 +131,7 @@ endif()
 
 list(APPEND CMAKE_REQUIRED_LIBRARIES ${GALERA_SSL_LIBS})
 CHECK_ECDH()
+CHECK_KTLS()
 message(STATUS "GALERA_SSL_LIBS: ${GALERA_SSL_LIBS}")
 
 unset(HAVE_SSL_LIB CACHE)
@@ -15,11 +15,16 @@
 #include <boost/bind.hpp>
 #include <fstream>
 #include <algorithm>
+#include <limits>
 
 namespace
 {
     static std::string const CONF_KEEP_KEYS     ("ist.keep_keys");
     static bool        const CONF_KEEP_KEYS_DEFAULT (true);
+    static std::string const CONF_MAX_RATE      ("ist.max_rate");
+    static long long   const CONF_MAX_RATE_DEFAULT  (0);
+    static std::string const CONF_ADAPTIVE_RATE ("ist.adaptive_rate");
+    static bool        const CONF_ADAPTIVE_RATE_DEFAULT (false);
 }
 
 
@@ -37,7 +42,7 @@ namespace galera
                         AsyncSenderMap& asmap,
                         int version)
                 :
-                Sender (conf, asmap.gcache(), peer, version),
+                Sender (conf, asmap.gcache(), peer, version, &asmap.gcs()),
                 conf_  (conf),
                 peer_  (peer),
                 first_ (first),
@@ -82,6 +87,8 @@ galera::ist::register_params(gu::Config& conf)
     conf.add(Receiver::RECV_ADDR);
     conf.add(Receiver::RECV_BIND);
     conf.add(CONF_KEEP_KEYS);
+    conf.add(CONF_MAX_RATE);
+    conf.add(CONF_ADAPTIVE_RATE);
 }
 
 galera::ist::Receiver::Receiver(gu::Config&           conf,
@@ -622,10 +629,114 @@ void galera::ist::Receiver::interrupt()
 }
 
 
+double const galera::ist::SendThrottle::MIN_RATE(1 << 20);
+
+galera::ist::SendThrottle::SendThrottle(const gu::Config& conf,
+                                        const GcsI* const gcs)
+    :
+    gcs_      (gcs),
+    max_rate_ (conf.get<long long>(CONF_MAX_RATE, CONF_MAX_RATE_DEFAULT)),
+    adaptive_ (gcs && conf.get(CONF_ADAPTIVE_RATE,
+                               CONF_ADAPTIVE_RATE_DEFAULT)),
+    rate_     (max_rate_),
+    send_rate_(0),
+    next_     (gu_time_monotonic()),
+    last_     (next_),
+    slept_    (0)
+{
+    if (max_rate_ < 0)
+    {
+        gu_throw_error(EINVAL) << "Bad value for '" << CONF_MAX_RATE
+                               << "': " << max_rate_;
+    }
+}
+
+bool galera::ist::SendThrottle::loaded() const
+{
+    struct gcs_stats stats;
+    gcs_->get_stats(&stats);
+
+    /* effective upper limit, scaled by the number of nodes unless
+     * gcs.fc_master_slave is set */
+    return (stats.fc_requested || stats.recv_q_len > stats.fc_upper_limit / 2);
+}
+
+size_t galera::ist::SendThrottle::batch() const
+{
+    if (rate_ > 0)
+    {
+        // about 1/16 of a second worth of data
+        return std::max(static_cast<size_t>(rate_ / 16), size_t(1 << 16));
+    }
+
+    return std::numeric_limits<size_t>::max();
+}
+
+void galera::ist::SendThrottle::sent(size_t const bytes)
+{
+    long long const now(gu_time_monotonic());
+    long long const busy(now - last_ - slept_);
+
+    if (busy > 0)
+    {
+        double const rate(bytes * 1.0e9 / busy);
+        send_rate_ = send_rate_ > 0 ? 0.875 * send_rate_ + 0.125 * rate : rate;
+    }
+
+    if (adaptive_)
+    {
+        if (loaded())
+        {
+            double const base(rate_ > 0 ? rate_ : send_rate_);
+            double const min(max_rate_ > 0 ? std::min(max_rate_, MIN_RATE) :
+                             MIN_RATE);
+            rate_ = std::max(base / 2, min);
+            log_debug << "IST sender backs off to " << rate_ << " B/s";
+        }
+        else if (rate_ > 0)
+        {
+            rate_ += rate_ / 8;
+
+            if (max_rate_ > 0)
+            {
+                rate_ = std::min(rate_, max_rate_);
+            }
+            else if (rate_ > 2 * send_rate_)
+            {
+                rate_ = 0; // limit does not matter any more
+            }
+        }
+    }
+
+    slept_ = 0;
+
+    if (rate_ > 0)
+    {
+        // don't save idle time for a burst later
+        next_ = std::max(next_, now) +
+            static_cast<long long>(bytes * 1.0e9 / rate_);
+
+        if (next_ > now)
+        {
+            // cap the pause to stay responsive to cancellation even after
+            // a huge write set
+            slept_ = std::min(next_ - now, 1000000000LL);
+            struct timespec const ts = { slept_ / 1000000000,
+                                         slept_ % 1000000000 };
+            nanosleep(&ts, NULL);
+            if (next_ > now + slept_) next_ = now + slept_;
+        }
+    }
+
+    last_ = gu_time_monotonic();
+}
+
+
 galera::ist::Sender::Sender(const gu::Config&  conf,
                             gcache::GCache&    gcache,
                             const std::string& peer,
-                            int                version)
+                            int                version,
+                            const GcsI*        gcs)
     :
     io_service_(),
     socket_    (io_service_),
@@ -633,6 +744,7 @@ galera::ist::Sender::Sender(const gu::Config&  conf,
     ssl_stream_(0),
     conf_      (conf),
     gcache_    (gcache),
+    gcs_       (gcs),
     version_   (version),
     use_ssl_   (false)
 {
@@ -704,6 +816,10 @@ void galera::ist::Sender::send(wsrep_seqno_t first, wsrep_seqno_t last)
 
         if (use_ssl_ == true)
         {
+            if (conf_.get(gu::conf::ssl_ktls, false) == true)
+            {
+                p.enable_ktls_tx(*ssl_stream_);
+            }
             p.recv_handshake(*ssl_stream_);
             p.send_handshake_response(*ssl_stream_);
             ctrl = p.recv_ctrl(*ssl_stream_);
@@ -720,6 +836,8 @@ void galera::ist::Sender::send(wsrep_seqno_t first, wsrep_seqno_t last)
                 << "ist send failed, peer reported error: " << ctrl;
         }
 
+        SendThrottle throttle(conf_, gcs_);
+
         std::vector<gcache::GCache::Buffer> buf_vec(
             std::min(static_cast<size_t>(last - first + 1),
                      static_cast<size_t>(1024)));
@@ -728,51 +846,58 @@ void galera::ist::Sender::send(wsrep_seqno_t first, wsrep_seqno_t last)
         {
             GU_DBUG_SYNC_WAIT("ist_sender_send_after_get_buffers")
             //log_info << "read " << first << " + " << n_read << " from gcache";
-            for (wsrep_seqno_t i(0); i < n_read; ++i)
+            for (ssize_t begin(0), end(0); begin < n_read; begin = end)
             {
-                // log_info << "sending " << buf_vec[i].seqno_g();
+                size_t const batch(throttle.batch());
+                size_t bytes(0);
+
+                do { bytes += buf_vec[end].size(); }
+                while (++end < n_read && bytes < batch);
+
                 if (use_ssl_ == true)
                 {
-                    p.send_trx(*ssl_stream_, buf_vec[i]);
+                    p.send_trx(*ssl_stream_, &buf_vec[begin], end - begin);
                 }
                 else
                 {
-                    p.send_trx(socket_, buf_vec[i]);
+                    p.send_trx(socket_, &buf_vec[begin], end - begin);
                 }
 
-                if (buf_vec[i].seqno_g() == last)
+                throttle.sent(bytes);
+            }
+
+            if (buf_vec[n_read - 1].seqno_g() == last)
+            {
+                if (use_ssl_ == true)
+                {
+                    p.send_ctrl(*ssl_stream_, Ctrl::C_EOF);
+                }
+                else
+                {
+                    p.send_ctrl(socket_, Ctrl::C_EOF);
+                }
+                // wait until receiver closes the connection
+                try
                 {
+                    gu::byte_t b;
+                    size_t n;
                     if (use_ssl_ == true)
                     {
-                        p.send_ctrl(*ssl_stream_, Ctrl::C_EOF);
+                        n = asio::read(*ssl_stream_, asio::buffer(&b, 1));
                     }
                     else
                     {
-                        p.send_ctrl(socket_, Ctrl::C_EOF);
+                        n = asio::read(socket_, asio::buffer(&b, 1));
                     }
-                    // wait until receiver closes the connection
-                    try
+                    if (n > 0)
                     {
-                        gu::byte_t b;
-                        size_t n;
-                        if (use_ssl_ == true)
-                        {
-                            n = asio::read(*ssl_stream_, asio::buffer(&b, 1));
-                        }
-                        else
-                        {
-                            n = asio::read(socket_, asio::buffer(&b, 1));
-                        }
-                        if (n > 0)
-                        {
-                            log_warn << "received " << n
-                                     << " bytes, expected none";
-                        }
+                        log_warn << "received " << n
+                                 << " bytes, expected none";
                     }
-                    catch (asio::system_error& e)
-                    { }
-                    return;
                 }
+                catch (asio::system_error& e)
+                { }
+                return;
             }
             first += n_read;
             // resize buf_vec to avoid scanning gcache past last
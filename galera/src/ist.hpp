@@ -95,6 +95,43 @@ namespace galera
             Receiver& operator=(const Receiver&);
         };
 
+        /*! Paces IST sending to ist.max_rate. With ist.adaptive_rate the rate
+         *  is halved whenever the donor itself falls behind in applying
+         *  (its receive queue is over half of the effective flow control
+         *  limit or it has requested flow control) and grows back by 1/8 per batch
+         *  otherwise, so that IST does not push the donor into flow
+         *  control. */
+        class SendThrottle
+        {
+        public:
+
+            static double const MIN_RATE; // bytes per second
+
+            SendThrottle(const gu::Config& conf, const GcsI* gcs);
+
+            /*! @return how many bytes to send before calling sent() */
+            size_t batch() const;
+
+            /*! Accounts for sent bytes, sleeps to keep to the rate */
+            void   sent(size_t bytes);
+
+            /*! @return current rate limit in bytes per second, 0 - none */
+            double rate() const { return rate_; }
+
+        private:
+
+            bool loaded() const;
+
+            const GcsI* const gcs_;
+            double const      max_rate_;
+            bool const        adaptive_;
+            double            rate_;
+            double            send_rate_; // when not sleeping
+            long long         next_;      // when the next send may begin
+            long long         last_;      // time of the last sent() call
+            long long         slept_;     // in the last sent() call
+        };
+
         class Sender
         {
         public:
@@ -102,7 +139,8 @@ namespace galera
             Sender(const gu::Config& conf,
                    gcache::GCache& gcache,
                    const std::string& peer,
-                   int version);
+                   int version,
+                   const GcsI* gcs = 0);
             virtual ~Sender();
 
             void send(wsrep_seqno_t first, wsrep_seqno_t last);
@@ -127,6 +165,7 @@ namespace galera
             asio::ssl::stream<asio::ip::tcp::socket>* ssl_stream_;
             const gu::Config&                         conf_;
             gcache::GCache&                           gcache_;
+            const GcsI*                               gcs_;
             int                                       version_;
             bool                                      use_ssl_;
 
@@ -143,6 +182,7 @@ namespace galera
                 :
                 senders_(),
                 monitor_(),
+                gcs_(gcs),
                 gcache_(gcache) { }
             void run(const gu::Config& conf,
                      const std::string& peer,
@@ -152,10 +192,12 @@ namespace galera
             void remove(AsyncSender*, wsrep_seqno_t);
             void cancel();
             gcache::GCache& gcache() { return gcache_; }
+            const GCS_IMPL& gcs() const { return gcs_; }
         private:
             std::set<AsyncSender*> senders_;
             // use monitor instead of mutex, it provides cancellation point
             gu::Monitor            monitor_;
+            GCS_IMPL&              gcs_;
             gcache::GCache&        gcache_;
         };
 
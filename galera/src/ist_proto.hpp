@@ -13,6 +13,9 @@
 #include "gu_serialize.hpp"
 #include "gu_vector.hpp"
 #include "gu_array.hpp"
+#include "gu_asio.hpp"
+
+#include <vector>
 
 //
 // Message class must have non-virtual destructor until
@@ -245,7 +248,9 @@ namespace galera
                 raw_sent_ (0),
                 real_sent_(0),
                 version_  (version),
-                keep_keys_(keep_keys)
+                keep_keys_(keep_keys),
+                ssl_buf_  (),
+                ktls_tx_  (false)
             { }
 
             ~Proto()
@@ -262,14 +267,24 @@ namespace galera
                 }
             }
 
+            /*
+             * Hands encryption of sent data over to kernel TLS, must be
+             * called before anything is sent over the stream.
+             */
+            void enable_ktls_tx(asio::ssl::stream<asio::ip::tcp::socket>&
+                                socket)
+            {
+                ktls_tx_ = gu::ssl_enable_ktls_tx(socket);
+            }
+
             template <class ST>
             void send_handshake(ST& socket)
             {
                 Handshake  hs(version_);
                 gu::Buffer buf(hs.serial_size());
                 size_t offset(hs.serialize(&buf[0], buf.size(), 0));
-                size_t n(asio::write(socket, asio::buffer(&buf[0],
-                                                          buf.size())));
+                size_t n(write_buffers(socket, asio::buffer(&buf[0],
+                                                            buf.size())));
                 if (n != offset)
                 {
                     gu_throw_error(EPROTO) << "error sending handshake";
@@ -327,7 +342,8 @@ namespace galera
                 HandshakeResponse hsr(version_);
                 gu::Buffer buf(hsr.serial_size());
                 size_t offset(hsr.serialize(&buf[0], buf.size(), 0));
-                size_t n(asio::write(socket, asio::buffer(&buf[0], buf.size())));
+                size_t n(write_buffers(socket, asio::buffer(&buf[0],
+                                                            buf.size())));
                 if (n != offset)
                 {
                     gu_throw_error(EPROTO)
@@ -378,7 +394,8 @@ namespace galera
                 Ctrl       ctrl(version_, code);
                 gu::Buffer buf(ctrl.serial_size());
                 size_t offset(ctrl.serialize(&buf[0], buf.size(), 0));
-                size_t n(asio::write(socket, asio::buffer(&buf[0],buf.size())));
+                size_t n(write_buffers(socket, asio::buffer(&buf[0],
+                                                            buf.size())));
                 if (n != offset)
                 {
                     gu_throw_error(EPROTO) << "error sending ctrl message";
@@ -451,34 +468,86 @@ namespace galera
                     }
                 }
 
-                size_t const trx_meta_size(
-                    8 /* serial_size(buffer.seqno_g()) */ +
-                    8 /* serial_size(buffer.seqno_d()) */
-                    );
-
-                Trx trx_msg(version_, trx_meta_size + payload_size);
-
-                gu::Buffer buf(trx_msg.serial_size() + trx_meta_size);
-                size_t  offset(trx_msg.serialize(&buf[0], buf.size(), 0));
-
-                offset = gu::serialize8(buffer.seqno_g(),
-                                        &buf[0], buf.size(), offset);
-                offset = gu::serialize8(buffer.seqno_d(),
-                                        &buf[0], buf.size(), offset);
-                cbs[0] = asio::const_buffer(&buf[0], buf.size());
+                gu::byte_t buf[TRX_HEADER_MAX];
+                size_t const hdr_size(serialize_trx_header(buffer, payload_size,
+                                                           buf, sizeof(buf)));
+                cbs[0] = asio::const_buffer(buf, hdr_size);
 
                 if (gu_likely(payload_size))
                 {
-                    sent = asio::write(socket, cbs);
+                    sent = write_buffers(socket, cbs);
                 }
                 else
                 {
-                    sent = asio::write(socket, asio::buffer(cbs[0]));
+                    sent = write_buffers(socket, asio::buffer(cbs[0]));
                 }
 
+                raw_sent_  += hdr_size + buffer.size();
+                real_sent_ += sent;
+
                 log_debug << "sent " << sent << " bytes";
             }
 
+            /*
+             * Sends n consecutive write sets. When write sets go out as
+             * stored in gcache, headers and payloads of up to TRX_BATCH
+             * write sets are gathered into a single vectored write straight
+             * from gcache memory instead of issuing a write per write set.
+             */
+            template <class ST>
+            void send_trx(ST&                                 socket,
+                          const gcache::GCache::Buffer* const buffers,
+                          size_t                        const n)
+            {
+                if (!keep_keys_ && version_ >= WS_NG_VERSION)
+                {
+                    /* keys must be stripped, each write set is re-gathered */
+                    for (size_t i(0); i < n; ++i) send_trx(socket, buffers[i]);
+                    return;
+                }
+
+                gu::byte_t hdrs[TRX_BATCH][TRX_HEADER_MAX];
+                std::vector<asio::const_buffer> cbs;
+                cbs.reserve(2 * TRX_BATCH);
+
+                for (size_t i(0); i < n; i += TRX_BATCH)
+                {
+                    size_t const batch(n - i < TRX_BATCH ? n - i : TRX_BATCH);
+                    size_t raw(0);
+
+                    cbs.clear();
+
+                    for (size_t j(0); j < batch; ++j)
+                    {
+                        const gcache::GCache::Buffer& buffer(buffers[i + j]);
+                        const bool rolled_back(buffer.seqno_d() == -1);
+                        size_t const payload_size(rolled_back ?
+                                                  0 : buffer.size());
+
+                        size_t const hdr_size(
+                            serialize_trx_header(buffer, payload_size,
+                                                 hdrs[j], sizeof(hdrs[j])));
+
+                        cbs.push_back(asio::const_buffer(hdrs[j], hdr_size));
+
+                        if (gu_likely(payload_size))
+                        {
+                            cbs.push_back(asio::const_buffer(buffer.ptr(),
+                                                             payload_size));
+                        }
+
+                        raw += hdr_size + buffer.size();
+                    }
+
+                    size_t const sent(write_buffers(socket, cbs));
+
+                    raw_sent_  += raw;
+                    real_sent_ += sent;
+
+                    log_debug << "sent " << batch << " trxs, " << sent
+                              << " bytes";
+                }
+            }
 
             template <class ST>
             galera::TrxHandle*
@@ -594,12 +663,104 @@ namespace galera
 
         private:
 
+            /* trx message header + seqno_g + seqno_d */
+            static size_t const TRX_HEADER_MAX = sizeof(Message) + 16;
+            /* write sets per vectored write, two buffers each */
+            static size_t const TRX_BATCH = 32;
+            /* SSL: buffers smaller than TLS record are coalesced up to this */
+            static size_t const SSL_COALESCE_MAX = 1 << 16;
+            static size_t const SSL_RECORD_MAX   = 1 << 14;
+
+            /* plain socket writes buffer sequence with a single writev() */
+            template <class ST, class CBS>
+            size_t write_buffers(ST& socket, const CBS& cbs)
+            {
+                return asio::write(socket, cbs);
+            }
+
+            /*
+             * SSL stream seals one buffer of a sequence at a time, so that
+             * every header and small write set would go in a record of its
+             * own. Coalesce small buffers to have them encrypted into full
+             * size records, big buffers are written as they are.
+             */
+            template <class CBS>
+            size_t write_buffers(asio::ssl::stream<asio::ip::tcp::socket>&
+                                 socket, const CBS& cbs)
+            {
+                /* kernel seals gathered buffers into full size records */
+                if (ktls_tx_) return asio::write(socket.next_layer(), cbs);
+
+                size_t sent(0);
+
+                ssl_buf_.clear();
+
+                for (typename CBS::const_iterator i(cbs.begin());
+                     i != cbs.end(); ++i)
+                {
+                    size_t const size(asio::buffer_size(*i));
+
+                    if (size >= SSL_RECORD_MAX)
+                    {
+                        sent += write_ssl_buf(socket);
+                        sent += asio::write(socket, asio::buffer(*i));
+                    }
+                    else
+                    {
+                        const gu::byte_t* const ptr
+                            (asio::buffer_cast<const gu::byte_t*>(*i));
+                        ssl_buf_.insert(ssl_buf_.end(), ptr, ptr + size);
+                        if (ssl_buf_.size() >= SSL_COALESCE_MAX)
+                        {
+                            sent += write_ssl_buf(socket);
+                        }
+                    }
+                }
+
+                return sent + write_ssl_buf(socket);
+            }
+
+            size_t write_ssl_buf(asio::ssl::stream<asio::ip::tcp::socket>&
+                                 socket)
+            {
+                if (ssl_buf_.empty()) return 0;
+
+                size_t const sent(asio::write(socket,
+                                              asio::buffer(ssl_buf_)));
+                ssl_buf_.clear();
+                return sent;
+            }
+
+            size_t serialize_trx_header(const gcache::GCache::Buffer& buffer,
+                                        size_t const payload_size,
+                                        gu::byte_t* const buf,
+                                        size_t const buflen) const
+            {
+                size_t const trx_meta_size(
+                    8 /* serial_size(buffer.seqno_g()) */ +
+                    8 /* serial_size(buffer.seqno_d()) */
+                    );
+
+                Trx trx_msg(version_, trx_meta_size + payload_size);
+
+                assert(trx_msg.serial_size() + trx_meta_size <= buflen);
+
+                size_t offset(trx_msg.serialize(buf, buflen, 0));
+
+                offset = gu::serialize8(buffer.seqno_g(), buf, buflen, offset);
+                offset = gu::serialize8(buffer.seqno_d(), buf, buflen, offset);
+
+                return offset;
+            }
+
             TrxHandle::SlavePool& trx_pool_;
 
             uint64_t raw_sent_;
             uint64_t real_sent_;
             int      version_;
             bool     keep_keys_;
+            std::vector<gu::byte_t> ssl_buf_;
+            bool     ktls_tx_;
         };
     }
 }
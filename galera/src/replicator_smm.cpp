@@ -184,6 +184,12 @@ galera::ReplicatorSMM::ReplicatorSMM(const struct wsrep_init_args* args)
     local_replays_      (),
     causal_reads_       (),
     preordered_id_      (),
+    repl_latency_       (),
+    cert_latency_       (),
+    apply_wait_latency_ (),
+    apply_latency_      (),
+    commit_wait_latency_(),
+    commit_latency_     (),
     incoming_list_      (""),
     incoming_mutex_     (),
     wsrep_stats_        ()
@@ -440,7 +446,9 @@ void galera::ReplicatorSMM::apply_trx(void* recv_ctx, TrxHandle* trx)
     ApplyOrder ao(*trx);
     CommitOrder co(*trx, co_mode_);
 
+    long long t(gu_time_monotonic());
     gu_trace(apply_monitor_.enter(ao));
+    apply_wait_latency_.insert(gu_time_monotonic() - t);
     trx->set_state(TrxHandle::S_APPLYING);
 
     wsrep_trx_meta_t meta = {{state_uuid_, trx->global_seqno() },
@@ -452,16 +460,22 @@ void galera::ReplicatorSMM::apply_trx(void* recv_ctx, TrxHandle* trx)
         st_.mark_unsafe();
     }
 
+    t = gu_time_monotonic();
     gu_trace(apply_trx_ws(recv_ctx, apply_cb_, commit_cb_, *trx, meta));
     /* at this point any exception in apply_trx_ws() is fatal, not
      * catching anything. */
+    apply_latency_.insert(gu_time_monotonic() - t);
 
     if (gu_likely(co_mode_ != CommitOrder::BYPASS))
     {
+        t = gu_time_monotonic();
         gu_trace(commit_monitor_.enter(co));
+        commit_wait_latency_.insert(gu_time_monotonic() - t);
     }
     trx->set_state(TrxHandle::S_COMMITTING);
 
+    t = gu_time_monotonic();
+
     wsrep_bool_t exit_loop(false);
     wsrep_cb_status_t const rcode(
         commit_cb_(
@@ -474,6 +488,8 @@ void galera::ReplicatorSMM::apply_trx(void* recv_ctx, TrxHandle* trx)
     if (gu_unlikely (rcode != WSREP_CB_SUCCESS))
         gu_throw_fatal << "Commit failed. Trx: " << trx;
 
+    commit_latency_.insert(gu_time_monotonic() - t);
+
     if (gu_likely(co_mode_ != CommitOrder::BYPASS))
     {
         commit_monitor_.leave(co);
@@ -558,6 +574,7 @@ wsrep_status_t galera::ReplicatorSMM::replicate(TrxHandle* trx,
     trx->set_state(TrxHandle::S_REPLICATING);
 
     ssize_t rcode(-1);
+    long long const repl_start(gu_time_monotonic());
 
     do
     {
@@ -624,6 +641,7 @@ wsrep_status_t galera::ReplicatorSMM::replicate(TrxHandle* trx,
     assert(act.seqno_l != GCS_SEQNO_ILL);
     assert(act.seqno_g != GCS_SEQNO_ILL);
 
+    repl_latency_.insert(gu_time_monotonic() - repl_start);
     ++replicated_;
     replicated_bytes_ += rcode;
     trx->set_gcs_handle(-1);
@@ -779,6 +797,7 @@ wsrep_status_t galera::ReplicatorSMM::pre_commit(TrxHandle*        trx,
     ApplyOrder ao(*trx);
     CommitOrder co(*trx, co_mode_);
     bool interrupted(false);
+    long long t(gu_time_monotonic());
 
     try
     {
@@ -790,6 +809,8 @@ wsrep_status_t galera::ReplicatorSMM::pre_commit(TrxHandle*        trx,
         else throw;
     }
 
+    apply_wait_latency_.insert(gu_time_monotonic() - t);
+
     if (gu_unlikely(interrupted) || trx->state() == TrxHandle::S_MUST_ABORT)
     {
         assert(trx->state() == TrxHandle::S_MUST_ABORT);
@@ -802,6 +823,8 @@ wsrep_status_t galera::ReplicatorSMM::pre_commit(TrxHandle*        trx,
         trx->set_state(TrxHandle::S_COMMITTING);
         if (co_mode_ != CommitOrder::BYPASS)
         {
+            t = gu_time_monotonic();
+
             try
             {
                 gu_trace(commit_monitor_.enter(co));
@@ -812,6 +835,8 @@ wsrep_status_t galera::ReplicatorSMM::pre_commit(TrxHandle*        trx,
                 else throw;
             }
 
+            commit_wait_latency_.insert(gu_time_monotonic() - t);
+
             if (gu_unlikely(interrupted) ||
                 trx->state() == TrxHandle::S_MUST_ABORT)
             {
@@ -1870,7 +1895,10 @@ wsrep_status_t galera::ReplicatorSMM::cert_and_catch(TrxHandle* trx)
 {
     try
     {
-        return cert(trx);
+        long long const start(gu_time_monotonic());
+        wsrep_status_t const ret(cert(trx));
+        cert_latency_.insert(gu_time_monotonic() - start);
+        return ret;
     }
     catch (std::exception& e)
     {
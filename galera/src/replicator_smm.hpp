@@ -25,6 +25,7 @@
 #include "gcs_action_source.hpp"
 #include "ist.hpp"
 #include "gu_atomic.hpp"
+#include "gu_histogram.hpp"
 #include "saved_state.hpp"
 #include "gu_debug_sync.hpp"
 
@@ -587,6 +588,15 @@ namespace galera
 
         gu::Atomic<long long> preordered_id_; // temporary preordered ID
 
+        // phase latencies, apply and commit are measured only for
+        // slave writesets, local ones are executed by the DBMS itself
+        gu::LatencyHistogram  repl_latency_;
+        gu::LatencyHistogram  cert_latency_;
+        gu::LatencyHistogram  apply_wait_latency_;
+        gu::LatencyHistogram  apply_latency_;
+        gu::LatencyHistogram  commit_wait_latency_;
+        gu::LatencyHistogram  commit_latency_;
+
         // non-atomic stats
         std::string           incoming_list_;
         mutable gu::Mutex     incoming_mutex_;
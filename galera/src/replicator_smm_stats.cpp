@@ -270,6 +270,13 @@ galera::ReplicatorSMM::stats_get() const
     // Get gcs backend status
     gu::Status status;
     gcs_.get_status(status);
+    gcache_.get_status(status);
+    status.insert("repl_latency",        repl_latency_.to_string());
+    status.insert("cert_latency",        cert_latency_.to_string());
+    status.insert("apply_wait_latency",  apply_wait_latency_.to_string());
+    status.insert("apply_latency",       apply_latency_.to_string());
+    status.insert("commit_wait_latency", commit_wait_latency_.to_string());
+    status.insert("commit_latency",      commit_latency_.to_string());
 #ifdef GU_DBUG_ON
     status.insert("debug_sync_waiters", gu_debug_sync_waiters());
 #endif // GU_DBUG_ON
@@ -360,6 +367,13 @@ galera::ReplicatorSMM::stats_reset()
     commit_monitor_.flush_stats();
 
     cert_.stats_reset();
+
+    repl_latency_.clear();
+    cert_latency_.clear();
+    apply_wait_latency_.clear();
+    apply_latency_.clear();
+    commit_wait_latency_.clear();
+    commit_latency_.clear();
 }
 
 void
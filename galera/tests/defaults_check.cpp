@@ -2,13 +2,9 @@
 // Copyright (C) 2018-2020 Codership Oy <info@codership.com>
 //
 
-#include <wsrep_api.h>
-extern "C" int wsrep_loader(wsrep_t*);
+#include "test_provider.hpp"
 
 #include <gu_config.hpp>
-#include <gu_mutex.hpp>
-#include <gu_cond.hpp>
-#include <gu_lock.hpp>
 
 #include <gu_arch.h> // GU_WORDSIZE
 
@@ -34,6 +30,7 @@ static const char* Defaults[] =
 #ifdef GU_DBUG_ON
     "dbug",                        "",
 #endif
+    "evs.adaptive_window",         "false",
     "evs.auto_evict",              "0",
     "evs.causal_keepalive_period", "PT1S",
     "evs.debug_log_mask",          "0x1",
@@ -53,10 +50,15 @@ static const char* Defaults[] =
     "evs.user_send_window",        "2",
     "evs.version",                 "0",
     "evs.view_forget_timeout",     "P1D",
+    "gcache.cold_after",           "1024",
+    "gcache.cold_size",            "0",
 #ifndef NDEBUG
     "gcache.debug",                "0",
 #endif
     "gcache.dir",                  ".",
+    "gcache.flush_batch",          "16M",
+    "gcache.flush_policy",         "kernel",
+    "gcache.keep_history",         "PT0S",
     "gcache.keep_pages_size",      "0",
     "gcache.mem_size",             "0",
     "gcache.name",                 "./galera.cache",
@@ -64,10 +66,14 @@ static const char* Defaults[] =
     "gcache.recover",              "no",
     "gcache.size",                 "128M",
     "gcomm.thread_prio",           "",
+    "gcs.aggregate_delay",         "0",
+    "gcs.aggregate_size",          "0",
     "gcs.fc_debug",                "0",
     "gcs.fc_factor",               "1.0",
     "gcs.fc_limit",                "16",
     "gcs.fc_master_slave",         "no",
+    "gcs.fc_rate",                 "no",
+    "gcs.frag_time",               "0",
     "gcs.max_packet_size",         "64500",
     "gcs.max_throttle",            "0.25",
 #if (GU_WORDSIZE == 32)
@@ -79,9 +85,11 @@ static const char* Defaults[] =
     "gcs.sync_donor",              "no",
     "gmcast.listen_addr",          "tcp://0.0.0.0:4567",
     "gmcast.mcast_addr",           "",
+    "gmcast.mcast_mtu",            "32768",
     "gmcast.mcast_ttl",            "1",
     "gmcast.peer_timeout",         "PT3S",
     "gmcast.segment",              "0",
+    "gmcast.segment_fanout",       "0",
     "gmcast.time_wait",            "PT5S",
     "gmcast.version",              "0",
 //  "ist.recv_addr",               no default,
@@ -107,6 +115,7 @@ static const char* Defaults[] =
     "signal",                      "",
 #endif
     "socket.checksum",             "2",
+    "socket.io_threads",           "1",
     "socket.recv_buf_size",        "auto",
     "socket.send_buf_size",        "auto",
 //  "socket.ssl",                  no default,
@@ -114,6 +123,7 @@ static const char* Defaults[] =
 //  "socket.ssl_cipher",           no default,
 //  "socket.ssl_compression",      no default,
 //  "socket.ssl_key",              no default,
+//  "socket.ssl_ktls",             no default,
     NULL
 };
 
@@ -151,146 +161,24 @@ fill_in_real(DefaultsMap& map, wsrep_t& provider)
     }
 }
 
-static void
-log_cb(wsrep_log_level_t l, const char* c)
-{
-    if (l <= WSREP_LOG_ERROR) // only log errors to avoid output clutter
-    {
-        std::cerr << c << '\n';
-    }
-}
-
-struct app_ctx
-{
-    gu::Mutex mtx_;
-    gu::Cond  cond_;
-    wsrep_t   provider_;
-    bool      connected_;
-
-    app_ctx() : mtx_(), cond_(), provider_(), connected_(false) {}
-};
-
-static enum wsrep_cb_status
-view_cb(void*                    ctx,
-        void*                    recv_ctx,
-        const wsrep_view_info_t* view,
-        const char*              state,
-        size_t                   state_len,
-        void**                   sst_req,
-        size_t*                  sst_req_len)
-{
-    /* make compilers happy about unused arguments */
-    (void)recv_ctx;
-    (void)view;
-    (void)state;
-    (void)state_len;
-    (void)sst_req;
-    (void)sst_req_len;
-
-    app_ctx* c(static_cast<app_ctx*>(ctx));
-    gu::Lock lock(c->mtx_);
-
-    if (!c->connected_)
-    {
-        c->connected_ = true;
-        c->cond_.broadcast();
-    }
-
-    return WSREP_CB_SUCCESS;
-}
-
-static void
-synced_cb(void* app_ctx) { (void)app_ctx; }
-
-static void*
-recv_func(void* ctx)
-{
-    app_ctx* c(static_cast<app_ctx*>(ctx));
-    wsrep_t& provider(c->provider_);
-
-    wsrep_status_t const ret(provider.recv(&provider, NULL));
-    ck_assert_msg(WSREP_OK == ret, "recv() returned %d", ret);
-
-    return NULL;
-}
-
 START_TEST(defaults)
 {
     DefaultsMap expected_defaults, real_defaults;
 
     fill_in_expected(expected_defaults, Defaults);
 
-    app_ctx ctx;
-    wsrep_t& provider(ctx.provider_);
-    int ret = wsrep_status_t(wsrep_loader(&provider));
-    ck_assert(WSREP_OK == ret);
-
-    struct wsrep_init_args init_args =
-        {
-            &ctx, // void* app_ctx
-
-            /* Configuration parameters */
-            NULL, // const char* node_name
-            NULL, // const char* node_address
-            NULL, // const char* node_incoming
-            NULL, // const char* data_dir
-            NULL, // const char* options
-            0,    // int         proto_ver
-
-            /* Application initial state information. */
-            NULL, // const wsrep_gtid_t* state_id
-            NULL, // const char*         state
-            0,    // size_t              state_len
-
-            /* Application callbacks */
-            log_cb, // wsrep_log_cb_t      logger_cb
-            view_cb,// wsrep_view_cb_t     view_handler_cb
-
-            /* Applier callbacks */
-            NULL, // wsrep_apply_cb_t      apply_cb
-            NULL, // wsrep_commit_cb_t     commit_cb
-            NULL, // wsrep_unordered_cb_t  unordered_cb
-
-            /* State Snapshot Transfer callbacks */
-            NULL, // wsrep_sst_donate_cb_t sst_donate_cb
-            synced_cb,// wsrep_synced_cb_t synced_cb
-        };
-    ret = provider.init(&provider, &init_args);
-    ck_assert(WSREP_OK == ret);
-
-    /* some defaults are set only on connection attmept */
-    ret = provider.connect(&provider, "cluster_name", "gcomm://", "", false);
-    ck_assert_msg(WSREP_OK == ret, "connect() returned %d", ret);
-
-    fill_in_real(real_defaults, provider);
-    mark_point();
-
-    if (WSREP_OK == ret) /* if connect() was a success, need to disconnect() */
     {
-        /* some configuration change events need to be received */
-        gu_thread_t recv_thd;
-        gu_thread_create(&recv_thd, NULL, recv_func, &ctx);
-
-        mark_point();
+        TestProvider tp(NULL);
+        wsrep_t& provider(tp.provider());
 
-        /* @todo:there is a race condition in the library when disconnect() is
-         * called right after connect() */
-        { /* sync with view callback */
-            gu::Lock lock(ctx.mtx_);
-            while(!ctx.connected_) lock.wait(ctx.cond_);
-        }
+        /* some defaults are set only on connection attmept */
+        wsrep_status_t const ret(tp.connect());
+        ck_assert_msg(WSREP_OK == ret, "connect() returned %d", ret);
 
+        fill_in_real(real_defaults, provider);
         mark_point();
-
-        ret = provider.disconnect(&provider);
-        ck_assert_msg(WSREP_OK == ret, "disconnect() returned %d", ret);
-
-        ret = gu_thread_join(recv_thd, NULL);
-        ck_assert_msg(0 == ret, "Could not join thread: %d (%s)",
-                      ret, strerror(ret));
     }
 
-    provider.free(&provider);
     mark_point();
 
     /* cleanup files */
@@ -21,6 +21,7 @@ extern Suite* service_thd_suite();
 extern Suite* ist_suite();
 extern Suite* saved_state_suite();
 extern Suite* defaults_suite();
+extern Suite* stats_suite();
 
 static suite_creator_t suites[] =
 {
@@ -33,6 +34,7 @@ static suite_creator_t suites[] =
     ist_suite,
     saved_state_suite,
     defaults_suite,
+    stats_suite,
     0
 };
 
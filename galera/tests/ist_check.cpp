@@ -12,6 +12,7 @@
 #include "gu_arch.h"
 #include "replicator_smm.hpp"
 #include <check.h>
+#include <limits>
 
 using namespace galera;
 
@@ -382,6 +383,78 @@ START_TEST(test_ist_v5)
 }
 END_TEST
 
+START_TEST(test_ist_send_throttle)
+{
+    gu::Config conf;
+    galera::ReplicatorSMM::InitConfig(conf, NULL, NULL);
+
+    // no limit by default
+    galera::ist::SendThrottle unlimited(conf, 0);
+    ck_assert(unlimited.rate() == 0);
+    ck_assert(unlimited.batch() == std::numeric_limits<size_t>::max());
+
+    size_t const rate(16 << 20);
+    conf.set("ist.max_rate", rate);
+    conf.set("ist.adaptive_rate", true);
+
+    // dummy GCS never falls behind, rate must stay at maximum
+    galera::DummyGcs gcs;
+    galera::ist::SendThrottle throttle(conf, &gcs);
+    ck_assert(throttle.rate() == rate);
+    ck_assert(throttle.batch() == rate / 16);
+
+    long long const begin(gu_time_monotonic());
+    throttle.sent(rate / 4);
+    throttle.sent(rate / 4);
+    long long const elapsed(gu_time_monotonic() - begin);
+
+    ck_assert_msg(elapsed >= 450000000LL, "elapsed %lld ns", elapsed);
+    ck_assert(throttle.rate() == rate);
+}
+END_TEST
+
+/* reports a fixed receive queue length against a given flow control limit */
+class LoadedGcs : public galera::DummyGcs
+{
+public:
+    LoadedGcs(int const q_len, long const fc_limit)
+        : galera::DummyGcs(), q_len_(q_len), fc_limit_(fc_limit) {}
+
+    void get_stats(gcs_stats* stats) const
+    {
+        galera::DummyGcs::get_stats(stats);
+        stats->recv_q_len     = q_len_;
+        stats->fc_upper_limit = fc_limit_;
+    }
+
+private:
+    int  const q_len_;
+    long const fc_limit_;
+};
+
+START_TEST(test_ist_send_throttle_fc_limit)
+{
+    gu::Config conf;
+    galera::ReplicatorSMM::InitConfig(conf, NULL, NULL);
+
+    size_t const rate(16 << 20);
+    conf.set("ist.max_rate", rate);
+    conf.set("ist.adaptive_rate", true);
+
+    // queue of 10 is over half of the configured limit of 16
+    LoadedGcs loaded(10, 16);
+    galera::ist::SendThrottle backs_off(conf, &loaded);
+    backs_off.sent(1 << 16);
+    ck_assert(backs_off.rate() == rate / 2);
+
+    // but not over half of the effective limit scaled for 4 nodes
+    LoadedGcs scaled(10, 32);
+    galera::ist::SendThrottle keeps_rate(conf, &scaled);
+    keeps_rate.sent(1 << 16);
+    ck_assert(keeps_rate.rate() == rate);
+}
+END_TEST
+
 Suite* ist_suite()
 {
     Suite* s  = suite_create("ist");
@@ -416,5 +489,10 @@ Suite* ist_suite()
     tcase_add_test(tc, test_ist_v5);
     suite_add_tcase(s, tc);
 
+    tc = tcase_create("test_ist_send_throttle");
+    tcase_add_test(tc, test_ist_send_throttle);
+    tcase_add_test(tc, test_ist_send_throttle_fc_limit);
+    suite_add_tcase(s, tc);
+
     return s;
 }
@@ -0,0 +1,134 @@
+//
+// Copyright (C) 2021 Codership Oy <info@codership.com>
+//
+
+#include "test_provider.hpp"
+
+#include <gu_logger.hpp>
+
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include <check.h>
+
+#include <unistd.h> // unlink()
+
+static const char* const cache_name = "stats_check.cache";
+
+/* Returns value of a string status variable, empty string if not found */
+static std::string
+status_value(wsrep_t& provider, const char* const name)
+{
+    std::string ret;
+    struct wsrep_stats_var* const stats(provider.stats_get(&provider));
+    ck_assert(NULL != stats);
+
+    for (struct wsrep_stats_var* sv(stats); sv->name != NULL; ++sv)
+    {
+        if (!strcmp(sv->name, name))
+        {
+            ck_assert(WSREP_VAR_STRING == sv->type);
+            ret = sv->value._string;
+            break;
+        }
+    }
+
+    provider.stats_free(&provider, stats);
+
+    return ret;
+}
+
+/* Returns sample count of the histogram formatted in status variable */
+static long long
+status_count(wsrep_t& provider, const char* const name)
+{
+    std::string const val(status_value(provider, name));
+    ck_assert_msg(!val.empty(), "Status variable %s not found", name);
+
+    /* p50/p99/p99.9/max/count */
+    size_t const pos(val.rfind('/'));
+    ck_assert_msg(pos != std::string::npos, "Malformed %s: '%s'",
+                  name, val.c_str());
+
+    return strtoll(val.c_str() + pos + 1, NULL, 10);
+}
+
+START_TEST(latency_histograms)
+{
+    std::string const options(std::string("gcache.name=") + cache_name +
+                              "; gcache.size=1M; pc.recovery=no");
+
+    TestProvider tp(options.c_str());
+    wsrep_t& provider(tp.provider());
+
+    int ret = tp.connect();
+    ck_assert_msg(WSREP_OK == ret, "connect() returned %d", ret);
+
+    mark_point();
+
+    ck_assert_msg(0 == status_count(provider, "repl_latency"),
+                  "repl_latency: '%s'",
+                  status_value(provider, "repl_latency").c_str());
+
+    wsrep_ws_handle_t ws = { 1, NULL };
+
+    const char key_str[] = "key";
+    wsrep_buf_t const key_part = { key_str, sizeof(key_str) };
+    wsrep_key_t const key = { &key_part, 1 };
+    ret = provider.append_key(&provider, &ws, &key, 1, WSREP_KEY_EXCLUSIVE,
+                              true);
+    ck_assert_msg(WSREP_OK == ret, "append_key() returned %d", ret);
+
+    const char data_str[] = "data";
+    wsrep_buf_t const data = { data_str, sizeof(data_str) };
+    ret = provider.append_data(&provider, &ws, &data, 1, WSREP_DATA_ORDERED,
+                               true);
+    ck_assert_msg(WSREP_OK == ret, "append_data() returned %d", ret);
+
+    wsrep_trx_meta_t meta;
+    ret = provider.pre_commit(&provider, 1, &ws, WSREP_FLAG_COMMIT, &meta);
+    ck_assert_msg(WSREP_OK == ret, "pre_commit() returned %d", ret);
+
+    ret = provider.post_commit(&provider, &ws);
+    ck_assert_msg(WSREP_OK == ret, "post_commit() returned %d", ret);
+
+    /* local writeset goes through replication, certification and both
+     * monitors, apply and commit are done by the application */
+    ck_assert(1 == status_count(provider, "repl_latency"));
+    ck_assert(1 == status_count(provider, "cert_latency"));
+    ck_assert(1 == status_count(provider, "apply_wait_latency"));
+    ck_assert(1 == status_count(provider, "commit_wait_latency"));
+    ck_assert(0 == status_count(provider, "apply_latency"));
+    ck_assert(0 == status_count(provider, "commit_latency"));
+
+    provider.stats_reset(&provider);
+
+    ck_assert(0 == status_count(provider, "repl_latency"));
+    ck_assert(0 == status_count(provider, "cert_latency"));
+    ck_assert(0 == status_count(provider, "apply_wait_latency"));
+    ck_assert(0 == status_count(provider, "commit_wait_latency"));
+
+    mark_point();
+
+    tp.disconnect();
+    mark_point();
+
+    /* cleanup files */
+    ::unlink(cache_name);
+    ::unlink("grastate.dat");
+}
+END_TEST
+
+Suite* stats_suite()
+{
+    Suite* s = suite_create("Stats");
+    TCase* tc;
+
+    tc = tcase_create("stats");
+    tcase_add_test(tc, latency_histograms);
+    tcase_set_timeout(tc, 120);
+    suite_add_tcase(s, tc);
+
+    return s;
+}
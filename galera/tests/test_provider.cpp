@@ -0,0 +1,153 @@
+/* Copyright (C) 2021 Codership Oy <info@codership.com> */
+
+#include "test_provider.hpp"
+
+extern "C" int wsrep_loader(wsrep_t*);
+
+#include <gu_lock.hpp>
+
+#include <cstring>
+#include <iostream>
+
+#include <check.h>
+
+TestProvider::TestProvider (const char* const options)
+    :
+    mtx_      (),
+    cond_     (),
+    provider_ (),
+    recv_thd_ (),
+    connected_(false),
+    synced_   (false)
+{
+    int ret = wsrep_status_t(wsrep_loader(&provider_));
+    ck_assert(WSREP_OK == ret);
+
+    struct wsrep_init_args init_args =
+        {
+            this, // void* app_ctx
+
+            /* Configuration parameters */
+            NULL, // const char* node_name
+            NULL, // const char* node_address
+            NULL, // const char* node_incoming
+            NULL, // const char* data_dir
+            options, // const char* options
+            0,    // int         proto_ver
+
+            /* Application initial state information. */
+            NULL, // const wsrep_gtid_t* state_id
+            NULL, // const char*         state
+            0,    // size_t              state_len
+
+            /* Application callbacks */
+            log_cb, // wsrep_log_cb_t      logger_cb
+            view_cb,// wsrep_view_cb_t     view_handler_cb
+
+            /* Applier callbacks */
+            NULL, // wsrep_apply_cb_t      apply_cb
+            NULL, // wsrep_commit_cb_t     commit_cb
+            NULL, // wsrep_unordered_cb_t  unordered_cb
+
+            /* State Snapshot Transfer callbacks */
+            NULL, // wsrep_sst_donate_cb_t sst_donate_cb
+            synced_cb,// wsrep_synced_cb_t synced_cb
+        };
+    ret = provider_.init(&provider_, &init_args);
+    ck_assert(WSREP_OK == ret);
+}
+
+TestProvider::~TestProvider ()
+{
+    if (connected_) disconnect();
+
+    provider_.free(&provider_);
+}
+
+wsrep_status_t
+TestProvider::connect ()
+{
+    wsrep_status_t const ret(provider_.connect(&provider_, "cluster_name",
+                                               "gcomm://", "", false));
+    if (WSREP_OK != ret) return ret;
+
+    connected_ = true;
+
+    /* configuration change events need to be received */
+    gu_thread_create(&recv_thd_, NULL, recv_func, this);
+
+    /* @todo:there is a race condition in the library when disconnect() is
+     * called right after connect(), writesets can be replicated only after
+     * the node has synced */
+    gu::Lock lock(mtx_);
+    while (!synced_) lock.wait(cond_);
+
+    return ret;
+}
+
+void
+TestProvider::disconnect ()
+{
+    wsrep_status_t const ret(provider_.disconnect(&provider_));
+    ck_assert_msg(WSREP_OK == ret, "disconnect() returned %d", ret);
+
+    int const err(gu_thread_join(recv_thd_, NULL));
+    ck_assert_msg(0 == err, "Could not join thread: %d (%s)",
+                  err, strerror(err));
+
+    connected_ = false;
+}
+
+void
+TestProvider::log_cb (wsrep_log_level_t l, const char* c)
+{
+    if (l <= WSREP_LOG_ERROR) // only log errors to avoid output clutter
+    {
+        std::cerr << c << '\n';
+    }
+}
+
+enum wsrep_cb_status
+TestProvider::view_cb (void*                    ctx,
+                       void*                    recv_ctx,
+                       const wsrep_view_info_t* view,
+                       const char*              state,
+                       size_t                   state_len,
+                       void**                   sst_req,
+                       size_t*                  sst_req_len)
+{
+    /* make compilers happy about unused arguments */
+    (void)ctx;
+    (void)recv_ctx;
+    (void)view;
+    (void)state;
+    (void)state_len;
+    (void)sst_req;
+    (void)sst_req_len;
+
+    return WSREP_CB_SUCCESS;
+}
+
+void
+TestProvider::synced_cb (void* ctx)
+{
+    TestProvider* const p(static_cast<TestProvider*>(ctx));
+    gu::Lock lock(p->mtx_);
+
+    if (!p->synced_)
+    {
+        p->synced_ = true;
+        p->cond_.broadcast();
+    }
+}
+
+void*
+TestProvider::recv_func (void* ctx)
+{
+    wsrep_t& provider(static_cast<TestProvider*>(ctx)->provider_);
+
+    wsrep_status_t const ret(provider.recv(&provider, NULL));
+    ck_assert_msg(WSREP_OK == ret, "recv() returned %d", ret);
+
+    return NULL;
+}
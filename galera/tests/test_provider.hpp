@@ -0,0 +1,60 @@
+/* Copyright (C) 2021 Codership Oy <info@codership.com> */
+
+#ifndef _TEST_PROVIDER_HPP_
+#define _TEST_PROVIDER_HPP_
+
+#include <wsrep_api.h>
+
+#include <gu_logger.hpp>
+#include <gu_mutex.hpp>
+#include <gu_cond.hpp>
+#include <gu_threads.h>
+
+/* Provider library bootstrapping a single node cluster */
+class TestProvider
+{
+public:
+
+    /* loads and initializes provider with options (may be NULL) */
+    explicit TestProvider (const char* options);
+
+    /* disconnects if connected and frees provider */
+    ~TestProvider ();
+
+    wsrep_t& provider() { return provider_; }
+
+    /* bootstraps a new cluster and waits until the node is synced,
+     * returns connect() status */
+    wsrep_status_t connect ();
+
+    /* leaves the cluster and waits for the receiving thread to exit */
+    void disconnect ();
+
+private:
+
+    static void
+    log_cb (wsrep_log_level_t l, const char* c);
+
+    static enum wsrep_cb_status
+    view_cb (void* ctx, void* recv_ctx, const wsrep_view_info_t* view,
+             const char* state, size_t state_len,
+             void** sst_req, size_t* sst_req_len);
+
+    static void
+    synced_cb (void* ctx);
+
+    static void*
+    recv_func (void* ctx);
+
+    gu::Mutex   mtx_;
+    gu::Cond    cond_;
+    wsrep_t     provider_;
+    gu_thread_t recv_thd_;
+    bool        connected_;
+    bool        synced_;
+
+    TestProvider (const TestProvider&);
+    TestProvider& operator= (const TestProvider&);
+};
+
+#endif /* _TEST_PROVIDER_HPP_ */
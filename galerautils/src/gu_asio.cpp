@@ -7,6 +7,21 @@
 
 #include <boost/bind.hpp>
 
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#ifdef HAVE_KTLS
+#include <openssl/evp.h>
+#include <openssl/kdf.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <linux/tls.h>
+#ifndef SOL_TLS
+#define SOL_TLS 282
+#endif /* SOL_TLS */
+#endif /* HAVE_KTLS */
+
 void gu::ssl_register_params(gu::Config& conf)
 {
     // register SSL config parameters
@@ -17,6 +32,7 @@ void gu::ssl_register_params(gu::Config& conf)
     conf.add(gu::conf::ssl_cert);
     conf.add(gu::conf::ssl_ca);
     conf.add(gu::conf::ssl_password_file);
+    conf.add(gu::conf::ssl_ktls);
 }
 
 /* checks if all mandatory SSL options are set */
@@ -76,6 +92,16 @@ void gu::ssl_init_options(gu::Config& conf)
         }
         conf.set(conf::ssl_compression, compression);
 
+        // kernel TLS
+        bool const ktls(conf.get(conf::ssl_ktls, false));
+#ifndef HAVE_KTLS
+        if (ktls == true)
+        {
+            log_warn << "kernel TLS is not supported by this build, '"
+                     << conf::ssl_ktls << "' has no effect";
+        }
+#endif /* HAVE_KTLS */
+        conf.set(conf::ssl_ktls, ktls);
 
         // verify that asio::ssl::context can be initialized with provided
         // values
@@ -121,6 +147,49 @@ namespace
     };
 }
 
+#ifdef HAVE_KTLS
+namespace
+{
+    // TLS 1.3 traffic secret used for sending, captured from the key log
+    // callback during handshake. OpenSSL provides no other way to get it.
+    extern "C" void ktls_secret_free(void*, void* ptr, CRYPTO_EX_DATA*,
+                                     int, long, void*)
+    {
+        delete static_cast<std::string*>(ptr);
+    }
+
+    int ktls_ex_index()
+    {
+        static int const index(SSL_get_ex_new_index(0, NULL, NULL, NULL,
+                                                    ktls_secret_free));
+        return index;
+    }
+
+    extern "C" void ktls_keylog_cb(const SSL* ssl, const char* line)
+    {
+        static std::string const client("CLIENT_TRAFFIC_SECRET_0 ");
+        static std::string const server("SERVER_TRAFFIC_SECRET_0 ");
+
+        std::string const& label(SSL_is_server(ssl) ? server : client);
+        if (label.compare(0, label.size(), line, label.size()) != 0) return;
+
+        // line format: <label> <client random> <secret>, all hex
+        const char* const hex(::strrchr(line, ' ') + 1);
+        std::string* const secret(new std::string());
+        for (const char* h(hex); h[0] != '\0' && h[1] != '\0'; h += 2)
+        {
+            unsigned int byte;
+            if (::sscanf(h, "%2x", &byte) != 1) break;
+            secret->push_back(static_cast<char>(byte));
+        }
+
+        SSL* const s(const_cast<SSL*>(ssl));
+        delete static_cast<std::string*>(SSL_get_ex_data(s, ktls_ex_index()));
+        SSL_set_ex_data(s, ktls_ex_index(), secret);
+    }
+}
+#endif /* HAVE_KTLS */
+
 static void throw_last_SSL_error(const std::string& msg)
 {
     unsigned long const err(ERR_peek_last_error());
@@ -189,6 +258,19 @@ void gu::ssl_prepare_context(const gu::Config& conf, asio::ssl::context& ctx,
         ctx.set_options(asio::ssl::context::no_sslv2 |
                         asio::ssl::context::no_sslv3 |
                         asio::ssl::context::no_tlsv1);
+#ifdef HAVE_KTLS
+        if (conf.get(conf::ssl_ktls, false) == true)
+        {
+            // Once transmit keys are in the kernel, OpenSSL must not send
+            // anything by itself: no session tickets after TLS 1.3
+            // handshake, no renegotiation.
+            SSL_CTX_set_keylog_callback(ctx.impl(), ktls_keylog_cb);
+            SSL_CTX_set_num_tickets(ctx.impl(), 0);
+#ifdef SSL_OP_NO_RENEGOTIATION
+            SSL_CTX_set_options(ctx.impl(), SSL_OP_NO_RENEGOTIATION);
+#endif /* SSL_OP_NO_RENEGOTIATION */
+        }
+#endif /* HAVE_KTLS */
     }
     catch (asio::system_error& ec)
     {
@@ -202,3 +284,207 @@ void gu::ssl_prepare_context(const gu::Config& conf, asio::ssl::context& ctx,
                                << param << "'";
     }
 }
+
+#ifdef HAVE_KTLS
+// TLS 1.2 key block, RFC 5246 6.3
+static bool ktls_tls12_keys(SSL* const ssl, const EVP_MD* const md,
+                            size_t const key_len,
+                            unsigned char* const key,
+                            unsigned char* const salt)
+{
+    unsigned char master[SSL_MAX_MASTER_KEY_LENGTH];
+    size_t const master_len(SSL_SESSION_get_master_key(SSL_get_session(ssl),
+                                                       master,
+                                                       sizeof(master)));
+    unsigned char randoms[2 * SSL3_RANDOM_SIZE];
+    SSL_get_server_random(ssl, randoms, SSL3_RANDOM_SIZE);
+    SSL_get_client_random(ssl, randoms + SSL3_RANDOM_SIZE, SSL3_RANDOM_SIZE);
+
+    // AEAD ciphers have no MAC keys: client key, server key,
+    // client implicit IV, server implicit IV
+    static size_t const salt_len(4);
+    unsigned char block[2 * (32 + salt_len)];
+    size_t block_len(2 * (key_len + salt_len));
+
+    static const unsigned char label[] = "key expansion";
+    EVP_PKEY_CTX* const pctx(EVP_PKEY_CTX_new_id(EVP_PKEY_TLS1_PRF, NULL));
+    bool const ok(pctx != NULL &&
+                  EVP_PKEY_derive_init(pctx) > 0 &&
+                  EVP_PKEY_CTX_set_tls1_prf_md(pctx, md) > 0 &&
+                  EVP_PKEY_CTX_set1_tls1_prf_secret(pctx, master,
+                                                    master_len) > 0 &&
+                  EVP_PKEY_CTX_add1_tls1_prf_seed(pctx, label,
+                                                  sizeof(label) - 1) > 0 &&
+                  EVP_PKEY_CTX_add1_tls1_prf_seed(pctx, randoms,
+                                                  sizeof(randoms)) > 0 &&
+                  EVP_PKEY_derive(pctx, block, &block_len) > 0);
+    EVP_PKEY_CTX_free(pctx);
+    OPENSSL_cleanse(master, sizeof(master));
+    if (!ok) return false;
+
+    bool const server(SSL_is_server(ssl));
+    ::memcpy(key, block + (server ? key_len : 0), key_len);
+    ::memcpy(salt, block + 2 * key_len + (server ? salt_len : 0), salt_len);
+    OPENSSL_cleanse(block, sizeof(block));
+    return true;
+}
+
+// HKDF-Expand-Label with empty context, RFC 8446 7.1
+static bool ktls_hkdf_expand_label(const EVP_MD* const md,
+                                   const std::string& secret,
+                                   const std::string& label,
+                                   unsigned char* const out,
+                                   size_t out_len)
+{
+    std::string const full_label("tls13 " + label);
+    std::string info;
+    info.push_back(static_cast<char>(out_len >> 8));
+    info.push_back(static_cast<char>(out_len));
+    info.push_back(static_cast<char>(full_label.size()));
+    info += full_label;
+    info.push_back(0);
+
+    EVP_PKEY_CTX* const pctx(EVP_PKEY_CTX_new_id(EVP_PKEY_HKDF, NULL));
+    bool const ok(pctx != NULL &&
+                  EVP_PKEY_derive_init(pctx) > 0 &&
+                  EVP_PKEY_CTX_hkdf_mode(
+                      pctx, EVP_PKEY_HKDEF_MODE_EXPAND_ONLY) > 0 &&
+                  EVP_PKEY_CTX_set_hkdf_md(pctx, md) > 0 &&
+                  EVP_PKEY_CTX_set1_hkdf_key(
+                      pctx,
+                      reinterpret_cast<const unsigned char*>(secret.data()),
+                      secret.size()) > 0 &&
+                  EVP_PKEY_CTX_add1_hkdf_info(
+                      pctx,
+                      reinterpret_cast<const unsigned char*>(info.data()),
+                      info.size()) > 0 &&
+                  EVP_PKEY_derive(pctx, out, &out_len) > 0);
+    EVP_PKEY_CTX_free(pctx);
+    return ok;
+}
+
+size_t gu::ssl_ktls_tx_info(SSL* const ssl, ssl_ktls_info& info)
+{
+    const SSL_CIPHER* const cipher(SSL_get_current_cipher(ssl));
+    int const version(SSL_version(ssl));
+
+    if (cipher == NULL ||
+        (version != TLS1_2_VERSION && version != TLS1_3_VERSION))
+    {
+        log_info << "kernel TLS is not supported for "
+                 << SSL_get_version(ssl) << ", using SSL library";
+        return 0;
+    }
+
+    ::memset(&info, 0, sizeof(info));
+
+    unsigned char* key;
+    unsigned char* salt;
+    unsigned char* iv;
+    unsigned char* rec_seq;
+    size_t         key_len;
+    size_t         info_len;
+
+    switch (SSL_CIPHER_get_cipher_nid(cipher))
+    {
+    case NID_aes_128_gcm:
+        info.gcm128.info.cipher_type = TLS_CIPHER_AES_GCM_128;
+        key      = info.gcm128.key;
+        salt     = info.gcm128.salt;
+        iv       = info.gcm128.iv;
+        rec_seq  = info.gcm128.rec_seq;
+        key_len  = TLS_CIPHER_AES_GCM_128_KEY_SIZE;
+        info_len = sizeof(info.gcm128);
+        break;
+    case NID_aes_256_gcm:
+        info.gcm256.info.cipher_type = TLS_CIPHER_AES_GCM_256;
+        key      = info.gcm256.key;
+        salt     = info.gcm256.salt;
+        iv       = info.gcm256.iv;
+        rec_seq  = info.gcm256.rec_seq;
+        key_len  = TLS_CIPHER_AES_GCM_256_KEY_SIZE;
+        info_len = sizeof(info.gcm256);
+        break;
+    default:
+        log_info << "kernel TLS is not supported for cipher "
+                 << SSL_CIPHER_get_name(cipher) << ", using SSL library";
+        return 0;
+    }
+
+    // Record sequence numbers of the first application data record:
+    // in TLS 1.2 the encrypted Finished message is record 0, in TLS 1.3
+    // application traffic keys are fresh as no session tickets are sent.
+    // The 8 byte explicit nonce of TLS 1.2 follows the sequence number
+    // as well.
+    const EVP_MD* const md(SSL_CIPHER_get_handshake_digest(cipher));
+    bool ok(md != NULL);
+
+    if (version == TLS1_2_VERSION)
+    {
+        info.info.version = TLS_1_2_VERSION;
+        rec_seq[TLS_CIPHER_AES_GCM_128_REC_SEQ_SIZE - 1] = 1;
+        ::memcpy(iv, rec_seq, TLS_CIPHER_AES_GCM_128_IV_SIZE);
+        ok = ok && ktls_tls12_keys(ssl, md, key_len, key, salt);
+    }
+    else
+    {
+        info.info.version = TLS_1_3_VERSION;
+        const std::string* const secret(
+            static_cast<const std::string*>(
+                SSL_get_ex_data(ssl, ktls_ex_index())));
+        unsigned char nonce[TLS_CIPHER_AES_GCM_128_SALT_SIZE +
+                            TLS_CIPHER_AES_GCM_128_IV_SIZE];
+        ok = ok && secret != NULL &&
+            ktls_hkdf_expand_label(md, *secret, "key", key, key_len) &&
+            ktls_hkdf_expand_label(md, *secret, "iv", nonce, sizeof(nonce));
+        ::memcpy(salt, nonce, TLS_CIPHER_AES_GCM_128_SALT_SIZE);
+        ::memcpy(iv, nonce + TLS_CIPHER_AES_GCM_128_SALT_SIZE,
+                 TLS_CIPHER_AES_GCM_128_IV_SIZE);
+        OPENSSL_cleanse(nonce, sizeof(nonce));
+    }
+
+    if (ok == false)
+    {
+        log_warn << "failed to derive kernel TLS keys, using SSL library";
+        OPENSSL_cleanse(&info, sizeof(info));
+        return 0;
+    }
+
+    return info_len;
+}
+#endif /* HAVE_KTLS */
+
+bool gu::ssl_enable_ktls_tx(asio::ssl::stream<asio::ip::tcp::socket>& socket)
+{
+#ifdef HAVE_KTLS
+    SSL* const ssl(socket.impl()->ssl);
+    ssl_ktls_info info;
+    size_t const info_len(ssl_ktls_tx_info(ssl, info));
+    if (info_len == 0) return false;
+
+    int const fd(socket.lowest_layer().native());
+    bool ok(true);
+
+    if (::setsockopt(fd, SOL_TCP, TCP_ULP, "tls", sizeof("tls")) ||
+        ::setsockopt(fd, SOL_TLS, TLS_TX, &info, info_len))
+    {
+        // Until TLS_TX is set, TLS ULP passes data through as it is.
+        int const err(errno);
+        log_info << "enabling kernel TLS failed: " << err << " ("
+                 << ::strerror(err) << "), using SSL library";
+        ok = false;
+    }
+    else
+    {
+        log_info << "kernel TLS enabled for sending, cipher "
+                 << SSL_get_cipher_name(ssl);
+    }
+
+    OPENSSL_cleanse(&info, sizeof(info));
+
+    return ok;
+#else
+    (void)socket;
+    return false;
+#endif /* HAVE_KTLS */
+}
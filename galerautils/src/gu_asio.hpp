@@ -51,6 +51,10 @@
 #include <string>
 #include <fstream>
 
+#ifdef HAVE_KTLS
+#include <linux/tls.h>
+#endif /* HAVE_KTLS */
+
 
 namespace gu
 {
@@ -85,6 +89,8 @@ namespace gu
         const std::string ssl_ca("socket.ssl_ca");
         /// SSL password file
         const std::string ssl_password_file("socket.ssl_password_file");
+        /// Offload encryption of sent data to kernel TLS
+        const std::string ssl_ktls("socket.ssl_ktls");
     }
 
     // Return the cipher in use
@@ -112,6 +118,29 @@ namespace gu
     void ssl_prepare_context(const gu::Config&, asio::ssl::context&,
                              bool verify_peer_cert = true);
 
+    // Install transmit keys of a freshly handshaked SSL stream to kernel
+    // TLS of the underlying TCP socket. On success data must be written
+    // to stream.next_layer() in plain, the stream may be used only for
+    // reading from then on. Returns false if kernel TLS could not be
+    // enabled, the stream is left intact then.
+    bool ssl_enable_ktls_tx(asio::ssl::stream<asio::ip::tcp::socket>&);
+
+#ifdef HAVE_KTLS
+    // Kernel TLS transmit state, info.cipher_type selects the member
+    union ssl_ktls_info
+    {
+        struct tls_crypto_info               info;
+        struct tls12_crypto_info_aes_gcm_128 gcm128;
+        struct tls12_crypto_info_aes_gcm_256 gcm256;
+    };
+
+    // Derive transmit keys and record state of a freshly handshaked SSL
+    // connection for kernel TLS. Returns the size of info filled in,
+    // 0 if the protocol or cipher is not supported or key derivation
+    // failed.
+    size_t ssl_ktls_tx_info(SSL*, ssl_ktls_info& info);
+#endif /* HAVE_KTLS */
+
     //
     // Address manipulation helpers
     //
@@ -186,6 +186,30 @@ namespace gu
         log_debug << "Flushed file '" << name_ << "'";
     }
 
+    void
+    FileDescriptor::write_back (off_t const offset,
+                                off_t const length,
+                                bool  const wait) const
+    {
+#if defined(SYNC_FILE_RANGE_WRITE)
+        unsigned int const flags(wait ?
+                                 SYNC_FILE_RANGE_WAIT_BEFORE |
+                                 SYNC_FILE_RANGE_WRITE       |
+                                 SYNC_FILE_RANGE_WAIT_AFTER  :
+                                 SYNC_FILE_RANGE_WRITE);
+
+        if (sync_file_range (fd_, offset, length, flags) < 0)
+        {
+            gu_throw_error(errno) << "sync_file_range(" << offset << ", "
+                                  << length << ") failed on '" << name_ << '\'';
+        }
+#else
+        /* no way to kick off writeback of a range, fall back to full sync
+         * when waiting was requested */
+        if (wait) sync();
+#endif
+    }
+
     bool
     FileDescriptor::write_byte (off_t offset)
     {
@@ -37,6 +37,11 @@ public:
 
     void               sync()  const;
 
+    /*! Initiates writeback of the given file range. If wait is true,
+     *  returns only when the range has reached the disk. */
+    void               write_back(off_t offset, off_t length,
+                                  bool wait = false) const;
+
     void               unlink() const { ::unlink (name_.c_str()); }
 
 private:
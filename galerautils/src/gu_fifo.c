@@ -25,6 +25,7 @@
 #include "gu_mem.h"
 #include "gu_threads.h"
 #include "gu_log.h"
+#include "gu_time.h"
 #include "gu_fifo.h"
 
 #include "galerautils.h"
@@ -248,8 +249,10 @@ void gu_fifo_open (gu_fifo_t* q)
     fifo_unlock (q);
 }
 
-/* lock the queue and wait if it is empty */
-static inline int fifo_lock_get (gu_fifo_t *q)
+/* lock the queue and wait if it is empty, but not past the deadline if it
+ * is given. Timed out waiter leaves get_wait as is: a putter may then signal
+ * nobody, but no signal is lost for other waiters. */
+static inline int fifo_lock_get (gu_fifo_t *q, const struct timespec* deadline)
 {
     int ret = 0;
 
@@ -259,7 +262,10 @@ static inline int fifo_lock_get (gu_fifo_t *q)
 #ifndef NDEBUG
         q->locked = false;
 #endif
-        ret = -gu_cond_wait (&q->get_cond, &q->lock);
+        if (deadline)
+            ret = -gu_cond_timedwait (&q->get_cond, &q->lock, deadline);
+        else
+            ret = -gu_cond_wait (&q->get_cond, &q->lock);
 #ifndef NDEBUG
         q->locked = true;
 #endif
@@ -327,7 +333,7 @@ static inline int fifo_unlock_put (gu_fifo_t *q)
  *  otherwise blocks. Or returns NULL if FIFO is closed. */
 void* gu_fifo_get_head (gu_fifo_t* q, int* err)
 {
-    *err = fifo_lock_get (q);
+    *err = fifo_lock_get (q, NULL);
 
     if (gu_likely(-ECANCELED != *err && q->used)) {
         return (FIFO_PTR(q, q->head));
@@ -339,6 +345,26 @@ void* gu_fifo_get_head (gu_fifo_t* q, int* err)
     }
 }
 
+/*! Same as gu_fifo_get_head(), but blocks only until the deadline. */
+void* gu_fifo_get_head_until (gu_fifo_t* q, int* err, long long deadline)
+{
+    if (GU_TIME_ETERNITY == deadline) return gu_fifo_get_head (q, err);
+
+    struct timespec const ts = { (time_t)(deadline / 1000000000LL),
+                                 (long)  (deadline % 1000000000LL) };
+
+    *err = fifo_lock_get (q, &ts);
+
+    if (gu_likely(-ECANCELED != *err && q->used)) {
+        return (FIFO_PTR(q, q->head));
+    }
+    else {
+        assert (q->get_err || -ETIMEDOUT == *err);
+        fifo_unlock (q);
+        return NULL;
+    }
+}
+
 /*! Unprotected helper for gu_fifo_pop_head() and gu_fifo_clear() */
 static inline
 void fifo_advance_head (gu_fifo_t* q)
@@ -43,6 +43,11 @@ extern void  gu_fifo_release   (gu_fifo_t *q);
               -ECANCELED - gets were canceled on the queue
  * @retval pointer to head item or NULL if error occured */
 extern void* gu_fifo_get_head  (gu_fifo_t* q, int* err);
+/*! Same as gu_fifo_get_head(), but blocks only until the deadline
+ * (calendar time in nanoseconds, GU_TIME_ETERNITY - forever)
+ * @param err can also be -ETIMEDOUT if the deadline has passed */
+extern void* gu_fifo_get_head_until (gu_fifo_t* q, int* err,
+                                     long long deadline);
 /*! Advance FIFO head pointer and release FIFO. */
 extern void  gu_fifo_pop_head  (gu_fifo_t* q);
 /*! Lock FIFO and get pointer to tail item */
@@ -3,6 +3,7 @@
  */
 
 #include "gu_histogram.hpp"
+#include "gu_atomic.hpp"
 #include "gu_logger.hpp"
 #include "gu_throw.hpp"
 #include "gu_string_utils.hpp" // strsplit()
@@ -12,6 +13,8 @@
 #include <sstream>
 #include <limits>
 #include <vector>
+#include <cstring>
+#include <algorithm>
 
 gu::Histogram::Histogram(const std::string& vals)
     :
@@ -103,3 +106,124 @@ std::string gu::Histogram::to_string() const
     os << *this;
     return os.str();
 }
+
+gu::LatencyHistogram::LatencyHistogram()
+    :
+    max_(0)
+{
+    ::memset(cnt_, 0, sizeof(cnt_));
+}
+
+int gu::LatencyHistogram::bucket(long long const ns)
+{
+    static long long const sub(1 << SUB_BITS);
+
+    if (ns < sub) return (ns > 0 ? ns : 0);
+
+    int const msb(63 - __builtin_clzll(ns));
+
+    if (msb >= MAX_BITS) return BUCKETS - 1;
+
+    int const shift(msb - SUB_BITS);
+
+    return ((shift + 1) << SUB_BITS) + ((ns >> shift) & (sub - 1));
+}
+
+long long gu::LatencyHistogram::bucket_max(int const b)
+{
+    static int const sub(1 << SUB_BITS);
+
+    if (b < sub) return b;
+
+    int const shift((b >> SUB_BITS) - 1);
+
+    return ((static_cast<long long>(sub + (b & (sub - 1))) + 1) << shift) - 1;
+}
+
+void gu::LatencyHistogram::insert(long long const ns)
+{
+    gu_atomic_fetch_and_add(&cnt_[bucket(ns)], 1);
+
+    long long m;
+    gu_atomic_get(&max_, &m);
+    while (ns > m && !__sync_bool_compare_and_swap(&max_, m, ns))
+    {
+        gu_atomic_get(&max_, &m);
+    }
+}
+
+void gu::LatencyHistogram::clear()
+{
+    for (int b(0); b < BUCKETS; ++b)
+    {
+        gu_atomic_fetch_and_and(&cnt_[b], 0);
+    }
+    gu_atomic_fetch_and_and(&max_, 0);
+}
+
+long long gu::LatencyHistogram::count() const
+{
+    long long ret(0);
+
+    for (int b(0); b < BUCKETS; ++b)
+    {
+        long long c;
+        gu_atomic_get(&cnt_[b], &c);
+        ret += c;
+    }
+
+    return ret;
+}
+
+long long gu::LatencyHistogram::max() const
+{
+    long long m;
+    gu_atomic_get(&max_, &m);
+    return m;
+}
+
+long long gu::LatencyHistogram::percentile(double const p) const
+{
+    long long cnt[BUCKETS];
+    long long total(0);
+
+    for (int b(0); b < BUCKETS; ++b)
+    {
+        gu_atomic_get(&cnt_[b], &cnt[b]);
+        total += cnt[b];
+    }
+
+    if (0 == total) return 0;
+
+    long long const rank(std::max(1LL, static_cast<long long>(
+                                      std::ceil(p * total))));
+    long long sum(0);
+
+    for (int b(0); b < BUCKETS; ++b)
+    {
+        sum += cnt[b];
+        if (sum >= rank) return std::min(bucket_max(b), max());
+    }
+
+    return max();
+}
+
+std::ostream& gu::operator<<(std::ostream& os, const LatencyHistogram& hs)
+{
+    static double const s(1.0e-9);
+
+    os << hs.percentile(0.5)   * s << "/"
+       << hs.percentile(0.99)  * s << "/"
+       << hs.percentile(0.999) * s << "/"
+       << hs.max()             * s << "/"
+       << hs.count();
+
+    return os;
+}
+
+std::string gu::LatencyHistogram::to_string() const
+{
+    std::ostringstream os;
+    os << *this;
+    return os.str();
+}
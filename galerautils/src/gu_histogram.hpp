@@ -7,6 +7,7 @@
 
 #include <map>
 #include <ostream>
+#include <string>
 
 namespace gu
 {
@@ -23,6 +24,40 @@ namespace gu
     };
 
     std::ostream& operator<<(std::ostream&, const Histogram&);
+
+    /*
+     * Lock-free histogram of latencies in nanoseconds for hot paths.
+     * Buckets are powers of two split into 8 linear sub-buckets each, so
+     * that percentiles are reported with at most 12.5% error.
+     */
+    class LatencyHistogram
+    {
+    public:
+        LatencyHistogram();
+        /* can be called concurrently from several threads */
+        void insert(long long ns);
+        void clear();
+        long long count() const;
+        long long max() const;
+        /* p is in (0.0, 1.0], returns the upper bound of the bucket */
+        long long percentile(double p) const;
+        friend std::ostream& operator<<(std::ostream&,
+                                        const LatencyHistogram&);
+        std::string to_string() const;
+    private:
+        static int const SUB_BITS = 3;
+        static int const MAX_BITS = 40; // ~18 minutes
+        static int const BUCKETS  = (MAX_BITS - SUB_BITS + 1) << SUB_BITS;
+
+        static int       bucket(long long ns);
+        static long long bucket_max(int b);
+
+        mutable long long cnt_[BUCKETS]; // mutable for atomic reads
+        mutable long long max_;
+    };
+
+    /* p50/p99/p99.9/max/n, latencies in seconds */
+    std::ostream& operator<<(std::ostream&, const LatencyHistogram&);
 }
 
 #endif // _gu_histogram_hpp_
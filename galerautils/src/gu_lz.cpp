@@ -0,0 +1,201 @@
+//
+// Copyright (C) 2021 Codership Oy <info@codership.com>
+//
+
+#include "gu_lz.hpp"
+#include "gu_throw.hpp"
+#include "gu_types.hpp"
+
+#include <cstring>
+#include <stdint.h>
+
+static size_t const MIN_MATCH     = 4;
+static size_t const LAST_LITERALS = 5;  // block always ends with literals
+static size_t const MF_LIMIT      = 12; // no match starts closer to the end
+static size_t const MAX_OFFSET    = 65535;
+static int    const HASH_LOG      = 12;
+static unsigned int const RUN_MASK = 15;
+
+static inline uint32_t
+read32(const gu::byte_t* const p)
+{
+    uint32_t ret;
+    ::memcpy(&ret, p, sizeof(ret));
+    return ret;
+}
+
+static inline uint32_t
+hash32(uint32_t const v)
+{
+    return (v * 2654435761U) >> (32 - HASH_LOG);
+}
+
+/* room needed to encode length len with RUN_MASK in token */
+static inline size_t
+length_size(size_t const len)
+{
+    return len >= RUN_MASK ? (len - RUN_MASK) / 255 + 1 : 0;
+}
+
+static inline gu::byte_t*
+write_length(gu::byte_t* op, size_t len)
+{
+    for (len -= RUN_MASK; len >= 255; len -= 255) *op++ = 255;
+    *op++ = gu::byte_t(len);
+    return op;
+}
+
+size_t
+gu::lz_compress(const void* const src_ptr, size_t const len,
+                void* const dst_ptr, size_t const dst_len)
+{
+    const byte_t* const src(static_cast<const byte_t*>(src_ptr));
+    byte_t*       const dst(static_cast<byte_t*>(dst_ptr));
+    byte_t*       const dst_end(dst + dst_len);
+
+    uint32_t table[1 << HASH_LOG];
+    ::memset(table, 0, sizeof(table));
+
+    size_t const mf_limit(len > MF_LIMIT ? len - MF_LIMIT : 0);
+    size_t const match_limit(len > LAST_LITERALS ? len - LAST_LITERALS : 0);
+
+    size_t  ip(0);
+    size_t  anchor(0);
+    byte_t* op(dst);
+
+    while (ip < mf_limit)
+    {
+        uint32_t const seq(read32(src + ip));
+        uint32_t const h(hash32(seq));
+        size_t   const ref(table[h]);
+
+        table[h] = uint32_t(ip);
+
+        if (ref >= ip || ip - ref > MAX_OFFSET || read32(src + ref) != seq)
+        {
+            ++ip;
+            continue;
+        }
+
+        size_t mlen(MIN_MATCH);
+        while (ip + mlen < match_limit && src[ref + mlen] == src[ip + mlen])
+        {
+            ++mlen;
+        }
+
+        size_t const lit(ip - anchor);
+        size_t const mcode(mlen - MIN_MATCH);
+
+        if (size_t(dst_end - op) <
+            1 + length_size(lit) + lit + 2 + length_size(mcode)) return 0;
+
+        byte_t* const token(op++);
+        *token = byte_t(((lit < RUN_MASK ? lit : RUN_MASK) << 4) |
+                        (mcode < RUN_MASK ? mcode : RUN_MASK));
+
+        if (lit >= RUN_MASK) op = write_length(op, lit);
+        ::memcpy(op, src + anchor, lit);
+        op += lit;
+
+        size_t const offset(ip - ref);
+        *op++ = byte_t(offset);
+        *op++ = byte_t(offset >> 8);
+
+        if (mcode >= RUN_MASK) op = write_length(op, mcode);
+
+        ip += mlen;
+        anchor = ip;
+    }
+
+    /* last literals */
+    size_t const lit(len - anchor);
+
+    if (size_t(dst_end - op) < 1 + length_size(lit) + lit) return 0;
+
+    *op++ = byte_t((lit < RUN_MASK ? lit : RUN_MASK) << 4);
+    if (lit >= RUN_MASK) op = write_length(op, lit);
+    ::memcpy(op, src + anchor, lit);
+    op += lit;
+
+    return op - dst;
+}
+
+static inline size_t
+read_length(const gu::byte_t* const src, size_t const len, size_t& ip)
+{
+    size_t ret(0);
+    gu::byte_t b;
+
+    do
+    {
+        if (gu_unlikely(ip >= len))
+        {
+            gu_throw_error(EINVAL) << "Truncated compressed block";
+        }
+        b = src[ip++];
+        ret += b;
+    }
+    while (255 == b);
+
+    return ret;
+}
+
+size_t
+gu::lz_decompress(const void* const src_ptr, size_t const len,
+                  void* const dst_ptr, size_t const dst_len)
+{
+    const byte_t* const src(static_cast<const byte_t*>(src_ptr));
+    byte_t*       const dst(static_cast<byte_t*>(dst_ptr));
+
+    size_t ip(0);
+    size_t op(0);
+
+    while (ip < len)
+    {
+        unsigned int const token(src[ip++]);
+
+        size_t lit(token >> 4);
+        if (RUN_MASK == lit) lit += read_length(src, len, ip);
+
+        if (gu_unlikely(lit > len - ip || lit > dst_len - op))
+        {
+            gu_throw_error(EINVAL) << "Compressed block literals overflow";
+        }
+
+        ::memcpy(dst + op, src + ip, lit);
+        ip += lit;
+        op += lit;
+
+        if (ip == len) return op; // last record
+
+        if (gu_unlikely(len - ip < 2))
+        {
+            gu_throw_error(EINVAL) << "Truncated compressed block";
+        }
+
+        size_t const offset(src[ip] | (size_t(src[ip + 1]) << 8));
+        ip += 2;
+
+        if (gu_unlikely(0 == offset || offset > op))
+        {
+            gu_throw_error(EINVAL) << "Invalid match offset " << offset
+                                   << " at " << op;
+        }
+
+        size_t mlen(token & RUN_MASK);
+        if (RUN_MASK == mlen) mlen += read_length(src, len, ip);
+        mlen += MIN_MATCH;
+
+        if (gu_unlikely(mlen > dst_len - op))
+        {
+            gu_throw_error(EINVAL) << "Compressed block match overflow";
+        }
+
+        /* matches may overlap the output, copy bytewise */
+        const byte_t* from(dst + op - offset);
+        for (byte_t* to(dst + op); to < dst + op + mlen;) *to++ = *from++;
+        op += mlen;
+    }
+
+    gu_throw_error(EINVAL) << "Compressed block is not terminated";
+}
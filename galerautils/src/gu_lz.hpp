@@ -0,0 +1,61 @@
+//
+// Copyright (C) 2021 Codership Oy <info@codership.com>
+//
+
+//!
+// @file Fast byte-oriented LZ77 compression of memory blocks.
+//
+// Block format follows that of LZ4: a sequence of (token, literals,
+// 2-byte little-endian offset, extra match length) records terminated by
+// a record that carries only literals. Trades compression ratio for speed,
+// intended for large, repetitive buffers like cached write sets.
+//
+// Format guarantees:
+// - lz_compress() output is a valid LZ4 block, it respects LZ4 end of
+//   block conditions (the last match starts at least 12 bytes and ends at
+//   least 5 bytes before the end), so LZ4_decompress_safe() can decode it;
+// - lz_decompress() accepts any LZ4 block, e.g. one made by
+//   LZ4_compress_default();
+// - a block carries neither its decompressed size nor a checksum. Callers
+//   must store the size and compare it with what lz_decompress() returns;
+// - lz_decompress() never reads beyond len bytes of src nor writes beyond
+//   dst_len bytes of dst. Malformed input makes it throw. A truncated
+//   block either throws or decodes to fewer bytes than the original.
+//   Corruption that keeps the block well-formed goes undetected.
+//
+
+#ifndef GU_LZ_HPP
+#define GU_LZ_HPP
+
+#include <cstddef>
+
+namespace gu
+{
+    //!
+    // @return maximum compressed size of a block of len bytes
+    //
+    inline size_t lz_compress_bound(size_t const len)
+    {
+        return len + len/255 + 16;
+    }
+
+    //!
+    // @brief Compresses len bytes from src into dst.
+    //
+    // @return compressed size or 0 if it does not fit into dst_len bytes
+    //
+    size_t lz_compress(const void* src, size_t len,
+                       void* dst, size_t dst_len);
+
+    //!
+    // @brief Decompresses len bytes from src into dst.
+    //
+    // @return decompressed size
+    // @throws gu::Exception (EINVAL) if src is not a valid compressed block
+    //         or decompressed data does not fit into dst_len bytes
+    //
+    size_t lz_decompress(const void* src, size_t len,
+                         void* dst, size_t dst_len);
+}
+
+#endif // GU_LZ_HPP
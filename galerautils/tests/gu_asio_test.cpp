@@ -6,6 +6,16 @@
 #include "gu_asio.hpp"
 #include "gu_asio_test.hpp"
 
+#ifdef HAVE_KTLS
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+
+#include <cstdio>
+#include <cstring>
+#include <unistd.h> // unlink()
+#endif /* HAVE_KTLS */
+
 START_TEST(test_make_address_v4)
 {
     asio::ip::address a(gu::make_address("10.2.14.1"));
@@ -48,6 +58,267 @@ START_TEST(test_make_address_v6_link_local_with_scope_id)
 }
 END_TEST
 
+#ifdef HAVE_KTLS
+
+//
+// Kernel TLS keys are verified by decrypting records sent by OpenSSL
+// over an in-memory BIO pair, so no kTLS capable kernel is needed.
+//
+
+static const char* const ktls_key_file("gu_asio_test_ktls.key");
+static const char* const ktls_cert_file("gu_asio_test_ktls.crt");
+
+// Writes a self-signed P-256 key and certificate for the test contexts
+static void ktls_write_cert()
+{
+    EVP_PKEY* pkey(NULL);
+    EVP_PKEY_CTX* const pctx(EVP_PKEY_CTX_new_id(EVP_PKEY_EC, NULL));
+    ck_assert(pctx != NULL);
+    ck_assert(EVP_PKEY_keygen_init(pctx) > 0);
+    ck_assert(EVP_PKEY_CTX_set_ec_paramgen_curve_nid(
+                  pctx, NID_X9_62_prime256v1) > 0);
+    ck_assert(EVP_PKEY_keygen(pctx, &pkey) > 0);
+    EVP_PKEY_CTX_free(pctx);
+
+    X509* const x509(X509_new());
+    ck_assert(x509 != NULL);
+    ASN1_INTEGER_set(X509_get_serialNumber(x509), 1);
+    X509_gmtime_adj(X509_getm_notBefore(x509), 0);
+    X509_gmtime_adj(X509_getm_notAfter(x509), 3600);
+    X509_set_pubkey(x509, pkey);
+    X509_NAME* const name(X509_get_subject_name(x509));
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+                               reinterpret_cast<const unsigned char*>(
+                                   "gu_asio_test"), -1, -1, 0);
+    X509_set_issuer_name(x509, name);
+    ck_assert(X509_sign(x509, pkey, EVP_sha256()) > 0);
+
+    FILE* f(::fopen(ktls_key_file, "w"));
+    ck_assert(f != NULL);
+    ck_assert(PEM_write_PrivateKey(f, pkey, NULL, NULL, 0, NULL, NULL));
+    ::fclose(f);
+
+    f = ::fopen(ktls_cert_file, "w");
+    ck_assert(f != NULL);
+    ck_assert(PEM_write_X509(f, x509));
+    ::fclose(f);
+
+    X509_free(x509);
+    EVP_PKEY_free(pkey);
+}
+
+// Runs handshake between client and server until both are done
+static void ktls_handshake(SSL* const client, SSL* const server)
+{
+    bool client_done(false);
+    bool server_done(false);
+
+    for (int i(0); i < 100 && !(client_done && server_done); ++i)
+    {
+        if (!client_done) client_done = (SSL_do_handshake(client) == 1);
+        if (!server_done) server_done = (SSL_do_handshake(server) == 1);
+    }
+
+    ck_assert_msg(client_done && server_done, "handshake failed");
+}
+
+// Decrypts a single TLS record with kernel TLS info and returns plaintext
+// with TLS 1.3 inner content type stripped
+template <typename CryptoInfo>
+static std::string ktls_decrypt(const CryptoInfo& ci,
+                                const EVP_CIPHER* const cipher,
+                                const unsigned char* rec, size_t rec_len)
+{
+    static size_t const hdr_len(5);
+    static size_t const tag_len(16);
+
+    ck_assert(rec_len > hdr_len + tag_len);
+    ck_assert(rec[0] == 0x17); // application data
+    ck_assert(size_t((rec[3] << 8) | rec[4]) == rec_len - hdr_len);
+
+    unsigned char nonce[sizeof(ci.salt) + sizeof(ci.iv)];
+    unsigned char aad[13];
+    size_t aad_len;
+    const unsigned char* ct(rec + hdr_len);
+    size_t ct_len(rec_len - hdr_len - tag_len);
+
+    ::memcpy(nonce, ci.salt, sizeof(ci.salt));
+
+    if (ci.info.version == TLS_1_2_VERSION)
+    {
+        // explicit nonce precedes ciphertext, OpenSSL chooses its own
+        // while the kernel sends ci.iv, the receiver takes it as it is
+        ::memcpy(nonce + sizeof(ci.salt), ct, sizeof(ci.iv));
+        ct     += sizeof(ci.iv);
+        ct_len -= sizeof(ci.iv);
+
+        ::memcpy(aad, ci.rec_seq, sizeof(ci.rec_seq));
+        ::memcpy(aad + sizeof(ci.rec_seq), rec, 3);
+        aad[11] = static_cast<unsigned char>(ct_len >> 8);
+        aad[12] = static_cast<unsigned char>(ct_len);
+        aad_len = sizeof(aad);
+    }
+    else
+    {
+        // per-record nonce is the static IV xored with sequence number
+        ::memcpy(nonce + sizeof(ci.salt), ci.iv, sizeof(ci.iv));
+        for (size_t i(0); i < sizeof(ci.rec_seq); ++i)
+        {
+            nonce[sizeof(nonce) - sizeof(ci.rec_seq) + i] ^= ci.rec_seq[i];
+        }
+
+        ::memcpy(aad, rec, hdr_len);
+        aad_len = hdr_len;
+    }
+
+    std::vector<unsigned char> out(ct_len);
+    int len(0);
+    EVP_CIPHER_CTX* const ctx(EVP_CIPHER_CTX_new());
+    ck_assert(ctx != NULL);
+    ck_assert(EVP_DecryptInit_ex(ctx, cipher, NULL, NULL, NULL) > 0);
+    ck_assert(EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_IVLEN,
+                                  sizeof(nonce), NULL) > 0);
+    ck_assert(EVP_DecryptInit_ex(ctx, NULL, NULL, ci.key, nonce) > 0);
+    ck_assert(EVP_DecryptUpdate(ctx, NULL, &len, aad, aad_len) > 0);
+    ck_assert(EVP_DecryptUpdate(ctx, &out[0], &len, ct, ct_len) > 0);
+    ck_assert(EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, tag_len,
+                                  const_cast<unsigned char*>(ct + ct_len))
+              > 0);
+    int const ret(EVP_DecryptFinal_ex(ctx, &out[0] + len, &len));
+    EVP_CIPHER_CTX_free(ctx);
+    ck_assert_msg(ret > 0, "record authentication failed");
+
+    if (ci.info.version == TLS_1_3_VERSION)
+    {
+        ck_assert(out.back() == 0x17); // inner content type
+        out.pop_back();
+    }
+
+    return std::string(out.begin(), out.end());
+}
+
+// Derives kernel TLS info of the sender and checks that its first
+// application data record decrypts with it.
+static void ktls_check_tx(SSL* const sender, BIO* const peer_bio,
+                          int const version, int const cipher_type)
+{
+    gu::ssl_ktls_info info;
+    size_t const info_len(gu::ssl_ktls_tx_info(sender, info));
+    ck_assert(info.info.version == version);
+    ck_assert(info.info.cipher_type == cipher_type);
+
+    std::string const msg("kernel TLS test message");
+    ck_assert(SSL_write(sender, msg.data(), msg.size()) == int(msg.size()));
+
+    unsigned char rec[1024];
+    int const rec_len(BIO_read(peer_bio, rec, sizeof(rec)));
+    ck_assert(rec_len > 0);
+
+    std::string plain;
+    if (cipher_type == TLS_CIPHER_AES_GCM_128)
+    {
+        ck_assert(info_len == sizeof(info.gcm128));
+        plain = ktls_decrypt(info.gcm128, EVP_aes_128_gcm(), rec, rec_len);
+    }
+    else
+    {
+        ck_assert(info_len == sizeof(info.gcm256));
+        plain = ktls_decrypt(info.gcm256, EVP_aes_256_gcm(), rec, rec_len);
+    }
+
+    ck_assert_msg(plain == msg, "decrypted '%s'", plain.c_str());
+}
+
+static void ktls_test(int const ssl_version, const char* const cipher,
+                      int const version, int const cipher_type)
+{
+    ktls_write_cert();
+
+    gu::Config conf;
+    gu::ssl_register_params(conf);
+    conf.set(gu::conf::ssl_key, ktls_key_file);
+    conf.set(gu::conf::ssl_cert, ktls_cert_file);
+    conf.set(gu::conf::ssl_ktls, "yes");
+    gu::ssl_init_options(conf);
+
+    asio::io_service io_service;
+    asio::ssl::context ctx(io_service, asio::ssl::context::sslv23);
+    gu::ssl_prepare_context(conf, ctx);
+
+    SSL* const client(SSL_new(ctx.impl()));
+    SSL* const server(SSL_new(ctx.impl()));
+    ck_assert(client != NULL && server != NULL);
+
+    SSL* const ssls[] = { client, server };
+    for (size_t i(0); i < 2; ++i)
+    {
+        ck_assert(SSL_set_min_proto_version(ssls[i], ssl_version));
+        ck_assert(SSL_set_max_proto_version(ssls[i], ssl_version));
+        if (ssl_version == TLS1_3_VERSION)
+        {
+            ck_assert(SSL_set_ciphersuites(ssls[i], cipher));
+        }
+        else
+        {
+            ck_assert(SSL_set_cipher_list(ssls[i], cipher));
+        }
+    }
+
+    BIO* client_bio;
+    BIO* server_bio;
+    ck_assert(BIO_new_bio_pair(&client_bio, 0, &server_bio, 0));
+    SSL_set_bio(client, client_bio, client_bio);
+    SSL_set_bio(server, server_bio, server_bio);
+    SSL_set_connect_state(client);
+    SSL_set_accept_state(server);
+
+    ktls_handshake(client, server);
+
+    ck_assert(SSL_version(server) == ssl_version);
+    ck_assert_msg(::strcmp(SSL_get_cipher_name(server), cipher) == 0,
+                  "negotiated %s", SSL_get_cipher_name(server));
+
+    // both sides may enable kernel TLS, their key material differs
+    ktls_check_tx(server, client_bio, version, cipher_type);
+    ktls_check_tx(client, server_bio, version, cipher_type);
+
+    SSL_free(client);
+    SSL_free(server);
+
+    ::unlink(ktls_key_file);
+    ::unlink(ktls_cert_file);
+}
+
+START_TEST(test_ktls_tls12_aes128_gcm)
+{
+    ktls_test(TLS1_2_VERSION, "ECDHE-ECDSA-AES128-GCM-SHA256",
+              TLS_1_2_VERSION, TLS_CIPHER_AES_GCM_128);
+}
+END_TEST
+
+START_TEST(test_ktls_tls12_aes256_gcm)
+{
+    ktls_test(TLS1_2_VERSION, "ECDHE-ECDSA-AES256-GCM-SHA384",
+              TLS_1_2_VERSION, TLS_CIPHER_AES_GCM_256);
+}
+END_TEST
+
+START_TEST(test_ktls_tls13_aes128_gcm)
+{
+    ktls_test(TLS1_3_VERSION, "TLS_AES_128_GCM_SHA256",
+              TLS_1_3_VERSION, TLS_CIPHER_AES_GCM_128);
+}
+END_TEST
+
+START_TEST(test_ktls_tls13_aes256_gcm)
+{
+    ktls_test(TLS1_3_VERSION, "TLS_AES_256_GCM_SHA384",
+              TLS_1_3_VERSION, TLS_CIPHER_AES_GCM_256);
+}
+END_TEST
+
+#endif /* HAVE_KTLS */
+
 Suite* gu_asio_suite()
 {
     Suite* s(suite_create("gu::asio"));
@@ -65,6 +336,15 @@ Suite* gu_asio_suite()
     tcase_add_test(tc, test_make_address_v6_link_local_with_scope_id);
     suite_add_tcase(s, tc);
 
+#ifdef HAVE_KTLS
+    tc = tcase_create("test_ktls_keys");
+    tcase_add_test(tc, test_ktls_tls12_aes128_gcm);
+    tcase_add_test(tc, test_ktls_tls12_aes256_gcm);
+    tcase_add_test(tc, test_ktls_tls13_aes128_gcm);
+    tcase_add_test(tc, test_ktls_tls13_aes256_gcm);
+    suite_add_tcase(s, tc);
+#endif /* HAVE_KTLS */
+
     return s;
 }
 
@@ -235,6 +235,39 @@ START_TEST(gu_fifo_cancel_test)
 }
 END_TEST
 
+START_TEST(gu_fifo_until_test)
+{
+    gu_fifo_t* q = gu_fifo_create (FIFO_LENGTH, sizeof(size_t));
+    int        err;
+
+    /* empty queue */
+    long long const begin = gu_time_calendar();
+    size_t* item = gu_fifo_get_head_until (q, &err, begin + 10000000 /*10ms*/);
+    ck_assert(NULL == item);
+    ck_assert_msg(-ETIMEDOUT == err, "Expected -ETIMEDOUT, got %d", err);
+    ck_assert(gu_time_calendar() - begin >= 10000000);
+
+    item = gu_fifo_get_tail (q);
+    ck_assert(item != NULL);
+    *item = ITEM;
+    gu_fifo_push_tail (q);
+
+    /* deadline in the past does not matter if there are items */
+    item = gu_fifo_get_head_until (q, &err, begin);
+    ck_assert(item != NULL);
+    ck_assert(ITEM == *item);
+    gu_fifo_pop_head (q);
+
+    /* closed queue */
+    gu_fifo_close (q);
+    item = gu_fifo_get_head_until (q, &err, gu_time_calendar() + 10000000);
+    ck_assert(NULL == item);
+    ck_assert(-ENODATA == err);
+
+    gu_fifo_destroy(q);
+}
+END_TEST
+
 Suite *gu_fifo_suite(void)
 {
     Suite *s  = suite_create("Galera FIFO functions");
@@ -243,6 +276,7 @@ Suite *gu_fifo_suite(void)
     suite_add_tcase (s, tc);
     tcase_add_test  (tc, gu_fifo_test);
     tcase_add_test  (tc, gu_fifo_cancel_test);
+    tcase_add_test  (tc, gu_fifo_until_test);
     tcase_set_timeout(tc, 60);
 
     return s;
@@ -31,10 +31,51 @@ START_TEST(test_histogram)
 }
 END_TEST
 
+START_TEST(test_latency_histogram)
+{
+    LatencyHistogram hs;
+
+    ck_assert(hs.count() == 0);
+    ck_assert(hs.percentile(0.5) == 0);
+
+    // exact below 8ns
+    for (long long i = 0; i < 8; ++i) hs.insert(i);
+    ck_assert(hs.count() == 8);
+    ck_assert_msg(hs.percentile(0.5) == 3, "p50: %lld", hs.percentile(0.5));
+    ck_assert(hs.percentile(1.0) == 7);
+    ck_assert(hs.max() == 7);
+
+    hs.clear();
+    ck_assert(hs.count() == 0 && hs.max() == 0);
+
+    // 1..100000 us uniformly
+    for (long long i = 1; i <= 100000; ++i) hs.insert(i * 1000);
+    ck_assert(hs.count() == 100000);
+
+    long long const p50(hs.percentile(0.5));
+    long long const p99(hs.percentile(0.99));
+    ck_assert_msg(p50 >= 50000000LL && p50 <= 50000000LL * 9 / 8,
+                  "p50: %lld", p50);
+    ck_assert_msg(p99 >= 99000000LL && p99 <= 99000000LL * 9 / 8,
+                  "p99: %lld", p99);
+    ck_assert(hs.percentile(1.0) == 100000000LL);
+    ck_assert(hs.max() == 100000000LL);
+
+    // out of range values
+    hs.insert(-1);
+    hs.insert(1LL << 50);
+    ck_assert(hs.count() == 100002);
+    ck_assert(hs.max() == 1LL << 50);
+
+    log_info << hs;
+}
+END_TEST
+
 Suite* gu_histogram_suite()
 {
     TCase* t = tcase_create ("test_histogram");
     tcase_add_test (t, test_histogram);
+    tcase_add_test (t, test_latency_histogram);
 
     Suite* s = suite_create ("gu::Histogram");
     suite_add_tcase (s, t);
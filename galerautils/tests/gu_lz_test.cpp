@@ -0,0 +1,290 @@
+//
+// Copyright (C) 2021 Codership Oy <info@codership.com>
+//
+
+#include "gu_lz.hpp"
+#include "gu_throw.hpp"
+#include "gu_types.hpp"
+#include "gu_lz_test.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+typedef std::vector<gu::byte_t> Bytes;
+
+static gu::byte_t* ptr(Bytes& v) { return v.empty() ? NULL : &v[0]; }
+
+static void
+roundtrip(Bytes& src, size_t* const compressed)
+{
+    Bytes dst(gu::lz_compress_bound(src.size()));
+    size_t const clen(gu::lz_compress(ptr(src), src.size(),
+                                      ptr(dst), dst.size()));
+    ck_assert_msg(clen > 0, "compression of %zu bytes failed", src.size());
+    ck_assert(clen <= dst.size());
+
+    Bytes out(src.size() + 1);
+    size_t const dlen(gu::lz_decompress(ptr(dst), clen,
+                                        ptr(out), out.size()));
+    ck_assert_msg(dlen == src.size(), "expected %zu bytes, got %zu",
+                  src.size(), dlen);
+    ck_assert(0 == ::memcmp(ptr(src), ptr(out), dlen));
+
+    if (compressed) *compressed = clen;
+}
+
+START_TEST(test_lz_roundtrip)
+{
+    unsigned int seed(1);
+
+    for (size_t len(0); len < 300; ++len)
+    {
+        Bytes v(len);
+
+        /* random */
+        for (size_t i(0); i < len; ++i) v[i] = rand_r(&seed);
+        roundtrip(v, NULL);
+
+        /* runs of the same byte */
+        for (size_t i(0); i < len; ++i) v[i] = (i / 20) & 0xff;
+        roundtrip(v, NULL);
+    }
+
+    /* large repetitive buffer with long literal and match runs */
+    Bytes v(1 << 20);
+    for (size_t i(0); i < v.size(); ++i)
+    {
+        v[i] = (i % 4096) < 1024 ? rand_r(&seed) : "row data "[i % 9];
+    }
+
+    size_t clen;
+    roundtrip(v, &clen);
+    ck_assert_msg(clen < v.size() / 2, "poor compression: %zu of %zu",
+                  clen, v.size());
+}
+END_TEST
+
+START_TEST(test_lz_limits)
+{
+    Bytes src(4096, 'a');
+    Bytes dst(gu::lz_compress_bound(src.size()));
+
+    /* insufficient output space for incompressible data */
+    unsigned int seed(2);
+    for (size_t i(0); i < src.size(); ++i) src[i] = rand_r(&seed);
+    ck_assert(0 == gu::lz_compress(ptr(src), src.size(), ptr(dst), 100));
+
+    std::fill(src.begin(), src.end(), 'a');
+    size_t const clen(gu::lz_compress(ptr(src), src.size(),
+                                      ptr(dst), dst.size()));
+    ck_assert(clen > 0);
+
+    /* output buffer too small */
+    Bytes out(src.size() - 1);
+    try
+    {
+        gu::lz_decompress(ptr(dst), clen, ptr(out), out.size());
+        ck_abort_msg("decompression into too small buffer succeeded");
+    }
+    catch (gu::Exception& e)
+    {
+        ck_assert(EINVAL == e.get_errno());
+    }
+
+    /* truncated input */
+    out.resize(src.size());
+    try
+    {
+        gu::lz_decompress(ptr(dst), clen - 1, ptr(out), out.size());
+        ck_abort_msg("decompression of truncated block succeeded");
+    }
+    catch (gu::Exception& e)
+    {
+        ck_assert(EINVAL == e.get_errno());
+    }
+}
+END_TEST
+
+/* fills v with a random mix of noise, byte runs and copies of earlier
+ * data at random distances, some of them beyond the maximum LZ4 offset */
+static void
+random_block(Bytes& v, unsigned int* const seed)
+{
+    size_t i(0);
+
+    while (i < v.size())
+    {
+        size_t const seg(std::min<size_t>(v.size() - i,
+                                          1 + rand_r(seed) % 300));
+        switch (rand_r(seed) % 3)
+        {
+        case 0:
+            for (size_t j(0); j < seg; ++j) v[i + j] = rand_r(seed);
+            break;
+        case 1:
+            std::fill(v.begin() + i, v.begin() + i + seg,
+                      gu::byte_t(rand_r(seed)));
+            break;
+        default:
+            if (i > 0)
+            {
+                size_t const dist(1 + rand_r(seed) % std::min<size_t>(
+                                      i, 100000));
+                for (size_t j(0); j < seg; ++j) v[i + j] = v[i + j - dist];
+            }
+            else
+            {
+                std::fill(v.begin(), v.begin() + seg, 0);
+            }
+        }
+        i += seg;
+    }
+}
+
+static void
+compress(Bytes& src, Bytes& dst)
+{
+    dst.resize(gu::lz_compress_bound(src.size()));
+    size_t const clen(gu::lz_compress(ptr(src), src.size(),
+                                      ptr(dst), dst.size()));
+    ck_assert(clen > 0);
+    dst.resize(clen);
+}
+
+START_TEST(test_lz_random_roundtrip)
+{
+    unsigned int seed(3);
+
+    for (int n(0); n < 1000; ++n)
+    {
+        /* mostly short buffers, some longer than the maximum offset */
+        size_t const len(n % 10 ? rand_r(&seed) % 4096 :
+                         rand_r(&seed) % (1 << 18));
+        Bytes src(len);
+        random_block(src, &seed);
+
+        Bytes dst;
+        compress(src, dst);
+
+        /* output buffer of exactly the original size */
+        Bytes out(len);
+        size_t const dlen(gu::lz_decompress(ptr(dst), dst.size(),
+                                            ptr(out), out.size()));
+        ck_assert_msg(dlen == len && out == src,
+                      "round trip %d of %zu bytes failed", n, len);
+    }
+}
+END_TEST
+
+/* decompresses src into a buffer with a guard area past dst_len,
+ * returns decompressed size or -1 if decompression failed */
+static long
+guarded_decompress(Bytes& src, size_t const dst_len)
+{
+    static size_t const guard(64);
+    static gu::byte_t const canary(0xa5);
+
+    Bytes out(dst_len + guard, canary);
+    long ret(-1);
+
+    try
+    {
+        ret = gu::lz_decompress(ptr(src), src.size(), ptr(out), dst_len);
+        ck_assert(size_t(ret) <= dst_len);
+    }
+    catch (gu::Exception& e)
+    {
+        ck_assert(EINVAL == e.get_errno());
+    }
+
+    for (size_t i(dst_len); i < out.size(); ++i)
+    {
+        ck_assert_msg(canary == out[i], "write past %zu bytes at %zu",
+                      dst_len, i);
+    }
+
+    return ret;
+}
+
+START_TEST(test_lz_truncated)
+{
+    unsigned int seed(4);
+
+    for (int n(0); n < 50; ++n)
+    {
+        Bytes src(1 + rand_r(&seed) % 2048);
+        random_block(src, &seed);
+
+        Bytes block;
+        compress(src, block);
+
+        /* every prefix either fails or decodes to less than the original */
+        for (size_t clen(0); clen < block.size(); ++clen)
+        {
+            Bytes trunc(block.begin(), block.begin() + clen);
+            long const ret(guarded_decompress(trunc, src.size()));
+            ck_assert_msg(ret < long(src.size()),
+                          "block %d truncated to %zu of %zu bytes decoded "
+                          "in full", n, clen, block.size());
+        }
+    }
+}
+END_TEST
+
+START_TEST(test_lz_corrupt)
+{
+    unsigned int seed(5);
+
+    for (int n(0); n < 10000; ++n)
+    {
+        Bytes src(1 + rand_r(&seed) % 2048);
+        random_block(src, &seed);
+
+        Bytes block;
+        compress(src, block);
+
+        /* a few random bytes overwritten */
+        int const errors(1 + rand_r(&seed) % 4);
+        for (int e(0); e < errors; ++e)
+        {
+            block[rand_r(&seed) % block.size()] = rand_r(&seed);
+        }
+
+        guarded_decompress(block, src.size());
+    }
+
+    /* pure garbage */
+    for (int n(0); n < 10000; ++n)
+    {
+        Bytes block(rand_r(&seed) % 256);
+        for (size_t i(0); i < block.size(); ++i) block[i] = rand_r(&seed);
+
+        guarded_decompress(block, rand_r(&seed) % 4096);
+    }
+}
+END_TEST
+
+Suite* gu_lz_suite()
+{
+    Suite* s(suite_create("gu::lz"));
+    TCase* tc;
+
+    tc = tcase_create("test_lz_roundtrip");
+    tcase_add_test(tc, test_lz_roundtrip);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_lz_limits");
+    tcase_add_test(tc, test_lz_limits);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_lz_random");
+    tcase_add_test(tc, test_lz_random_roundtrip);
+    tcase_add_test(tc, test_lz_truncated);
+    tcase_add_test(tc, test_lz_corrupt);
+    tcase_set_timeout(tc, 60);
+    suite_add_tcase(s, tc);
+
+    return s;
+}
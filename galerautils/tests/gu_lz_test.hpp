@@ -0,0 +1,12 @@
+//
+// Copyright (C) 2021 Codership Oy <info@codership.com>
+//
+
+#ifndef GU_LZ_TEST_HPP
+#define GU_LZ_TEST_HPP
+
+#include <check.h>
+
+Suite* gu_lz_suite();
+
+#endif // GU_LZ_TEST_HPP
@@ -14,6 +14,7 @@
 #include "gu_vector_test.hpp"
 #include "gu_string_test.hpp"
 #include "gu_vlq_test.hpp"
+#include "gu_lz_test.hpp"
 #include "gu_digest_test.hpp"
 #include "gu_mem_pool_test.hpp"
 #include "gu_alloc_test.hpp"
@@ -37,6 +38,7 @@ static suite_creator_t suites[] =
     gu_vector_suite,
     gu_string_suite,
     gu_vlq_suite,
+    gu_lz_suite,
     gu_digest_suite,
     gu_mem_pool_suite,
     gu_alloc_suite,
@@ -15,9 +15,11 @@ namespace gcache
     void
     GCache::reset()
     {
+        discard_cold();
         mem.reset();
         rb.reset();
         ps.reset();
+        cold.reset();
 
         mallocs  = 0;
         reallocs = 0;
@@ -28,6 +30,11 @@ namespace gcache
         seqno_locked   = SEQNO_MAX;
         seqno_locked_count = 0;
 
+        seqno_times.clear();
+        seqno_max_time   = 0;
+        seqno_to_release = SEQNO_NONE;
+        seqno_cold       = SEQNO_NONE;
+
         seqno2ptr.clear(SEQNO_NONE);
 
 #ifndef NDEBUG
@@ -51,6 +58,8 @@ namespace gcache
                    params.debug(),
                    /* keep last page if PS is the only storage */
                    !((params.mem_size() + params.rb_size()) > 0)),
+        cold      (params.dir_name(), 0, cold_page_size(), params.debug(),
+                   false, "gcache.cold."),
         mallocs   (0),
         reallocs  (0),
         frees     (0),
@@ -58,14 +67,41 @@ namespace gcache
                        SEQNO_NONE : seqno2ptr.index_back()),
         seqno_released(seqno_max),
         seqno_locked  (SEQNO_MAX),
-        seqno_locked_count(0)
+        seqno_locked_count(0),
+        seqno_times   (),
+        seqno_max_time(0),
+        seqno_to_release(seqno_released),
+        seqno_cold    (seqno_released),
+        cold_raw      (),
+        cold_buf      (),
+        cold_busy     (false),
+        reclaim_cond  (),
+        reclaim_stop  (false),
+        reclaim_thr   ()
 #ifndef NDEBUG
         ,buf_tracker()
 #endif
-    {}
+    {
+        rb.set_flush_policy(params.flush_policy(), params.flush_batch());
+
+        int const err(pthread_create(&reclaim_thr, NULL, reclaim_thread,
+                                     this));
+        if (0 != err)
+        {
+            gu_throw_error(err) << "Failed to create history reclaim thread";
+        }
+    }
 
     GCache::~GCache ()
     {
+        {
+            gu::Lock lock(mtx);
+            reclaim_stop = true;
+            reclaim_cond.signal();
+        }
+
+        pthread_join(reclaim_thr, NULL);
+
         gu::Lock lock(mtx);
         log_debug << "\n" << "GCache mallocs : " << mallocs
                   << "\n" << "GCache reallocs: " << reallocs
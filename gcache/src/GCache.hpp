@@ -13,13 +13,19 @@
 #include <gu_types.hpp>
 #include <gu_lock.hpp> // for gu::Mutex and gu::Cond
 #include <gu_config.hpp>
+#include <gu_status.hpp>
+#include <gu_buffer.hpp>
 
 #include <string>
 #include <iostream>
+#include <deque>
+#include <utility>
+#include <vector>
 #ifndef NDEBUG
 #include <set>
 #endif
 #include <stdint.h>
+#include <pthread.h>
 
 namespace gcache
 {
@@ -103,14 +109,15 @@ namespace gcache
         {
         public:
 
-            Buffer() : seqno_g_(), seqno_d_(), ptr_(), size_() { }
+            Buffer() : seqno_g_(), seqno_d_(), ptr_(), size_(), data_() { }
 
             Buffer (const Buffer& other)
                 :
                 seqno_g_(other.seqno_g_),
                 seqno_d_(other.seqno_d_),
                 ptr_    (other.ptr_),
-                size_   (other.size_)
+                size_   (other.size_),
+                data_   (other.data_)
             { }
 
             Buffer& operator= (const Buffer& other)
@@ -119,6 +126,7 @@ namespace gcache
                 seqno_d_ = other.seqno_d_;
                 ptr_     = other.ptr_;
                 size_    = other.size_;
+                data_    = other.data_;
                 return *this;
             }
 
@@ -146,6 +154,7 @@ namespace gcache
             seqno_t           seqno_d_;
             const gu::byte_t* ptr_;
             ssize_type        size_; /* same type as passed to malloc() */
+            gu::SharedBuffer  data_; /* holds decompressed cold buffer */
 
             friend class GCache;
         };
@@ -167,6 +176,11 @@ namespace gcache
         /*! @throws NotFound */
         void param_set (const std::string& key, const std::string& val);
 
+        /*!
+         * Adds history retention and IST demand figures to status.
+         */
+        void get_status (gu::Status& status) const;
+
         static size_t const PREAMBLE_LEN;
 
     private:
@@ -175,6 +189,10 @@ namespace gcache
 
         void free_common (BufferHeader*);
 
+        /* write-behind of ring buffer ranges queued by allocations,
+         * called without lock */
+        void rb_write_back (const RingBuffer::WriteBackQueue& q, bool wait);
+
         gu::Config&     config;
 
         class Params
@@ -194,10 +212,21 @@ namespace gcache
             size_t keep_pages_size()     const { return keep_pages_size_; }
             int    debug()               const { return debug_;           }
             bool   recover()             const { return recover_;         }
+            RingBuffer::FlushPolicy
+                   flush_policy()        const { return flush_policy_;    }
+            size_t flush_batch()         const { return flush_batch_;     }
+            long long keep_history()     const { return keep_history_;    }
+            size_t cold_size()           const { return cold_size_;       }
+            seqno_t cold_after()         const { return cold_after_;      }
 
             void mem_size        (size_t s) { mem_size_        = s; }
             void page_size       (size_t s) { page_size_       = s; }
             void keep_pages_size (size_t s) { keep_pages_size_ = s; }
+            void flush_policy (RingBuffer::FlushPolicy p) { flush_policy_ = p; }
+            void flush_batch     (size_t s) { flush_batch_     = s; }
+            void keep_history (long long t) { keep_history_    = t; }
+            void cold_size       (size_t s) { cold_size_       = s; }
+            void cold_after     (seqno_t s) { cold_after_      = s; }
 #ifndef NDEBUG
             void debug           (int    d) { debug_           = d; }
 #endif
@@ -212,6 +241,11 @@ namespace gcache
             size_t            keep_pages_size_;
             int               debug_;
             bool        const recover_;
+            RingBuffer::FlushPolicy flush_policy_;
+            size_t            flush_batch_;
+            long long         keep_history_; // nanoseconds
+            size_t            cold_size_;
+            seqno_t           cold_after_;
         }
             params;
 
@@ -223,6 +257,7 @@ namespace gcache
         MemStore        mem;
         RingBuffer      rb;
         PageStore       ps;
+        PageStore       cold; /* compressed released history */
 
         long long       mallocs;
         long long       reallocs;
@@ -234,6 +269,29 @@ namespace gcache
         seqno_t         seqno_locked;
         int             seqno_locked_count;
 
+        /* History retention: (seqno, time) samples taken at most once per
+         * HISTORY_SAMPLE_INTERVAL as seqnos are assigned, and the highest
+         * seqno the application asked to release. Buffers younger than
+         * params.keep_history() are held back from release, so the RB fills
+         * up and the history spills over into the page store. */
+        typedef std::pair<seqno_t, long long> SeqnoTime;
+        std::deque<SeqnoTime> seqno_times;
+        long long       seqno_max_time;
+        seqno_t         seqno_to_release;
+
+        /* cold store: seqnos up to seqno_cold have been considered for
+         * compression */
+        seqno_t         seqno_cold;
+        std::vector<gu::byte_t> cold_raw; /* RB buffer copies */
+        std::vector<gu::byte_t> cold_buf; /* compressed copies */
+        bool            cold_busy; /* compression in progress */
+
+        /* reclaims aged out history when seqno_release() is not called,
+         * e.g. on an idle node */
+        gu::Cond        reclaim_cond;
+        bool            reclaim_stop;
+        pthread_t       reclaim_thr;
+
 #ifndef NDEBUG
         std::set<const void*> buf_tracker;
 #endif
@@ -246,6 +304,40 @@ namespace gcache
         /* discards all seqnos greater than s */
         void discard_tail (seqno_t s);
 
+        /* records time of seqno assignment */
+        void history_sample (seqno_t s, long long now);
+
+        /* returns the highest seqno that is older than keep_history */
+        seqno_t history_horizon (long long now) const;
+
+        /* returns approximate age of seqno s in nanoseconds */
+        long long history_age (seqno_t s, long long now) const;
+
+        /* releases buffers held back for history retention up to end */
+        void release_held (seqno_t end);
+
+        /* history reclaim thread body */
+        void reclaim ();
+        static void* reclaim_thread (void* arg);
+
+        /* cold store is split into that many pages to trim it gradually */
+        static size_t const COLD_PAGES = 8;
+
+        size_t cold_page_size() const { return params.cold_size()/COLD_PAGES; }
+
+        /* moves a batch of old released RB buffers to the cold store,
+         * must be called without mutex held, compresses without it */
+        void compress_cold ();
+
+        /* discards oldest history while cold store exceeds cold_size */
+        void trim_cold ();
+
+        /* discards all cold store buffers, seqno2ptr must be cleared next */
+        void discard_cold ();
+
+        /* replaces cold store buffer with its decompressed copy */
+        static void decompress (Buffer& buf);
+
         // disable copying
         GCache (const GCache&);
         GCache& operator = (const GCache&);
@@ -0,0 +1,279 @@
+/*
+ * Copyright (C) 2021 Codership Oy <info@codership.com>
+ */
+
+/*! @file compressed cold store for old released history */
+
+#include "GCache.hpp"
+#include "gcache_bh.hpp"
+#include "gcache_limits.hpp"
+
+#include <gu_lz.hpp>
+#include <gu_logger.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace gcache
+{
+    /* cold store payload is prefixed with raw and stored sizes and flags */
+    struct ColdHeader
+    {
+        uint32_t raw_size;
+        uint32_t comp_size; /* size of the payload following the header */
+        uint32_t flags;
+    };
+
+    /* payload did not compress and is stored as is */
+    static uint32_t const COLD_STORED(1 << 0);
+
+    /* max bytes of RB buffers moved to cold store per seqno_release() call,
+     * to limit mutex hold time */
+    static size_t const COLD_BATCH(1 << 20);
+
+    /* RB buffer copied out to be compressed without holding the mutex */
+    struct ColdItem
+    {
+        const BufferHeader* bh;
+        seqno_t             seqno_g;
+        seqno_t             seqno_d;
+        size_t              raw_off;   /* offset in cold_raw */
+        size_t              raw_size;
+        size_t              comp_off;  /* offset in cold_buf */
+        size_t              comp_size; /* 0 means store raw */
+    };
+
+    void
+    GCache::compress_cold ()
+    {
+        std::vector<ColdItem> items;
+
+        {
+            gu::Lock lock(mtx);
+
+            if (0 == params.cold_size() || cold_busy) return;
+
+            seqno_t const end(std::min(std::min(seqno_released,
+                                                seqno_locked - 1),
+                                       seqno_max - params.cold_after()));
+            size_t  done(0);
+            seqno_t idx(seqno2ptr.upper_bound(seqno_cold));
+
+            cold_raw.clear();
+
+            while (idx <= end && idx < seqno2ptr.index_end() &&
+                   done < COLD_BATCH)
+            {
+                const BufferHeader* const bh(ptr2BH(seqno2ptr[idx]));
+
+                assert(BH_is_released(bh));
+                assert(bh->seqno_g == idx);
+
+                seqno_cold = idx;
+
+                if (BUFFER_IN_RB == bh->store)
+                {
+                    done += bh->size;
+
+                    ColdItem const item =
+                    {
+                        bh, bh->seqno_g, bh->seqno_d,
+                        cold_raw.size(), bh->size - sizeof(BufferHeader),
+                        0, 0
+                    };
+
+                    const gu::byte_t* const ptr
+                        (reinterpret_cast<const gu::byte_t*>(bh + 1));
+
+                    cold_raw.insert(cold_raw.end(), ptr, ptr + item.raw_size);
+                    items.push_back(item);
+                }
+
+                idx = seqno2ptr.upper_bound(idx);
+            }
+
+            if (items.empty())
+            {
+                trim_cold();
+                return;
+            }
+
+            cold_busy = true;
+        }
+
+        /* compression works on copies since RB may discard the originals
+         * while the mutex is not held */
+        cold_buf.clear();
+
+        for (size_t i(0); i < items.size(); ++i)
+        {
+            ColdItem& item(items[i]);
+
+            item.comp_off = cold_buf.size();
+            cold_buf.resize(item.comp_off +
+                            gu::lz_compress_bound(item.raw_size));
+
+            size_t const comp(gu::lz_compress(&cold_raw[item.raw_off],
+                                              item.raw_size,
+                                              &cold_buf[item.comp_off],
+                                              cold_buf.size() - item.comp_off));
+
+            /* not worth it unless it saves at least 1/8 */
+            if (comp > 0 &&
+                sizeof(ColdHeader) + comp <= item.raw_size - item.raw_size/8)
+            {
+                item.comp_size = comp;
+            }
+
+            cold_buf.resize(item.comp_off + item.comp_size);
+        }
+
+        gu::Lock lock(mtx);
+
+        cold_busy = false;
+
+        for (size_t i(0); i < items.size(); ++i)
+        {
+            ColdItem const& item(items[i]);
+
+            /* skip buffers discarded or reset while the mutex was released */
+            if (item.seqno_g > seqno_cold                 ||
+                item.seqno_g <  seqno2ptr.index_begin()   ||
+                item.seqno_g >= seqno2ptr.index_end()     ||
+                seqno2ptr_t::not_set(seqno2ptr[item.seqno_g]) ||
+                ptr2BH(seqno2ptr[item.seqno_g]) != item.bh)
+            {
+                continue;
+            }
+
+            BufferHeader* const bh(ptr2BH(seqno2ptr[item.seqno_g]));
+
+            if (bh->seqno_g != item.seqno_g || bh->seqno_d != item.seqno_d ||
+                BUFFER_IN_RB != bh->store   || !BH_is_released(bh))
+            {
+                continue;
+            }
+
+            /* incompressible buffers go to cold store too: left in RB they
+             * would be reclaimed together with all older history */
+            bool const stored(0 == item.comp_size);
+            size_t const payload(stored ? item.raw_size : item.comp_size);
+            size_type const size(MemOps::align_size(
+                sizeof(BufferHeader) + sizeof(ColdHeader) + payload));
+
+            void* const ptr(cold.malloc(size));
+
+            if (gu_unlikely(0 == ptr))
+            {
+                /* retry from this one next time */
+                seqno_cold = item.seqno_g - 1;
+                break;
+            }
+
+            BufferHeader* const cbh(ptr2BH(ptr));
+            cbh->seqno_g = bh->seqno_g;
+            cbh->seqno_d = bh->seqno_d;
+            cbh->flags  |= BUFFER_RELEASED | BUFFER_COMPRESSED;
+
+            ColdHeader const ch =
+            {
+                uint32_t(item.raw_size), uint32_t(payload),
+                stored ? COLD_STORED : 0
+            };
+            ::memcpy(ptr, &ch, sizeof(ch));
+            ::memcpy(static_cast<uint8_t*>(ptr) + sizeof(ch),
+                     stored ? &cold_raw[item.raw_off] : &cold_buf[item.comp_off],
+                     payload);
+
+            seqno2ptr.insert(item.seqno_g, ptr);
+            discard_buffer(bh);
+        }
+
+        trim_cold();
+    }
+
+    void
+    GCache::trim_cold ()
+    {
+        while (cold.total_size() > params.cold_size() && !seqno2ptr.empty() &&
+               seqno2ptr.index_begin() < seqno_locked)
+        {
+            BufferHeader* const bh(ptr2BH(seqno2ptr.front()));
+
+            if (!BH_is_released(bh)) break;
+
+            discard_buffer(bh);
+            seqno2ptr.pop_front();
+        }
+    }
+
+    void
+    GCache::discard_cold ()
+    {
+        for (seqno2ptr_iter_t i(seqno2ptr.begin()); i != seqno2ptr.end(); ++i)
+        {
+            if (seqno2ptr_t::not_set(*i)) continue;
+
+            BufferHeader* const bh(ptr2BH(*i));
+
+            if (BH_is_compressed(bh)) discard_buffer(bh);
+        }
+    }
+
+    void
+    GCache::decompress (Buffer& buf)
+    {
+        const BufferHeader* const bh(ptr2BH(buf.ptr()));
+
+        assert(BH_is_compressed(bh));
+
+        ColdHeader ch;
+        ::memcpy(&ch, buf.ptr(), sizeof(ch));
+
+        assert(bh->size >= sizeof(BufferHeader) + sizeof(ch) + ch.comp_size);
+
+        gu::SharedBuffer const data(new gu::Buffer(ch.raw_size));
+        const gu::byte_t* const payload(buf.ptr() + sizeof(ch));
+
+        if (ch.flags & COLD_STORED)
+        {
+            if (gu_unlikely(ch.comp_size != ch.raw_size))
+            {
+                gu_throw_error(EINVAL) << "Corrupt cold store buffer, seqno "
+                                       << bh->seqno_g << ": stored size "
+                                       << ch.comp_size << " != raw size "
+                                       << ch.raw_size;
+            }
+
+            std::copy(payload, payload + ch.raw_size, data->begin());
+        }
+        else
+        {
+            size_t raw(0);
+
+            try
+            {
+                raw = gu::lz_decompress(payload, ch.comp_size,
+                                        &(*data)[0], data->size());
+            }
+            catch (gu::Exception& e)
+            {
+                gu_throw_error(e.get_errno())
+                    << "Failed to decompress cold store buffer, seqno "
+                    << bh->seqno_g << ": " << e.what();
+            }
+
+            if (gu_unlikely(raw != ch.raw_size))
+            {
+                gu_throw_error(EINVAL) << "Corrupt cold store buffer, seqno "
+                                       << bh->seqno_g << ": decompressed "
+                                       << raw << " bytes, expected "
+                                       << ch.raw_size;
+            }
+        }
+
+        buf.data_ = data;
+        buf.set_ptr(&(*data)[0]);
+        buf.set_other(bh->seqno_g, bh->seqno_d, ch.raw_size);
+    }
+}
@@ -16,7 +16,10 @@ namespace gcache
         {
         case BUFFER_IN_MEM:  mem.discard (bh); break;
         case BUFFER_IN_RB:   rb.discard  (bh); break;
-        case BUFFER_IN_PAGE: ps.discard  (bh); break;
+        case BUFFER_IN_PAGE:
+            /* can be either ps or cold store */
+            PageStore::page_store(static_cast<Page*>(bh->ctx))->discard(bh);
+            break;
         default:
             log_fatal << "Corrupt buffer header: " << bh;
             abort();
@@ -94,6 +97,16 @@ namespace gcache
         }
     }
 
+    void
+    GCache::rb_write_back(const RingBuffer::WriteBackQueue& q, bool const wait)
+    {
+        if (!rb.write_back(q, wait))
+        {
+            gu::Lock lock(mtx);
+            rb.set_flush_policy(RingBuffer::FLUSH_KERNEL, rb.flush_batch());
+        }
+    }
+
     void*
     GCache::malloc (ssize_type const s)
     {
@@ -105,19 +118,27 @@ namespace gcache
         {
             size_type const size(MemOps::align_size(s + sizeof(BufferHeader)));
 
-            gu::Lock lock(mtx);
+            RingBuffer::WriteBackQueue wbq;
+            bool                       wait(false);
+            {
+                gu::Lock lock(mtx);
 
-            mallocs++;
+                mallocs++;
 
-            ptr = mem.malloc(size);
+                ptr = mem.malloc(size);
 
-            if (0 == ptr) ptr = rb.malloc(size);
+                if (0 == ptr) ptr = rb.malloc(size);
 
-            if (0 == ptr) ptr = ps.malloc(size);
+                if (0 == ptr) ptr = ps.malloc(size);
 
 #ifndef NDEBUG
-            if (0 != ptr) buf_tracker.insert (ptr);
+                if (0 != ptr) buf_tracker.insert (ptr);
 #endif
+                wait = rb.take_write_back(wbq);
+            }
+
+            /* write-behind I/O is done outside of critical section */
+            if (!wbq.empty()) rb_write_back(wbq, wait);
         }
 
         assert((uintptr_t(ptr) % MemOps::ALIGNMENT) == 0);
@@ -241,47 +262,55 @@ namespace gcache
             abort();
         }
 
-        gu::Lock      lock(mtx);
+        RingBuffer::WriteBackQueue wbq;
+        bool                       wait(false);
+        {
+            gu::Lock      lock(mtx);
 
-        reallocs++;
+            reallocs++;
 
-        MemOps* store(0);
+            MemOps* store(0);
 
-        switch (bh->store)
-        {
-        case BUFFER_IN_MEM:  store = &mem; break;
-        case BUFFER_IN_RB:   store = &rb;  break;
-        case BUFFER_IN_PAGE: store = &ps;  break;
-        default:
-            log_fatal << "Memory corruption: unrecognized store: "
-                      << bh->store;
-            abort();
-        }
+            switch (bh->store)
+            {
+            case BUFFER_IN_MEM:  store = &mem; break;
+            case BUFFER_IN_RB:   store = &rb;  break;
+            case BUFFER_IN_PAGE: store = &ps;  break;
+            default:
+                log_fatal << "Memory corruption: unrecognized store: "
+                          << bh->store;
+                abort();
+            }
 
-        new_ptr = store->realloc (ptr, size);
+            new_ptr = store->realloc (ptr, size);
 
-        if (0 == new_ptr)
-        {
-            new_ptr = malloc (size);
-
-            if (0 != new_ptr)
+            if (0 == new_ptr)
             {
-                memcpy (new_ptr, ptr, bh->size - sizeof(BufferHeader));
-                store->free (bh);
+                new_ptr = malloc (size);
+
+                if (0 != new_ptr)
+                {
+                    memcpy (new_ptr, ptr, bh->size - sizeof(BufferHeader));
+                    store->free (bh);
+                }
             }
-        }
 
 #ifndef NDEBUG
-        if (ptr != new_ptr && 0 != new_ptr)
-        {
-            std::set<const void*>::iterator it = buf_tracker.find(ptr);
+            if (ptr != new_ptr && 0 != new_ptr)
+            {
+                std::set<const void*>::iterator it = buf_tracker.find(ptr);
 
-            if (it != buf_tracker.end()) buf_tracker.erase(it);
+                if (it != buf_tracker.end()) buf_tracker.erase(it);
 
-            it = buf_tracker.find(new_ptr);
+                it = buf_tracker.find(new_ptr);
 
-        }
+            }
 #endif
+            wait = rb.take_write_back(wbq);
+        }
+
+        if (!wbq.empty()) rb_write_back(wbq, wait);
+
         assert((uintptr_t(new_ptr) % MemOps::ALIGNMENT) == 0);
 
         return new_ptr;
@@ -5,6 +5,10 @@
 #include "gcache_bh.hpp"
 #include "GCache.hpp"
 
+#include <gu_time.h>
+#include <gu_datetime.hpp>
+
+#include <algorithm>
 #include <cerrno>
 #include <cassert>
 
@@ -12,6 +16,156 @@
 
 namespace gcache
 {
+    /* seqno assignment time sampling resolution */
+    static long long const HISTORY_SAMPLE_INTERVAL(1000000000LL); // 1 sec
+    /* when exceeded, every other sample is dropped */
+    static size_t    const HISTORY_SAMPLES_MAX(4096);
+
+    struct SeqnoTimeLess
+    {
+        bool operator()(const std::pair<seqno_t, long long>& st,
+                        seqno_t const s) const
+        {
+            return st.first < s;
+        }
+    };
+
+    void
+    GCache::history_sample (seqno_t const s, long long const now)
+    {
+        seqno_max_time = now;
+
+        if (!seqno_times.empty() &&
+            now - seqno_times.back().second < HISTORY_SAMPLE_INTERVAL) return;
+
+        seqno_times.push_back(SeqnoTime(s, now));
+
+        /* keep one sample at or below the oldest seqno in cache */
+        if (!seqno2ptr.empty())
+        {
+            seqno_t const begin(seqno2ptr.index_begin());
+
+            while (seqno_times.size() > 1 && seqno_times[1].first <= begin)
+            {
+                seqno_times.pop_front();
+            }
+        }
+
+        size_t const n(seqno_times.size());
+
+        if (gu_unlikely(n > HISTORY_SAMPLES_MAX))
+        {
+            /* thin out uniformly, keeping the first and the last samples */
+            size_t j(1);
+            for (size_t i(2); i < n; i += 2) seqno_times[j++] = seqno_times[i];
+            if (0 == n % 2) seqno_times[j++] = seqno_times[n - 1];
+            seqno_times.resize(j);
+        }
+    }
+
+    seqno_t
+    GCache::history_horizon (long long const now) const
+    {
+        long long const keep(params.keep_history());
+
+        if (keep <= 0 || seqno_times.empty()) return SEQNO_MAX;
+
+        long long const limit(now - keep);
+
+        if (seqno_max_time <= limit) return seqno_max;
+
+        /* seqnos below the first sample were assigned before it */
+        seqno_t horizon(seqno_times.front().first - 1);
+
+        for (std::deque<SeqnoTime>::const_iterator i(seqno_times.begin());
+             i != seqno_times.end() && i->second <= limit; ++i)
+        {
+            horizon = i->first;
+        }
+
+        return horizon;
+    }
+
+    long long
+    GCache::history_age (seqno_t const s, long long const now) const
+    {
+        if (seqno_times.empty()) return 0;
+
+        /* the first sample at or above s was taken no earlier than s was
+         * assigned, seqnos above the last sample were assigned within
+         * HISTORY_SAMPLE_INTERVAL from it */
+        std::deque<SeqnoTime>::const_iterator i
+            (std::lower_bound(seqno_times.begin(), seqno_times.end(), s,
+                              SeqnoTimeLess()));
+
+        if (i == seqno_times.end()) --i;
+
+        return now - i->second;
+    }
+
+    void
+    GCache::release_held (seqno_t end)
+    {
+        end = std::min(end, std::min(seqno_to_release, seqno_locked - 1));
+        seqno_t idx(seqno2ptr.upper_bound(seqno_released));
+
+        while (idx < seqno2ptr.index_end() && idx <= end)
+        {
+            BufferHeader* const bh(ptr2BH(seqno2ptr[idx]));
+            if (gu_likely(!BH_is_released(bh))) free_common(bh);
+            idx = seqno2ptr.upper_bound(idx);
+        }
+    }
+
+    void
+    GCache::reclaim ()
+    {
+        for (;;)
+        {
+            {
+                gu::Lock lock(mtx);
+
+                if (reclaim_stop) return;
+
+                if (params.keep_history() > 0)
+                {
+                    /* held history ages out with time alone */
+                    gu::datetime::Date const wakeup
+                        (gu::datetime::Date::calendar() +
+                         gu::datetime::Period(HISTORY_SAMPLE_INTERVAL));
+                    try
+                    {
+                        lock.wait(reclaim_cond, wakeup);
+                    }
+                    catch (gu::Exception& e)
+                    {
+                        if (ETIMEDOUT != e.get_errno()) throw;
+                    }
+                }
+                else
+                {
+                    /* until keep_history is set or we're stopped */
+                    lock.wait(reclaim_cond);
+                }
+
+                if (reclaim_stop) return;
+
+                if (seqno_to_release <= seqno_released) continue;
+
+                release_held(history_horizon(gu_time_monotonic()));
+            }
+
+            if (params.cold_size() > 0) compress_cold();
+        }
+    }
+
+    void*
+    GCache::reclaim_thread (void* const arg)
+    {
+        static_cast<GCache*>(arg)->reclaim();
+        return NULL;
+    }
+
     /*!
      * Reinitialize seqno sequence (after SST or such)
      * Clears seqno->ptr map // and sets seqno_min to s.
@@ -23,6 +177,10 @@ namespace gcache
 
         assert(seqno2ptr.empty() || seqno_max == seqno2ptr.index_back());
 
+        /* buffers held back for history retention must be released before
+         * they can be discarded */
+        release_held(SEQNO_MAX);
+
         if (g == gid && s != SEQNO_ILL && seqno_max >= s)
         {
             if (seqno_max > s)
@@ -30,6 +188,8 @@ namespace gcache
                 discard_tail(s);
                 seqno_max = s;
                 seqno_released = s;
+                seqno_to_release = std::min(seqno_to_release, s);
+                seqno_cold = std::min(seqno_cold, s);
                 assert(seqno_max == seqno2ptr.index_back());
             }
             return;
@@ -39,11 +199,15 @@ namespace gcache
                  << " -> " << g << ':' << s;
 
         seqno_released = SEQNO_NONE;
+        seqno_to_release = SEQNO_NONE;
+        seqno_cold = SEQNO_NONE;
+        seqno_times.clear();
         gid = g;
 
         /* order is significant here */
         rb.seqno_reset();
         mem.seqno_reset();
+        discard_cold();
 
         seqno2ptr.clear(SEQNO_NONE);
         seqno_max = SEQNO_NONE;
@@ -92,6 +256,11 @@ namespace gcache
 
         seqno2ptr.insert(seqno_g, ptr);
 
+        if (gu_likely(seqno_g == seqno_max))
+        {
+            history_sample(seqno_g, gu_time_monotonic());
+        }
+
         bh->seqno_g = seqno_g;
         bh->seqno_d = seqno_d;
     }
@@ -121,6 +290,8 @@ namespace gcache
 
             gu::Lock lock(mtx);
 
+            if (seqno > seqno_to_release) seqno_to_release = seqno;
+
             if (seqno < seqno_released || seqno >= seqno_locked)
             {
 #ifndef NDEBUG
@@ -159,7 +330,8 @@ namespace gcache
             old_gap = new_gap;
 
             seqno_t const start  (idx - 1);
-            seqno_t const max_end(std::min(seqno, seqno_locked - 1));
+            seqno_t const max_end(std::min(seqno,
+                                  history_horizon(gu_time_monotonic())));
             seqno_t const end    (max_end - start >= 2*batch_size ?
                                   start + batch_size : max_end);
 #ifndef NDEBUG
@@ -197,9 +369,9 @@ namespace gcache
                 idx = seqno2ptr.upper_bound(idx);
             }
 
-            assert (loop || seqno == seqno_released);
+            assert (loop || max_end == seqno_released);
 
-            loop = (end < seqno) && loop;
+            loop = (end < max_end) && loop;
 
 #ifndef NDEBUG
             if (params.debug())
@@ -211,6 +383,8 @@ namespace gcache
 #endif
         }
         while(loop);
+
+        if (params.cold_size() > 0) compress_cold();
     }
 
     /*!
@@ -252,6 +426,13 @@ namespace gcache
         assert (ptr);
 
         const BufferHeader* const bh (ptr2BH(ptr)); // this can result in IO
+
+        if (gu_unlikely(BH_is_compressed(bh)))
+        {
+            gu_throw_error(ENOTSUP) << "seqno " << seqno_g
+                                    << " is in compressed cold store, "
+                                    << "use seqno_get_buffers()";
+        }
         seqno_d = bh->seqno_d;
         size    = bh->size - sizeof(BufferHeader);
 
@@ -296,6 +477,13 @@ namespace gcache
             assert (bh->seqno_g == seqno_t(start + i));
             Limits::assert_size(bh->size);
 
+            if (gu_unlikely(BH_is_compressed(bh)))
+            {
+                decompress(v[i]);
+                continue;
+            }
+
+            v[i].data_.reset();
             v[i].set_other (bh->seqno_g,
                             bh->seqno_d,
                             bh->size - sizeof(BufferHeader));
@@ -324,4 +512,20 @@ namespace gcache
             seqno_locked = SEQNO_MAX;
         }
     }
+
+    void GCache::get_status (gu::Status& status) const
+    {
+        gu::Lock lock(mtx);
+
+        long long const now(gu_time_monotonic());
+        bool const empty(seqno2ptr.empty());
+
+        status.insert("gcache_history_seqnos", gu::to_string(empty ? 0 :
+                      seqno_max - seqno2ptr.index_begin() + 1));
+        status.insert("gcache_history_seconds", gu::to_string(empty ? 0 :
+                      history_age(seqno2ptr.index_begin(), now) / 1000000000));
+        status.insert("gcache_history_held", gu::to_string(
+                      std::max<seqno_t>(seqno_to_release - seqno_released, 0)));
+        status.insert("gcache_cold_size", gu::to_string(cold.total_size()));
+    }
 }
@@ -17,8 +17,10 @@
 
 namespace gcache
 {
-    static uint32_t const BUFFER_RELEASED  = 1 << 0;
-    static uint32_t const BUFFER_FLAGS_MAX = BUFFER_RELEASED;
+    static uint32_t const BUFFER_RELEASED   = 1 << 0;
+    static uint32_t const BUFFER_COMPRESSED = 1 << 1; /* cold store payload */
+    static uint32_t const BUFFER_FLAGS_MAX  = BUFFER_RELEASED |
+                                              BUFFER_COMPRESSED;
 
     enum StorageType
     {
@@ -81,6 +83,12 @@ namespace gcache
         return (bh->flags & BUFFER_RELEASED);
     }
 
+    static inline bool
+    BH_is_compressed (const BufferHeader* const bh)
+    {
+        return (bh->flags & BUFFER_COMPRESSED);
+    }
+
     static inline void
     BH_release (BufferHeader* const bh)
     {
@@ -17,10 +17,8 @@
 
 #include <iomanip>
 
-static const std::string base_name ("gcache.page.");
-
 static std::string
-make_base_name (const std::string& dir_name)
+make_base_name (const std::string& dir_name, const char* const base_name)
 {
     if (dir_name.empty())
     {
@@ -144,9 +142,10 @@ gcache::PageStore::PageStore (const std::string& dir_name,
                               size_t             keep_size,
                               size_t             page_size,
                               int                dbg,
-                              bool               keep_page)
+                              bool               keep_page,
+                              const char* const  prefix)
     :
-    base_name_ (make_base_name(dir_name)),
+    base_name_ (make_base_name(dir_name, prefix)),
     keep_size_ (keep_size),
     page_size_ (page_size),
     keep_page_ (keep_page),
@@ -24,7 +24,8 @@ namespace gcache
                    size_t             keep_size,
                    size_t             page_size,
                    int                dbg,
-                   bool               keep_page);
+                   bool               keep_page,
+                   const char*        prefix = "gcache.page.");
 
         ~PageStore ();
 
@@ -4,6 +4,8 @@
 
 #include "GCache.hpp"
 
+#include <gu_datetime.hpp>
+
 static const std::string GCACHE_PARAMS_DIR        ("gcache.dir");
 static const std::string GCACHE_DEFAULT_DIR       ("");
 static const std::string GCACHE_PARAMS_RB_NAME    ("gcache.name");
@@ -22,6 +24,16 @@ static const std::string GCACHE_DEFAULT_DEBUG     ("0");
 #endif
 static const std::string GCACHE_PARAMS_RECOVER    ("gcache.recover");
 static const std::string GCACHE_DEFAULT_RECOVER   ("no");
+static const std::string GCACHE_PARAMS_FLUSH_POLICY ("gcache.flush_policy");
+static const std::string GCACHE_DEFAULT_FLUSH_POLICY("kernel");
+static const std::string GCACHE_PARAMS_FLUSH_BATCH  ("gcache.flush_batch");
+static const std::string GCACHE_DEFAULT_FLUSH_BATCH ("16M");
+static const std::string GCACHE_PARAMS_KEEP_HISTORY ("gcache.keep_history");
+static const std::string GCACHE_DEFAULT_KEEP_HISTORY("PT0S");
+static const std::string GCACHE_PARAMS_COLD_SIZE  ("gcache.cold_size");
+static const std::string GCACHE_DEFAULT_COLD_SIZE ("0");
+static const std::string GCACHE_PARAMS_COLD_AFTER ("gcache.cold_after");
+static const std::string GCACHE_DEFAULT_COLD_AFTER("1024");
 
 void
 gcache::GCache::Params::register_params(gu::Config& cfg)
@@ -36,6 +48,38 @@ gcache::GCache::Params::register_params(gu::Config& cfg)
     cfg.add(GCACHE_PARAMS_DEBUG,           GCACHE_DEFAULT_DEBUG);
 #endif
     cfg.add(GCACHE_PARAMS_RECOVER,         GCACHE_DEFAULT_RECOVER);
+    cfg.add(GCACHE_PARAMS_FLUSH_POLICY,    GCACHE_DEFAULT_FLUSH_POLICY);
+    cfg.add(GCACHE_PARAMS_FLUSH_BATCH,     GCACHE_DEFAULT_FLUSH_BATCH);
+    cfg.add(GCACHE_PARAMS_KEEP_HISTORY,    GCACHE_DEFAULT_KEEP_HISTORY);
+    cfg.add(GCACHE_PARAMS_COLD_SIZE,       GCACHE_DEFAULT_COLD_SIZE);
+    cfg.add(GCACHE_PARAMS_COLD_AFTER,      GCACHE_DEFAULT_COLD_AFTER);
+}
+
+static gcache::RingBuffer::FlushPolicy
+flush_policy_value (const std::string& val)
+{
+    if (val == "kernel") return gcache::RingBuffer::FLUSH_KERNEL;
+    if (val == "async")  return gcache::RingBuffer::FLUSH_ASYNC;
+    if (val == "sync")   return gcache::RingBuffer::FLUSH_SYNC;
+
+    gu_throw_error(EINVAL) << "Invalid value for '"
+                           << GCACHE_PARAMS_FLUSH_POLICY << "': '" << val
+                           << "'. Expected 'kernel', 'async' or 'sync'.";
+}
+
+static gcache::seqno_t
+cold_after_value (const std::string& val)
+{
+    gcache::seqno_t const ret(gu::Config::from_config<gcache::seqno_t>(val));
+
+    if (ret < 0)
+    {
+        gu_throw_error(EINVAL) << "Invalid value for '"
+                               << GCACHE_PARAMS_COLD_AFTER << "': " << val
+                               << ". Must be non-negative.";
+    }
+
+    return ret;
 }
 
 static const std::string&
@@ -76,7 +120,13 @@ gcache::GCache::Params::Params (gu::Config& cfg, const std::string& data_dir)
 #else
     debug_    (0),
 #endif
-    recover_  (cfg.get<bool>(GCACHE_PARAMS_RECOVER))
+    recover_  (cfg.get<bool>(GCACHE_PARAMS_RECOVER)),
+    flush_policy_(flush_policy_value(cfg.get(GCACHE_PARAMS_FLUSH_POLICY))),
+    flush_batch_(cfg.get<size_t>(GCACHE_PARAMS_FLUSH_BATCH)),
+    keep_history_(gu::datetime::Period(cfg.get(GCACHE_PARAMS_KEEP_HISTORY))
+                  .get_nsecs()),
+    cold_size_ (cfg.get<size_t>(GCACHE_PARAMS_COLD_SIZE)),
+    cold_after_(cold_after_value(cfg.get(GCACHE_PARAMS_COLD_AFTER)))
 {}
 
 void
@@ -130,6 +180,56 @@ gcache::GCache::param_set (const std::string& key, const std::string& val)
         params.keep_pages_size(tmp_size);
         ps.set_keep_size(params.keep_pages_size());
     }
+    else if (key == GCACHE_PARAMS_FLUSH_POLICY)
+    {
+        RingBuffer::FlushPolicy const policy(flush_policy_value(val));
+
+        gu::Lock lock(mtx);
+
+        config.set(key, val);
+        params.flush_policy(policy);
+        rb.set_flush_policy(params.flush_policy(), params.flush_batch());
+    }
+    else if (key == GCACHE_PARAMS_FLUSH_BATCH)
+    {
+        size_t tmp_size = gu::Config::from_config<size_t>(val);
+
+        gu::Lock lock(mtx);
+
+        config.set<size_t>(key, tmp_size);
+        params.flush_batch(tmp_size);
+        rb.set_flush_policy(params.flush_policy(), params.flush_batch());
+    }
+    else if (key == GCACHE_PARAMS_KEEP_HISTORY)
+    {
+        gu::datetime::Period const period(val);
+
+        gu::Lock lock(mtx);
+
+        config.set(key, val);
+        params.keep_history(period.get_nsecs());
+        reclaim_cond.signal(); /* reclaim thread may need to start timing */
+    }
+    else if (key == GCACHE_PARAMS_COLD_SIZE)
+    {
+        size_t tmp_size = gu::Config::from_config<size_t>(val);
+
+        gu::Lock lock(mtx);
+
+        config.set<size_t>(key, tmp_size);
+        params.cold_size(tmp_size);
+        cold.set_page_size(cold_page_size());
+        trim_cold();
+    }
+    else if (key == GCACHE_PARAMS_COLD_AFTER)
+    {
+        seqno_t const after(cold_after_value(val));
+
+        gu::Lock lock(mtx);
+
+        config.set<seqno_t>(key, after);
+        params.cold_after(after);
+    }
     else if (key == GCACHE_PARAMS_RECOVER)
     {
         gu_throw_error(EINVAL) << "'" << key
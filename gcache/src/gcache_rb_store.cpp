@@ -12,7 +12,9 @@
 #include <gu_progress.hpp>
 #include <gu_hexdump.hpp>
 #include <gu_hash.h>
+#include <gu_limits.h> // GU_PAGE_SIZE
 
+#include <algorithm>
 #include <cassert>
 #include <iostream> // std::cerr
 
@@ -28,15 +30,22 @@ namespace gcache
     {
         write_preamble(false);
 
-        for (seqno2ptr_iter_t i = seqno2ptr_.begin(); i != seqno2ptr_.end(); ++i)
+        /* history may interleave buffers from other stores: skip holes left
+         * by erasing in the middle and don't step past erased back */
+        for (seqno2ptr_iter_t i = seqno2ptr_.begin(); i != seqno2ptr_.end();)
         {
-            if (ptr2BH(*i)->ctx == this) {
-                seqno2ptr_.erase(i);
+            if (!seqno2ptr_t::not_set(*i) && ptr2BH(*i)->ctx == this) {
+                i = seqno2ptr_.erase(i);
+            }
+            else {
+                ++i;
             }
         }
 
         first_ = start_;
         next_  = start_;
+        flushed_ = start_;
+        write_back_q_.clear();
 
         BH_clear (BH_cast(next_));
 
@@ -75,6 +84,10 @@ namespace gcache
 //        mallocs_   (0),
 //        reallocs_  (0),
         debug_     (dbg & DEBUG),
+        flush_policy_(FLUSH_KERNEL),
+        flush_batch_(0),
+        flushed_   (next_),
+        write_back_q_(),
         open_      (true)
     {
         assert((uintptr_t(start_) % MemOps::ALIGNMENT) == 0);
@@ -268,9 +281,76 @@ namespace gcache
         BH_clear (BH_cast(next_));
         assert_sizes();
 
+        if (FLUSH_KERNEL != flush_policy_) write_behind();
+
         return bh;
     }
 
+    void
+    RingBuffer::set_flush_policy(FlushPolicy const policy, size_t const batch)
+    {
+        size_t const page_size(GU_PAGE_SIZE);
+
+        flush_batch_  = std::max(page_size,
+                                 (batch + page_size - 1) / page_size
+                                 * page_size);
+        flush_policy_ = policy;
+        flushed_      = next_;
+    }
+
+    void
+    RingBuffer::queue_write_back(const uint8_t* const from,
+                                 const uint8_t* const to)
+    {
+        assert(from <= to);
+
+        write_back_q_.push_back(
+            std::make_pair(off_t(from - reinterpret_cast<uint8_t*>(preamble_)),
+                           off_t(to - from)));
+    }
+
+    bool
+    RingBuffer::write_back(const WriteBackQueue& q, bool const wait) const
+    {
+        try
+        {
+            for (WriteBackQueue::const_iterator i(q.begin()); i != q.end();
+                 ++i)
+            {
+                fd_.write_back(i->first, i->second, wait);
+            }
+        }
+        catch (gu::Exception& e)
+        {
+            log_warn << "GCache ring buffer write-behind failed: " << e.what()
+                     << ". Falling back to kernel writeback.";
+            return false;
+        }
+
+        return true;
+    }
+
+    /* Writes back dirty buffer space in flush_batch_ sized chunks, keeping
+     * one batch behind next_ so that buffers that are still being filled are
+     * not written twice. */
+    void
+    RingBuffer::write_behind()
+    {
+        if (next_ < flushed_)
+        {
+            /* rolled over, whatever was left at the end is complete */
+            queue_write_back(flushed_, end_);
+            flushed_ = start_;
+        }
+
+        while (FLUSH_KERNEL != flush_policy_ &&
+               size_t(next_ - flushed_) >= 2 * flush_batch_)
+        {
+            queue_write_back(flushed_, flushed_ + flush_batch_);
+            flushed_ += flush_batch_;
+        }
+    }
+
     void*
     RingBuffer::malloc (size_type const size)
     {
@@ -337,6 +417,7 @@ namespace gcache
             if (adj_ptr == next_)
             {
                 ssize_type const size_trail_saved(size_trail_);
+                uint8_t*   const flushed_saved(flushed_);
                 void* const adj_buf (get_new_buffer (adj_size));
 
                 BH_assert_clear(BH_cast(next_));
@@ -354,6 +435,7 @@ namespace gcache
                     size_used_ -= adj_size;
                     size_free_ += adj_size;
                     if (next_ < first_) size_trail_ = size_trail_saved;
+                    flushed_ = std::min(flushed_saved, next_);
                 }
             }
         }
@@ -538,7 +620,8 @@ namespace gcache
             << "\nnext_  : " << BH_cast(next_) << ", off: " << next_  - start_
             << "\nsize   : " << size_cache_
             << "\nfree   : " << size_free_
-            << "\nused   : " << size_used_;
+            << "\nused   : " << size_used_
+            << "\nflush  : " << flush_policy_ << '/' << flush_batch_;
     }
 
     std::string const RingBuffer::PR_KEY_VERSION   = "Version:";
@@ -16,6 +16,7 @@
 #include <gu_uuid.hpp>
 
 #include <string>
+#include <vector>
 
 namespace gcache
 {
@@ -23,6 +24,14 @@ namespace gcache
     {
     public:
 
+        /* How dirty ring buffer pages are written back to disk */
+        enum FlushPolicy
+        {
+            FLUSH_KERNEL, /* leave it to kernel dirty page writeback */
+            FLUSH_ASYNC,  /* initiate writeback of every completed batch */
+            FLUSH_SYNC    /* write every completed batch synchronously */
+        };
+
         RingBuffer (const std::string& name,
                     size_t             size,
                     seqno2ptr_t&       seqno2ptr,
@@ -114,6 +123,32 @@ namespace gcache
 
         void set_debug(int const dbg) { debug_ = dbg & DEBUG; }
 
+        /* batch is rounded up to a multiple of page size */
+        void set_flush_policy(FlushPolicy policy, size_t batch);
+
+        FlushPolicy flush_policy() const { return flush_policy_; }
+        size_t      flush_batch()  const { return flush_batch_;  }
+
+        /* file ranges (offset, length) due for write-behind */
+        typedef std::vector<std::pair<off_t, off_t> > WriteBackQueue;
+
+        /* Moves ranges queued for write-behind by allocations to q and
+         * returns true if writeback must be waited for. Must be called
+         * under the same lock as malloc(), the actual write_back() is
+         * supposed to be done after releasing it. */
+        bool take_write_back(WriteBackQueue& q)
+        {
+            q.swap(write_back_q_);
+            write_back_q_.clear();
+            return (FLUSH_SYNC == flush_policy_);
+        }
+
+        /* Writes back queued ranges, does not access ring buffer state and
+         * can be called without lock. Returns false if writeback failed,
+         * then write-behind should be disabled with
+         * set_flush_policy(FLUSH_KERNEL, ...) */
+        bool write_back(const WriteBackQueue& q, bool wait) const;
+
 #ifdef GCACHE_RB_UNIT_TEST
         ptrdiff_t offset(const void* const ptr) const
         {
@@ -154,10 +189,18 @@ namespace gcache
 
         int                debug_;
 
+        FlushPolicy        flush_policy_;
+        size_t             flush_batch_;
+        uint8_t*           flushed_;  // end of the range written back so far
+        WriteBackQueue     write_back_q_;
+
         bool               open_;
 
         BufferHeader* get_new_buffer (size_type size);
 
+        void          queue_write_back(const uint8_t* from, const uint8_t* to);
+        void          write_behind();
+
         void          constructor_common();
 
         /* preamble fields */
@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2021 Codership Oy <info@codership.com>
+ */
+
+#include "GCache.hpp"
+#include "gcache_history_test.hpp"
+
+#include <gu_config.hpp>
+#include <gu_logger.hpp>
+
+#include <cstring>
+#include <vector>
+#include <unistd.h> // usleep()
+
+using namespace gcache;
+
+static std::string
+status_get (const GCache& gc, const std::string& key)
+{
+    gu::Status status;
+    gc.get_status(status);
+
+    for (gu::Status::const_iterator i(status.begin()); i != status.end(); ++i)
+    {
+        if (i->first == key) return i->second;
+    }
+
+    ck_abort_msg("status variable '%s' not found", key.c_str());
+    return "";
+}
+
+/* polls gcache_history_held for up to tries * 100ms */
+static bool
+wait_held (const GCache& gc, const std::string& val, int tries)
+{
+    while (status_get(gc, "gcache_history_held") != val)
+    {
+        if (--tries < 0) return false;
+        ::usleep(100000);
+    }
+
+    return true;
+}
+
+START_TEST(keep_history)
+{
+    gu::Config conf;
+    GCache::register_params(conf);
+    conf.parse("gcache.size = 1M; gcache.keep_history = PT1S");
+
+    GCache* const gc(new GCache(conf, "."));
+
+    seqno_t const last(10);
+
+    for (seqno_t s(1); s <= last; ++s)
+    {
+        void* const buf(gc->malloc(128));
+        ck_assert(NULL != buf);
+        gc->seqno_assign(buf, s, s - 1);
+    }
+
+    ck_assert(status_get(*gc, "gcache_history_seqnos") == "10");
+
+    /* history is younger than keep_history, nothing can be released */
+    gc->seqno_release(last);
+    ck_assert(status_get(*gc, "gcache_history_held") == "10");
+
+    /* once history ages out it is released without further
+     * seqno_release() calls */
+    ck_assert(wait_held(*gc, "0", 50));
+    ck_assert(status_get(*gc, "gcache_history_seconds") != "");
+
+    /* retention period can be changed in runtime */
+    gc->param_set("gcache.keep_history", "PT1H");
+    void* const buf(gc->malloc(128));
+    gc->seqno_assign(buf, last + 1, last);
+    gc->seqno_release(last + 1);
+    ck_assert(status_get(*gc, "gcache_history_held") == "1");
+
+    /* disabling retention releases everything right away */
+    gc->param_set("gcache.keep_history", "PT0S");
+    ck_assert(wait_held(*gc, "0", 10));
+
+    /* history reset must not trip on held back buffers */
+    gc->param_set("gcache.keep_history", "PT1H");
+    void* const buf2(gc->malloc(128));
+    gc->seqno_assign(buf2, last + 2, last + 1);
+    gc->seqno_release(last + 2);
+    gc->seqno_reset(gu::UUID(NULL, 0), SEQNO_NONE);
+    ck_assert(status_get(*gc, "gcache_history_held") == "0");
+
+    delete gc;
+    ::unlink(conf.get("gcache.name").c_str());
+}
+END_TEST
+
+static void
+fill_buffer (void* const buf, size_t const size, seqno_t const seqno)
+{
+    char* const p(static_cast<char*>(buf));
+
+    if (0 == seqno % 7)
+    {
+        /* incompressible */
+        uint32_t x(seqno);
+        for (size_t i(0); i < size; ++i)
+        {
+            x = x * 1103515245 + 12345;
+            p[i] = char(x >> 24);
+        }
+        return;
+    }
+
+    /* compressible, but seqno-specific contents */
+    for (size_t i(0); i < size; ++i) p[i] = char(seqno + i / 64);
+}
+
+static bool
+check_buffer (const GCache::Buffer& buf, size_t const size)
+{
+    if (buf.size() != GCache::ssize_type(size)) return false;
+
+    std::vector<char> expected(size);
+    fill_buffer(&expected[0], size, buf.seqno_g());
+
+    return (0 == ::memcmp(&expected[0], buf.ptr(), size));
+}
+
+START_TEST(cold_store)
+{
+    gu::Config conf;
+    GCache::register_params(conf);
+    conf.parse("gcache.size = 1M; gcache.page_size = 1M; "
+               "gcache.cold_size = 4M; gcache.cold_after = 16");
+
+    GCache* const gc(new GCache(conf, "."));
+
+    size_t  const size(4000);
+    seqno_t const last(2000); // 8M of raw history, way more than RB
+
+    for (seqno_t s(1); s <= last; ++s)
+    {
+        void* const buf(gc->malloc(size));
+        ck_assert(NULL != buf);
+        fill_buffer(buf, size, s);
+        gc->seqno_assign(buf, s, s - 1);
+        gc->seqno_release(s);
+    }
+
+    /* all history is retained in compressed form, incompressible buffers
+     * are moved to the cold store as is */
+    ck_assert_msg(1 == gc->seqno_min(), "seqno_min: %lld",
+                  (long long)gc->seqno_min());
+    ck_assert(status_get(*gc, "gcache_cold_size") != "0");
+
+    /* and is transparently decompressed */
+    std::vector<GCache::Buffer> v(64);
+    seqno_t s(1);
+
+    gc->seqno_lock(s);
+    while (s <= last)
+    {
+        size_t const n(gc->seqno_get_buffers(v, s));
+        ck_assert(n > 0);
+
+        for (size_t i(0); i < n; ++i)
+        {
+            ck_assert(v[i].seqno_g() == s + seqno_t(i));
+            ck_assert_msg(check_buffer(v[i], size), "seqno %lld corrupt",
+                          (long long)v[i].seqno_g());
+        }
+
+        s += n;
+    }
+    gc->seqno_unlock();
+
+    /* shrinking cold store discards oldest history */
+    gc->param_set("gcache.cold_size", "512K");
+    ck_assert(gc->seqno_min() > 1);
+
+    /* history reset clears cold store */
+    gc->seqno_reset(gu::UUID(NULL, 0), SEQNO_NONE);
+    ck_assert(status_get(*gc, "gcache_cold_size") == "0");
+
+    delete gc;
+    ::unlink(conf.get("gcache.name").c_str());
+}
+END_TEST
+
+Suite* gcache_history_suite()
+{
+    Suite* ts = suite_create("gcache::History");
+    TCase* tc = tcase_create("keep_history");
+
+    tcase_set_timeout(tc, 60);
+    tcase_add_test(tc, keep_history);
+    suite_add_tcase(ts, tc);
+
+    tc = tcase_create("cold_store");
+
+    tcase_set_timeout(tc, 60);
+    tcase_add_test(tc, cold_store);
+    suite_add_tcase(ts, tc);
+
+    return ts;
+}
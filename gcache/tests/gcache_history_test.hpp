@@ -0,0 +1,13 @@
+/*
+ * Copyright (C) 2021 Codership Oy <info@codership.com>
+ */
+#ifndef __gcache_history_test_hpp__
+#define __gcache_history_test_hpp__
+
+extern "C" {
+#include <check.h>
+}
+
+extern Suite* gcache_history_suite();
+
+#endif // __gcache_history_test_hpp__
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2021 Codership Oy <info@codership.com>
+ */
+
+/**
+ * Ring buffer allocation latency benchmark. Compares the tail latency of
+ * RingBuffer allocations (the time GCache lock is held) and the throughput
+ * of filling the buffers with different flush policies: kernel dirty page
+ * writeback vs. explicit write-behind done outside of the lock.
+ *
+ * Usage: gcache_rb_bench [file [rb_size [buf_size [iterations [policy]]]]]
+ *        where policy is one of kernel, async, sync or all (default)
+ */
+
+#include "gcache_rb_store.hpp"
+#include "gcache_bh.hpp"
+
+#include <gu_config.hpp>
+#include <gu_time.h>
+
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+
+using namespace gcache;
+
+struct Policy
+{
+    const char*             name;
+    RingBuffer::FlushPolicy policy;
+};
+
+static Policy const POLICIES[] =
+{
+    { "kernel", RingBuffer::FLUSH_KERNEL },
+    { "async",  RingBuffer::FLUSH_ASYNC  },
+    { "sync",   RingBuffer::FLUSH_SYNC   }
+};
+
+static size_t const BATCH(16 << 20);
+
+static void
+run(const std::string& name, size_t const rb_size, size_t const buf_size,
+    long const iterations, const Policy& policy)
+{
+    ::unlink(name.c_str());
+
+    seqno2ptr_t s2p(SEQNO_NONE);
+    gu::UUID    gid;
+    RingBuffer  rb(name, rb_size, s2p, gid, 0, false);
+
+    rb.set_flush_policy(policy.policy, BATCH);
+
+    MemOps::size_type const size
+        (MemOps::align_size(buf_size + sizeof(BufferHeader)));
+    std::vector<long long> lat(iterations);
+
+    long long const begin(gu_time_monotonic());
+
+    for (long i(0); i < iterations; ++i)
+    {
+        long long const start(gu_time_monotonic());
+
+        void* const buf(rb.malloc(size));
+        if (!buf)
+        {
+            std::cerr << "malloc(" << size << ") failed" << std::endl;
+            ::exit(EXIT_FAILURE);
+        }
+        RingBuffer::WriteBackQueue q;
+        bool const wait(rb.take_write_back(q));
+
+        /* allocation latency is the time GCache lock is held */
+        lat[i] = gu_time_monotonic() - start;
+
+        ::memset(buf, int(i), buf_size);
+        rb.write_back(q, wait);
+
+        BufferHeader* const bh(ptr2BH(buf));
+        BH_release(bh);
+        rb.free(bh);
+    }
+
+    double const total(double(gu_time_monotonic() - begin) * 1.0e-9);
+
+    std::sort(lat.begin(), lat.end());
+
+    std::cout << std::setw(7) << policy.name
+              << ": " << std::fixed << std::setprecision(1)
+              << (double(buf_size) * iterations / total / (1 << 20)) << " MB/s"
+              << ", latency (us) p50: " << lat[iterations * 50 / 100] / 1000.0
+              << ", p99: "   << lat[iterations * 99 / 100] / 1000.0
+              << ", p99.9: " << lat[iterations * 999 / 1000] / 1000.0
+              << ", max: "   << lat[iterations - 1] / 1000.0
+              << std::endl;
+
+    ::unlink(name.c_str());
+}
+
+int main(int argc, char* argv[])
+{
+    std::string const name(argc > 1 ? argv[1] : "rb_bench.cache");
+    size_t const rb_size (argc > 2 ?
+                          gu::Config::from_config<size_t>(argv[2]) : 1 << 30);
+    size_t const buf_size(argc > 3 ?
+                          gu::Config::from_config<size_t>(argv[3]) : 4096);
+    long   const iterations(argc > 4 ? ::atol(argv[4]) : 1000000);
+    std::string const policy(argc > 5 ? argv[5] : "all");
+
+    if (iterations <= 0)
+    {
+        std::cerr << "Number of iterations must be positive" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Ring buffer: " << rb_size << " bytes, buffer: " << buf_size
+              << " bytes, iterations: " << iterations << std::endl;
+
+    for (size_t i(0); i < sizeof(POLICIES)/sizeof(POLICIES[0]); ++i)
+    {
+        if ("all" == policy || POLICIES[i].name == policy)
+        {
+            run(name, rb_size, buf_size, iterations, POLICIES[i]);
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -12,6 +12,7 @@
 
 #include <gu_logger.hpp>
 #include <gu_throw.hpp>
+#include <gu_limits.h> // GU_PAGE_SIZE
 
 using namespace gcache;
 
@@ -506,6 +507,64 @@ START_TEST(recovery)
 }
 END_TEST
 
+START_TEST(write_behind)
+{
+    ::unlink(RB_NAME.c_str());
+
+    size_t const rb_size(1 << 20);
+    size_t const buf_size(ALLOC_SIZE(3000));
+
+    seqno2ptr_t s2p(SEQNO_NONE);
+    gu::UUID   gid(GID);
+    RingBuffer rb(RB_NAME, rb_size, s2p, gid, 0, false);
+
+    RingBuffer::FlushPolicy const policies[] =
+        { RingBuffer::FLUSH_ASYNC, RingBuffer::FLUSH_SYNC };
+
+    for (size_t p(0); p < sizeof(policies)/sizeof(policies[0]); ++p)
+    {
+        rb.set_flush_policy(policies[p], 1);
+        ck_assert(rb.flush_policy() == policies[p]);
+        ck_assert(rb.flush_batch() > 0);
+        ck_assert(rb.flush_batch() % GU_PAGE_SIZE == 0);
+
+        size_t queued(0);
+
+        /* go around the ring a few times to exercise rollover */
+        for (size_t i(0); i < 3 * rb_size / buf_size; ++i)
+        {
+            void* const buf(rb.malloc(buf_size));
+            ck_assert(NULL != buf);
+            ::memset(buf, int(i), buf_size - BH_SIZE);
+
+            /* allocation only queues ranges for writeback */
+            RingBuffer::WriteBackQueue q;
+            bool const wait(rb.take_write_back(q));
+            ck_assert(wait == (RingBuffer::FLUSH_SYNC == policies[p]));
+            ck_assert(rb.write_back(q, wait));
+            queued += q.size();
+
+            RingBuffer::WriteBackQueue empty;
+            rb.take_write_back(empty);
+            ck_assert(empty.empty());
+
+            BufferHeader* const bh(ptr2BH(buf));
+            BH_release(bh);
+            rb.free(bh);
+        }
+
+        ck_assert(queued > 0);
+
+        /* policy must not be reset by a write-behind error */
+        ck_assert(rb.flush_policy() == policies[p]);
+    }
+
+    rb.set_flush_policy(RingBuffer::FLUSH_KERNEL, 0);
+    ck_assert(rb.flush_policy() == RingBuffer::FLUSH_KERNEL);
+
+    ::unlink(RB_NAME.c_str());
+}
+END_TEST
 
 Suite* gcache_rb_suite()
 {
@@ -522,5 +581,11 @@ Suite* gcache_rb_suite()
     tcase_add_test(tc, recovery);
     suite_add_tcase(ts, tc);
 
+    tc = tcase_create("write_behind");
+
+    tcase_set_timeout(tc, 60);
+    tcase_add_test(tc, write_behind);
+    suite_add_tcase(ts, tc);
+
     return ts;
 }
@@ -11,6 +11,7 @@
 #include "gcache_mem_test.hpp"
 #include "gcache_rb_test.hpp"
 #include "gcache_page_test.hpp"
+#include "gcache_history_test.hpp"
 
 extern "C" {
 #include <check.h>
@@ -23,6 +24,7 @@ static suite_creator_t suites[] =
     gcache_mem_suite,
     gcache_rb_suite,
     gcache_page_suite,
+    gcache_history_suite,
     0
 };
 
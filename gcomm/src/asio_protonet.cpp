@@ -14,10 +14,174 @@
 
 #include "gu_logger.hpp"
 #include "gu_shared_ptr.hpp"
+#include "gu_threads.h"
 
 #include <boost/bind.hpp>
 
 #include <fstream>
+#include <vector>
+#include <cstring>
+
+
+/*
+ * Runs io_service in io_threads - 1 additional threads while event_loop()
+ * runs it in the calling thread. Threads are started once and wait for
+ * the next event_loop() call in between.
+ */
+class gcomm::AsioProtonet::IoThreadPool
+{
+public:
+
+    IoThreadPool(asio::io_service& io_service, int size)
+        :
+        io_service_(io_service),
+        mutex_     (),
+        start_cond_(),
+        done_cond_ (),
+        threads_   (),
+        round_     (0),
+        running_   (0),
+        exit_      (false),
+        errno_     (0),
+        what_      ()
+    {
+        threads_.reserve(size);
+
+        for (int i(0); i < size; ++i)
+        {
+            gu_thread_t thd;
+            int const err(gu_thread_create(&thd, 0, run_io_thread, this));
+            if (err != 0)
+            {
+                log_warn << "Failed to start socket I/O thread: " << err
+                         << " (" << ::strerror(err) << "), running with "
+                         << threads_.size() + 1 << " threads";
+                break;
+            }
+            threads_.push_back(thd);
+        }
+    }
+
+    ~IoThreadPool()
+    {
+        {
+            gu::Lock lock(mutex_);
+            exit_ = true;
+            start_cond_.broadcast();
+        }
+
+        for (std::vector<gu_thread_t>::iterator i(threads_.begin());
+             i != threads_.end(); ++i)
+        {
+            gu_thread_join(*i, 0);
+        }
+    }
+
+    // Runs io_service in the calling thread and in pool threads until it
+    // is stopped. Exception from a pool thread is rethrown to the caller.
+    void run()
+    {
+        {
+            gu::Lock lock(mutex_);
+            ++round_;
+            running_ = threads_.size();
+            start_cond_.broadcast();
+        }
+
+        try
+        {
+            io_service_.run();
+        }
+        catch (...)
+        {
+            io_service_.stop();
+            wait_done();
+            throw;
+        }
+
+        wait_done();
+
+        gu::Lock lock(mutex_);
+        if (errno_ != 0)
+        {
+            int const err(errno_);
+            errno_ = 0;
+            gu_throw_error(err) << what_;
+        }
+    }
+
+private:
+
+    IoThreadPool(const IoThreadPool&);
+    void operator=(const IoThreadPool&);
+
+    static void* run_io_thread(void* arg)
+    {
+        static_cast<IoThreadPool*>(arg)->worker();
+        return 0;
+    }
+
+    void worker()
+    {
+        long long done(0);
+
+        while (true)
+        {
+            {
+                gu::Lock lock(mutex_);
+                while (round_ == done && !exit_) lock.wait(start_cond_);
+                if (exit_) return;
+                done = round_;
+            }
+
+            int         err(0);
+            std::string what;
+
+            try
+            {
+                io_service_.run();
+            }
+            catch (gu::Exception& e)
+            {
+                err  = e.get_errno();
+                what = e.what();
+                io_service_.stop();
+            }
+            catch (std::exception& e)
+            {
+                err  = EPROTO;
+                what = e.what();
+                io_service_.stop();
+            }
+
+            gu::Lock lock(mutex_);
+            if (err != 0 && errno_ == 0)
+            {
+                errno_ = err;
+                what_  = what;
+            }
+            if (--running_ == 0) done_cond_.signal();
+        }
+    }
+
+    // io_service must not be reset before all threads have left run()
+    void wait_done()
+    {
+        gu::Lock lock(mutex_);
+        while (running_ > 0) lock.wait(done_cond_);
+    }
+
+    asio::io_service&        io_service_;
+    gu::Mutex                mutex_;
+    gu::Cond                 start_cond_;
+    gu::Cond                 done_cond_;
+    std::vector<gu_thread_t> threads_;
+    long long                round_;
+    int                      running_;
+    bool                     exit_;
+    int                      errno_;
+    std::string              what_;
+};
 
 
 gcomm::AsioProtonet::AsioProtonet(gu::Config& conf, int version)
@@ -29,6 +193,10 @@ gcomm::AsioProtonet::AsioProtonet(gu::Config& conf, int version)
     timer_(io_service_),
     ssl_context_(io_service_, asio::ssl::context::sslv23),
     mtu_(1 << 15),
+    io_threads_(check_range(Conf::SocketIoThreads,
+                            conf.get<int>(Conf::SocketIoThreads),
+                            1, 65)),
+    io_pool_(0),
     checksum_(NetHeader::checksum_type(
                   conf.get<int>(gcomm::Conf::SocketChecksum,
                                 NetHeader::CS_CRC32C)))
@@ -54,7 +222,7 @@ gcomm::AsioProtonet::AsioProtonet(gu::Config& conf, int version)
 
 gcomm::AsioProtonet::~AsioProtonet()
 {
-
+    delete io_pool_;
 }
 
 void gcomm::AsioProtonet::enter()
@@ -113,7 +281,18 @@ void gcomm::AsioProtonet::event_loop(const gu::datetime::Period& period)
     timer_.expires_from_now(boost::posix_time::nanosec(p.get_nsecs()));
     timer_.async_wait(boost::bind(&AsioProtonet::handle_wait, this,
                                   asio::placeholders::error));
-    io_service_.run();
+    if (io_threads_ > 1)
+    {
+        if (io_pool_ == 0)
+        {
+            io_pool_ = new IoThreadPool(io_service_, io_threads_ - 1);
+        }
+        io_pool_->run();
+    }
+    else
+    {
+        io_service_.run();
+    }
 }
 
 
@@ -46,6 +46,8 @@ private:
     friend class AsioUdpSocket;
     AsioProtonet(const AsioProtonet&);
 
+    class IoThreadPool;
+
     void handle_wait(const asio::error_code& ec);
 
     gu::RecursiveMutex          mutex_;
@@ -54,6 +56,9 @@ private:
     asio::deadline_timer        timer_;
     asio::ssl::context          ssl_context_;
     size_t                      mtu_;
+    int                         io_threads_;
+    // Additional socket I/O threads, started at first event_loop() call
+    IoThreadPool*               io_pool_;
 
     NetHeader::checksum_t       checksum_;
 };
@@ -69,10 +69,16 @@ gcomm::AsioTcpSocket::AsioTcpSocket(AsioProtonet& net, const gu::URI& uri)
     net_         (net),
     socket_      (net.io_service_),
     ssl_socket_  (0),
+    strand_      (net.io_service_),
     send_q_      (),
+    write_q_     (),
+    write_bufs_  (),
+    ssl_write_buf_(),
+    ktls_tx_     (false),
     last_queued_tstamp_(),
     recv_buf_    (net_.mtu() + NetHeader::serial_size_),
     recv_offset_ (0),
+    recv_pool_   (max_recv_pool_buffers),
     last_delivered_tstamp_(),
     state_       (S_CLOSED),
     local_addr_  (),
@@ -119,6 +125,8 @@ void gcomm::AsioTcpSocket::failed_handler(const asio::error_code& ec,
 
 void gcomm::AsioTcpSocket::handshake_handler(const asio::error_code& ec)
 {
+    Critical<AsioProtonet> crit(net_);
+
     if (ec)
     {
         if (ec.category() == asio::error::get_ssl_category() &&
@@ -152,6 +160,14 @@ void gcomm::AsioTcpSocket::handshake_handler(const asio::error_code& ec)
              << " cipher: " << gu::cipher(*ssl_socket_)
              << " compression: "
              << (compression_name != NULL ? compression_name : "none");
+
+    // Nothing has been sent over the connection since handshake yet,
+    // so transmit keys can be handed over to the kernel now.
+    if (net_.conf().get(gu::conf::ssl_ktls, false) == true)
+    {
+        ktls_tx_ = gu::ssl_enable_ktls_tx(*ssl_socket_);
+    }
+
     state_ = S_CONNECTED;
     init_tstamps();
     net_.dispatch(id(), Datagram(), ProtoUpMeta(ec.value()));
@@ -181,9 +197,10 @@ void gcomm::AsioTcpSocket::connect_handler(const asio::error_code& ec)
                           << local_addr();
                 ssl_socket_->async_handshake(
                     asio::ssl::stream<asio::ip::tcp::socket>::client,
-                    boost::bind(&AsioTcpSocket::handshake_handler,
-                                shared_from_this(),
-                                asio::placeholders::error)
+                    strand_.wrap(
+                        boost::bind(&AsioTcpSocket::handshake_handler,
+                                    shared_from_this(),
+                                    asio::placeholders::error))
                     );
             }
             else
@@ -229,9 +246,10 @@ void gcomm::AsioTcpSocket::connect(const gu::URI& uri)
             ssl_socket_->lowest_layer().open(i->endpoint().protocol());
             set_buf_sizes(); // Must be done before connect
             ssl_socket_->lowest_layer().async_connect(
-                *i, boost::bind(&AsioTcpSocket::connect_handler,
+                *i, strand_.wrap(
+                    boost::bind(&AsioTcpSocket::connect_handler,
                                 shared_from_this(),
-                                asio::placeholders::error)
+                                asio::placeholders::error))
             );
         }
         else
@@ -245,9 +263,11 @@ void gcomm::AsioTcpSocket::connect(const gu::URI& uri)
                 socket_.bind(ep);
             }
             set_buf_sizes(); // Must be done before connect
-            socket_.async_connect(*i, boost::bind(&AsioTcpSocket::connect_handler,
-                                                  shared_from_this(),
-                                                  asio::placeholders::error));
+            socket_.async_connect(*i, strand_.wrap(
+                                      boost::bind(
+                                          &AsioTcpSocket::connect_handler,
+                                          shared_from_this(),
+                                          asio::placeholders::error)));
         }
         state_ = S_CONNECTING;
     }
@@ -271,9 +291,20 @@ void gcomm::AsioTcpSocket::close()
     log_debug << "closing " << id() << " state " << state()
               << " send_q size " << send_q_.size();
 
-    if (send_q_.empty() == true || state() != S_CONNECTED)
+    if ((send_q_.empty() == true && write_q_.empty() == true) ||
+        state() != S_CONNECTED)
     {
-        close_socket();
+        if (net_.io_threads_ > 1)
+        {
+            // Operations on the socket may be in progress in other
+            // I/O threads, close it from the socket strand.
+            strand_.post(boost::bind(&AsioTcpSocket::close_socket,
+                                     shared_from_this()));
+        }
+        else
+        {
+            close_socket();
+        }
         state_ = S_CLOSED;
     }
     else
@@ -294,98 +325,108 @@ void gcomm::AsioTcpSocket::write_handler(const asio::error_code& ec,
     static const long bytes_transferred_not_zero_rate(10000);
 #endif // GCOMM_ASIO_TCP_SIMULATE_WRITE_HANDLER_ERROR
 
-    Critical<AsioProtonet> crit(net_);
-
-    if (state() != S_CONNECTED && state() != S_CLOSING)
+    bool write(false);
     {
-        log_debug << "write handler for " << id()
-                  << " state " << state();
-        if (ec.category() == asio::error::get_ssl_category() &&
-            gu::exclude_ssl_error(ec) == false)
+        Critical<AsioProtonet> crit(net_);
+
+        if (state() != S_CONNECTED && state() != S_CLOSING)
         {
-            log_warn << "write_handler(): " << ec.message()
-                     << " (" << gu::extra_error_info(ec) << ")";
+            log_debug << "write handler for " << id()
+                      << " state " << state();
+            if (ec.category() == asio::error::get_ssl_category() &&
+                gu::exclude_ssl_error(ec) == false)
+            {
+                log_warn << "write_handler(): " << ec.message()
+                         << " (" << gu::extra_error_info(ec) << ")";
+            }
+            return;
         }
-        return;
-    }
 
-    if (!ec)
-    {
-        if (send_q_.empty() == true
-#ifdef GCOMM_ASIO_TCP_SIMULATE_WRITE_HANDLER_ERROR
-            || ::rand() % empty_rate == 0
-#endif // GCOMM_ASIO_TCP_SIMULATE_WRITE_HANDLER_ERROR
-            )
+        if (!ec)
         {
-            log_warn << "write_handler() called with empty send_q_. "
-                     << "Transport may not be reliable, closing the socket";
-            FAILED_HANDLER(asio::error_code(EPROTO,
-                                            asio::error::system_category));
-        }
-        else if (send_q_.front().len() < bytes_transferred
+            size_t batch_bytes(0);
+            for (std::vector<Datagram>::const_iterator i(write_q_.begin());
+                 i != write_q_.end(); ++i)
+            {
+                batch_bytes += i->len();
+            }
+
+            if (write_q_.empty() == true
 #ifdef GCOMM_ASIO_TCP_SIMULATE_WRITE_HANDLER_ERROR
-                 || ::rand() % bytes_transferred_less_than_rate == 0
+                || ::rand() % empty_rate == 0
 #endif // GCOMM_ASIO_TCP_SIMULATE_WRITE_HANDLER_ERROR
-            )
-        {
-            log_warn << "write_handler() bytes_transferred "
-                     << bytes_transferred
-                     << " less than sent "
-                     << send_q_.front().len()
-                     << ". Transport may not be reliable, closing the socket";
-            FAILED_HANDLER(asio::error_code(EPROTO,
-                                            asio::error::system_category));
-        }
-        else
-        {
-            while (send_q_.empty() == false &&
-                   bytes_transferred >= send_q_.front().len())
+                )
             {
-                const Datagram& dg(send_q_.front());
-                bytes_transferred -= dg.len();
-                send_q_.pop_front();
+                log_warn << "write_handler() called with empty write_q_. "
+                         << "Transport may not be reliable, closing the socket";
+                FAILED_HANDLER(asio::error_code(EPROTO,
+                                                asio::error::system_category));
             }
-            if (bytes_transferred != 0
+            else if (batch_bytes < bytes_transferred
 #ifdef GCOMM_ASIO_TCP_SIMULATE_WRITE_HANDLER_ERROR
-                || ::rand() % bytes_transferred_not_zero_rate == 0
+                     || ::rand() % bytes_transferred_less_than_rate == 0
 #endif // GCOMM_ASIO_TCP_SIMULATE_WRITE_HANDLER_ERROR
                 )
             {
                 log_warn << "write_handler() bytes_transferred "
                          << bytes_transferred
-                         << " after processing the send_q_. "
-                         << "Transport may not be reliable, closing the socket";
+                         << " less than sent "
+                         << batch_bytes
+                         << ". Transport may not be reliable, "
+                         << "closing the socket";
                 FAILED_HANDLER(asio::error_code(EPROTO,
                                                 asio::error::system_category));
             }
-            else if (send_q_.empty() == false)
+            else if (bytes_transferred != batch_bytes
+#ifdef GCOMM_ASIO_TCP_SIMULATE_WRITE_HANDLER_ERROR
+                     || ::rand() % bytes_transferred_not_zero_rate == 0
+#endif // GCOMM_ASIO_TCP_SIMULATE_WRITE_HANDLER_ERROR
+                )
             {
-                const Datagram& dg(send_q_.front());
-                gu::array<asio::const_buffer, 2>::type cbs;
-                cbs[0] = asio::const_buffer(dg.header()
-                                            + dg.header_offset(),
-                                            dg.header_len());
-                cbs[1] = asio::const_buffer(dg.payload().data(),
-                                            dg.payload().size());
-                write_one(cbs);
+                log_warn << "write_handler() bytes_transferred "
+                         << bytes_transferred
+                         << " does not match " << batch_bytes
+                         << " bytes of " << write_q_.size()
+                         << " datagrams sent. "
+                         << "Transport may not be reliable, closing the socket";
+                FAILED_HANDLER(asio::error_code(EPROTO,
+                                                asio::error::system_category));
             }
-            else if (state_ == S_CLOSING)
+            else
             {
-                log_debug << "deferred close of " << id();
-                close_socket();
-                state_ = S_CLOSED;
+                write_q_.clear();
+                write_bufs_.clear();
+
+                if (send_q_.empty() == false)
+                {
+                    take_write_batch();
+                    write = true;
+                }
+                else if (state_ == S_CLOSING)
+                {
+                    log_debug << "deferred close of " << id();
+                    close_socket();
+                    state_ = S_CLOSED;
+                }
             }
         }
+        else if (state_ == S_CLOSING)
+        {
+            log_debug << "deferred close of " << id() << " error " << ec;
+            close_socket();
+            state_ = S_CLOSED;
+        }
+        else
+        {
+            FAILED_HANDLER(ec);
+        }
     }
-    else if (state_ == S_CLOSING)
-    {
-        log_debug << "deferred close of " << id() << " error " << ec;
-        close_socket();
-        state_ = S_CLOSED;
-    }
-    else
+
+    // Header serialization, checksums and encryption of the next batch
+    // are done outside of the critical section.
+    if (write == true)
     {
-        FAILED_HANDLER(ec);
+        write_batch();
     }
 }
 
@@ -412,23 +453,27 @@ namespace gcomm
         { }
         void operator()()
         {
-            Critical<AsioProtonet> crit(socket_->net_);
-            // Send queue is processed also in closing state
-            // in order to deliver as many messages as possible,
-            // even if the socket has been discarded by
-            // upper layers.
-            if ((socket_->state() == gcomm::Socket::S_CONNECTED ||
-                 socket_->state() == gcomm::Socket::S_CLOSING) &&
-                socket_->send_q_.empty() == false)
+            bool write(false);
             {
-                const gcomm::Datagram& dg(socket_->send_q_.front());
-                gu::array<asio::const_buffer, 2>::type cbs;
-                cbs[0] = asio::const_buffer(dg.header()
-                                            + dg.header_offset(),
-                                            dg.header_len());
-                cbs[1] = asio::const_buffer(dg.payload().data(),
-                                            dg.payload().size());
-                socket_->write_one(cbs);
+                Critical<AsioProtonet> crit(socket_->net_);
+                // Send queue is processed also in closing state
+                // in order to deliver as many messages as possible,
+                // even if the socket has been discarded by
+                // upper layers.
+                // If a write is already in progress, write_handler() will
+                // continue with the datagrams queued meanwhile.
+                if ((socket_->state() == gcomm::Socket::S_CONNECTED ||
+                     socket_->state() == gcomm::Socket::S_CLOSING) &&
+                    socket_->send_q_.empty() == false &&
+                    socket_->write_q_.empty() == true)
+                {
+                    socket_->take_write_batch();
+                    write = true;
+                }
+            }
+            if (write == true)
+            {
+                socket_->write_batch();
             }
         }
     private:
@@ -450,26 +495,16 @@ int gcomm::AsioTcpSocket::send(int segment, const Datagram& dg)
         return ENOBUFS;
     }
 
-    NetHeader hdr(static_cast<uint32_t>(dg.len()), net_.version_);
-
-    if (net_.checksum_ != NetHeader::CS_NONE)
-    {
-        hdr.set_crc32(crc32(net_.checksum_, dg), net_.checksum_);
-    }
-
     last_queued_tstamp_ = gu::datetime::Date::monotonic();
-    // Make copy of datagram to be able to adjust the header
+    // Make copy of datagram to be able to adjust the header,
+    // NetHeader is serialized by write_batch()
     Datagram priv_dg(dg);
     priv_dg.set_header_offset(priv_dg.header_offset() -
                               NetHeader::serial_size_);
-    serialize(hdr,
-              priv_dg.header(),
-              priv_dg.header_size(),
-              priv_dg.header_offset());
     send_q_.push_back(segment, priv_dg);
-    if (send_q_.size() == 1)
+    if (send_q_.size() == 1 && write_q_.empty() == true)
     {
-        net_.io_service_.post(AsioPostForSendHandler(shared_from_this()));
+        strand_.post(AsioPostForSendHandler(shared_from_this()));
     }
     return 0;
 }
@@ -478,27 +513,32 @@ int gcomm::AsioTcpSocket::send(int segment, const Datagram& dg)
 void gcomm::AsioTcpSocket::read_handler(const asio::error_code& ec,
                                         const size_t bytes_transferred)
 {
-    Critical<AsioProtonet> crit(net_);
-
-    if (ec)
     {
-        if (ec.category() == asio::error::get_ssl_category() &&
-            gu::exclude_ssl_error(ec) == false)
+        Critical<AsioProtonet> crit(net_);
+
+        if (ec)
         {
-            log_warn << "read_handler(): " << ec.message() << " ("
-                     << gu::extra_error_info(ec) << ")";
+            if (ec.category() == asio::error::get_ssl_category() &&
+                gu::exclude_ssl_error(ec) == false)
+            {
+                log_warn << "read_handler(): " << ec.message() << " ("
+                         << gu::extra_error_info(ec) << ")";
+            }
+            FAILED_HANDLER(ec);
+            return;
         }
-        FAILED_HANDLER(ec);
-        return;
-    }
 
-    if (state() != S_CONNECTED && state() != S_CLOSING)
-    {
-        log_debug << "read handler for " << id()
-                  << " state " << state();
-        return;
+        if (state() != S_CONNECTED && state() != S_CLOSING)
+        {
+            log_debug << "read handler for " << id()
+                      << " state " << state();
+            return;
+        }
     }
 
+    // Receive buffer is accessed only from the socket strand, message
+    // framing and checksum verification are done outside of the critical
+    // section which is entered only to deliver complete messages.
     recv_offset_ += bytes_transferred;
 
     while (recv_offset_ >= NetHeader::serial_size_)
@@ -510,6 +550,7 @@ void gcomm::AsioTcpSocket::read_handler(const asio::error_code& ec,
         }
         catch (gu::Exception& e)
         {
+            Critical<AsioProtonet> crit(net_);
             FAILED_HANDLER(asio::error_code(e.get_errno(),
                                             asio::error::system_category));
             return;
@@ -517,10 +558,9 @@ void gcomm::AsioTcpSocket::read_handler(const asio::error_code& ec,
         if (recv_offset_ >= hdr.len() + NetHeader::serial_size_)
         {
             Datagram dg(
-                gu::SharedBuffer(
-                    new gu::Buffer(&recv_buf_[0] + NetHeader::serial_size_,
+                recv_pool_.acquire(&recv_buf_[0] + NetHeader::serial_size_,
                                    &recv_buf_[0] + NetHeader::serial_size_
-                                   + hdr.len())));
+                                   + hdr.len()));
             if (net_.checksum_ != NetHeader::CS_NONE)
             {
 #ifdef TEST_NET_CHECKSUM_ERROR
@@ -537,15 +577,25 @@ void gcomm::AsioTcpSocket::read_handler(const asio::error_code& ec,
                              << " has_crc32="  << hdr.has_crc32()
                              << " has_crc32c=" << hdr.has_crc32c()
                              << " crc32=" << hdr.crc32();
+                    Critical<AsioProtonet> crit(net_);
                     FAILED_HANDLER(asio::error_code(
                                        EPROTO,
                                        asio::error::system_category));
                     return;
                 }
             }
-            ProtoUpMeta um;
-            last_delivered_tstamp_ = gu::datetime::Date::monotonic();
-            net_.dispatch(id(), dg, um);
+            {
+                Critical<AsioProtonet> crit(net_);
+                // socket may have been closed or failed by the upper
+                // layers while processing the previous message
+                if (state() != S_CONNECTED && state() != S_CLOSING)
+                {
+                    return;
+                }
+                ProtoUpMeta um;
+                last_delivered_tstamp_ = gu::datetime::Date::monotonic();
+                net_.dispatch(id(), dg, um);
+            }
             recv_offset_ -= NetHeader::serial_size_ + hdr.len();
 
             if (recv_offset_ > 0)
@@ -571,9 +621,9 @@ size_t gcomm::AsioTcpSocket::read_completion_condition(
     const asio::error_code& ec,
     const size_t bytes_transferred)
 {
-    Critical<AsioProtonet> crit(net_);
     if (ec)
     {
+        Critical<AsioProtonet> crit(net_);
         if (ec.category() == asio::error::get_ssl_category() &&
             gu::exclude_ssl_error(ec) == false)
         {
@@ -584,12 +634,9 @@ size_t gcomm::AsioTcpSocket::read_completion_condition(
         return 0;
     }
 
-    if (state() != S_CONNECTED && state() != S_CLOSING)
-    {
-        log_debug << "read completion condition for " << id()
-                  << " state " << state();
-        return 0;
-    }
+    // Socket state is checked by read_handler(), here only the framing
+    // is looked at in order not to enter the critical section on every
+    // partial read.
 
     if (recv_offset_ + bytes_transferred >= NetHeader::serial_size_)
     {
@@ -601,6 +648,7 @@ size_t gcomm::AsioTcpSocket::read_completion_condition(
         catch (gu::Exception& e)
         {
             log_warn << "unserialize error " << e.what();
+            Critical<AsioProtonet> crit(net_);
             FAILED_HANDLER(asio::error_code(e.get_errno(),
                                             asio::error::system_category));
             return 0;
@@ -627,6 +675,13 @@ void gcomm::AsioTcpSocket::async_receive()
     read_one(mbs);
 }
 
+void gcomm::AsioTcpSocket::start_receive()
+{
+    Critical<AsioProtonet> crit(net_);
+
+    if (state() == S_CONNECTED) async_receive();
+}
+
 size_t gcomm::AsioTcpSocket::mtu() const
 {
     return net_.mtu();
@@ -667,10 +722,11 @@ void gcomm::AsioTcpSocket::read_one(
                                shared_from_this(),
                                asio::placeholders::error,
                                asio::placeholders::bytes_transferred),
-                   boost::bind(&AsioTcpSocket::read_handler,
-                               shared_from_this(),
-                               asio::placeholders::error,
-                               asio::placeholders::bytes_transferred));
+                   strand_.wrap(
+                       boost::bind(&AsioTcpSocket::read_handler,
+                                   shared_from_this(),
+                                   asio::placeholders::error,
+                                   asio::placeholders::bytes_transferred)));
     }
     else
     {
@@ -679,32 +735,98 @@ void gcomm::AsioTcpSocket::read_one(
                                shared_from_this(),
                                asio::placeholders::error,
                                asio::placeholders::bytes_transferred),
-                   boost::bind(&AsioTcpSocket::read_handler,
-                               shared_from_this(),
-                               asio::placeholders::error,
-                               asio::placeholders::bytes_transferred));
+                   strand_.wrap(
+                       boost::bind(&AsioTcpSocket::read_handler,
+                                   shared_from_this(),
+                                   asio::placeholders::error,
+                                   asio::placeholders::bytes_transferred)));
     }
 }
 
 
-void gcomm::AsioTcpSocket::write_one(
-    const gu::array<asio::const_buffer, 2>::type& cbs)
+void gcomm::AsioTcpSocket::take_write_batch()
 {
-    if (ssl_socket_ != 0)
+    assert(write_q_.empty());
+    assert(send_q_.empty() == false);
+
+    // Pop datagrams in the order of the send queue segment round robin,
+    // the first one is taken regardless of its size.
+    size_t batch_bytes(0);
+    do
     {
-        async_write(*ssl_socket_, cbs,
-                    boost::bind(&AsioTcpSocket::write_handler,
-                                shared_from_this(),
-                                asio::placeholders::error,
-                                asio::placeholders::bytes_transferred));
+        write_q_.push_back(send_q_.front());
+        batch_bytes += send_q_.front().len();
+        send_q_.pop_front();
+    }
+    while (send_q_.empty() == false &&
+           write_q_.size() < max_write_batch_len &&
+           batch_bytes + send_q_.front().len() <= max_write_batch_bytes);
+}
+
+
+void gcomm::AsioTcpSocket::write_batch()
+{
+    assert(write_q_.empty() == false);
+    assert(write_bufs_.empty());
+
+    // Buffers point into datagrams in write_q_, so they must be set up
+    // only after write_q_ is complete.
+    write_bufs_.reserve(2 * write_q_.size());
+    for (std::vector<Datagram>::iterator i(write_q_.begin());
+         i != write_q_.end(); ++i)
+    {
+        NetHeader hdr(static_cast<uint32_t>(i->len()
+                                            - NetHeader::serial_size_),
+                      net_.version_);
+
+        if (net_.checksum_ != NetHeader::CS_NONE)
+        {
+            hdr.set_crc32(crc32(net_.checksum_, *i, NetHeader::serial_size_),
+                          net_.checksum_);
+        }
+
+        serialize(hdr, i->header(), i->header_size(), i->header_offset());
+
+        write_bufs_.push_back(asio::const_buffer(i->header()
+                                                 + i->header_offset(),
+                                                 i->header_len()));
+        write_bufs_.push_back(asio::const_buffer(i->payload().data(),
+                                                 i->payload().size()));
+    }
+
+    if (ktls_tx_ == true)
+    {
+        // Kernel seals the gathered buffers into full size records.
+        async_write(ssl_socket_->next_layer(), write_bufs_,
+                    strand_.wrap(
+                        boost::bind(&AsioTcpSocket::write_handler,
+                                    shared_from_this(),
+                                    asio::placeholders::error,
+                                    asio::placeholders::bytes_transferred)));
+    }
+    else if (ssl_socket_ != 0)
+    {
+        // SSL stream seals one buffer of a sequence at a time, which
+        // would produce a separate record for every header and payload.
+        // Copy the batch into a single buffer to have it encrypted in
+        // full size records.
+        ssl_write_buf_.resize(asio::buffer_size(write_bufs_));
+        asio::buffer_copy(asio::buffer(ssl_write_buf_), write_bufs_);
+        async_write(*ssl_socket_, asio::buffer(ssl_write_buf_),
+                    strand_.wrap(
+                        boost::bind(&AsioTcpSocket::write_handler,
+                                    shared_from_this(),
+                                    asio::placeholders::error,
+                                    asio::placeholders::bytes_transferred)));
     }
     else
     {
-        async_write(socket_, cbs,
-                    boost::bind(&AsioTcpSocket::write_handler,
-                                shared_from_this(),
-                                asio::placeholders::error,
-                                asio::placeholders::bytes_transferred));
+        async_write(socket_, write_bufs_,
+                    strand_.wrap(
+                        boost::bind(&AsioTcpSocket::write_handler,
+                                    shared_from_this(),
+                                    asio::placeholders::error,
+                                    asio::placeholders::bytes_transferred)));
     }
 }
 
@@ -803,8 +925,13 @@ gcomm::SocketStats gcomm::AsioTcpSocket::stats() const
         Critical<AsioProtonet> crit(net_);
         ret.last_queued_since = (now - last_queued_tstamp_).get_nsecs();
         ret.last_delivered_since = (now - last_delivered_tstamp_).get_nsecs();
-        ret.send_queue_length = send_q_.size();
+        ret.send_queue_length = send_q_.size() + write_q_.size();
         ret.send_queue_bytes = send_q_.queued_bytes();
+        for (std::vector<Datagram>::const_iterator i(write_q_.begin());
+             i != write_q_.end(); ++i)
+        {
+            ret.send_queue_bytes += i->len();
+        }
         ret.send_queue_segments = send_q_.segments();
     }
 #endif /* __linux__ || __FreeBSD__ */
@@ -831,6 +958,8 @@ void gcomm::AsioTcpAcceptor::accept_handler(
     SocketPtr socket,
     const asio::error_code& error)
 {
+    Critical<AsioProtonet> crit(net_);
+
     if (!error)
     {
         AsioTcpSocket* s(static_cast<AsioTcpSocket*>(socket.get()));
@@ -847,9 +976,10 @@ void gcomm::AsioTcpAcceptor::accept_handler(
                           << s->local_addr();
                 s->ssl_socket_->async_handshake(
                     asio::ssl::stream<asio::ip::tcp::socket>::server,
-                    boost::bind(&AsioTcpSocket::handshake_handler,
-                                s->shared_from_this(),
-                                asio::placeholders::error));
+                    s->strand_.wrap(
+                        boost::bind(&AsioTcpSocket::handshake_handler,
+                                    s->shared_from_this(),
+                                    asio::placeholders::error)));
                 s->state_ = Socket::S_CONNECTING;
             }
             else
@@ -965,7 +1095,18 @@ gcomm::SocketPtr gcomm::AsioTcpAcceptor::accept()
 {
     if (accepted_socket_->state() == Socket::S_CONNECTED)
     {
-        accepted_socket_->async_receive();
+        AsioTcpSocket* s(static_cast<AsioTcpSocket*>(accepted_socket_.get()));
+        if (net_.io_threads_ > 1)
+        {
+            // Other socket handlers run in the socket strand, start
+            // receiving from there too.
+            s->strand_.post(boost::bind(&AsioTcpSocket::start_receive,
+                                        s->shared_from_this()));
+        }
+        else
+        {
+            s->async_receive();
+        }
     }
     return accepted_socket_;
 }
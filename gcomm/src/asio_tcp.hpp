@@ -8,6 +8,7 @@
 #include "socket.hpp"
 #include "asio_protonet.hpp"
 #include "fair_send_queue.hpp"
+#include "buffer_pool.hpp"
 
 #include "gu_array.hpp"
 #include "gu_shared_ptr.hpp"
@@ -86,8 +87,17 @@ private:
         last_queued_tstamp_ = last_delivered_tstamp_ = now;
     }
     void read_one(gu::array<asio::mutable_buffer, 1>::type& mbs);
-    void write_one(const gu::array<asio::const_buffer, 2>::type& cbs);
+    // Move a batch of datagrams from send_q_ to write_q_,
+    // must be called in the critical section.
+    void take_write_batch();
+    // Serialize headers of datagrams in write_q_ and write them with
+    // a single scatter-gather write. Called from the socket strand
+    // outside of the critical section.
+    void write_batch();
     void close_socket();
+    // Start receiving unless the socket has been closed meanwhile,
+    // posted to the socket strand.
+    void start_receive();
 
     // call to assign local/remote addresses at the point where it
     // is known that underlying socket is live
@@ -104,6 +114,9 @@ private:
     AsioProtonet&                             net_;
     asio::ip::tcp::socket                     socket_;
     asio::ssl::stream<asio::ip::tcp::socket>* ssl_socket_;
+    // Serializes handlers of this socket when the protonet runs
+    // several I/O threads.
+    asio::io_service::strand                  strand_;
     // Limit the number of queued bytes. This workaround to avoid queue
     // pile up due to frequent retransmissions by the upper layers (evs).
     // It is a responsibility of upper layers (evs) to request resending
@@ -111,9 +124,25 @@ private:
     // datagrams with default gcomm MTU 32kB.
     static const size_t                       max_send_q_bytes = (1 << 25);
     gcomm::FairSendQueue                      send_q_;
+    // Datagrams of the write in progress, taken out of send_q_ in the order
+    // given by its segment round robin. Batch size is limited both in
+    // number of datagrams (each takes two iovecs, keep well below IOV_MAX)
+    // and in bytes in order not to delay the other segments.
+    static const size_t                       max_write_batch_len = 64;
+    static const size_t                       max_write_batch_bytes = (1 << 18);
+    std::vector<gcomm::Datagram>              write_q_;
+    std::vector<asio::const_buffer>           write_bufs_;
+    std::vector<gu::byte_t>                   ssl_write_buf_;
+    // Sent data is encrypted by kernel TLS, write in plain to the
+    // underlying socket of ssl_socket_.
+    bool                                      ktls_tx_;
     gu::datetime::Date                        last_queued_tstamp_;
     std::vector<gu::byte_t>                   recv_buf_;
     size_t                                    recv_offset_;
+    // Payload buffers of delivered datagrams, reused once released by
+    // the upper layers. Accessed only from the socket strand.
+    static const size_t                       max_recv_pool_buffers = 64;
+    gcomm::BufferPool                         recv_pool_;
     gu::datetime::Date                        last_delivered_tstamp_;
     State                                     state_;
     // Querying addresses from failed socket does not work,
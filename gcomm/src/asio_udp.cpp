@@ -3,9 +3,11 @@
  */
 
 #include "asio_udp.hpp"
+#include "asio_tcp.hpp" // GCOMM_ASIO_AUTO_BUF_SIZE
 
 #include "gcomm/util.hpp"
 #include "gcomm/common.hpp"
+#include "gcomm/conf.hpp"
 
 #include "gu_array.hpp"
 
@@ -60,7 +62,7 @@ gcomm::AsioUdpSocket::AsioUdpSocket(AsioProtonet& net, const gu::URI& uri)
     socket_(net_.io_service_),
     target_ep_(),
     source_ep_(),
-    recv_buf_((1 << 15) + NetHeader::serial_size_)
+    recv_buf_(net_.mtu() + NetHeader::serial_size_)
 { }
 
 
@@ -89,6 +91,16 @@ void gcomm::AsioUdpSocket::connect(const gu::URI& uri)
     asio::ip::udp::socket::non_blocking_io cmd(true);
     socket_.io_control(cmd);
 
+    // Multicast traffic arrives in bursts from all the senders and
+    // there is no flow control to save datagrams overflowing the
+    // receive buffer.
+    if (net_.conf().get(Conf::SocketRecvBufSize) != GCOMM_ASIO_AUTO_BUF_SIZE)
+    {
+        socket_.set_option(
+            asio::socket_base::receive_buffer_size(
+                net_.conf().get<size_t>(Conf::SocketRecvBufSize)));
+    }
+
     const asio::ip::address local_if(
         gu::make_address(
             uri.get_option("socket.if_addr",
@@ -166,7 +178,13 @@ void gcomm::AsioUdpSocket::read_handler(const asio::error_code& ec,
 {
     if (ec)
     {
-        //
+        if (ec == asio::error::operation_aborted || state() == S_CLOSED)
+        {
+            return;
+        }
+        // Errors on datagram socket are transient, keep receiving.
+        log_debug << "udp read failed: " << ec.message();
+        async_receive();
         return;
     }
 
@@ -196,7 +214,7 @@ void gcomm::AsioUdpSocket::read_handler(const asio::error_code& ec,
                     new gu::Buffer(&recv_buf_[0] + NetHeader::serial_size_,
                                    &recv_buf_[0] + NetHeader::serial_size_
                                    + hdr.len())));
-            if (net_.checksum_ == true && check_cs(hdr, dg))
+            if (net_.checksum_ != NetHeader::CS_NONE && check_cs(hdr, dg))
             {
                 log_warn << "checksum failed, hdr: len=" << hdr.len()
                          << " has_crc32="  << hdr.has_crc32()
@@ -231,7 +249,7 @@ void gcomm::AsioUdpSocket::async_receive()
 
 size_t gcomm::AsioUdpSocket::mtu() const
 {
-    return (1 << 15);
+    return net_.mtu();
 }
 
 std::string gcomm::AsioUdpSocket::local_addr() const
@@ -243,7 +261,8 @@ std::string gcomm::AsioUdpSocket::local_addr() const
 
 std::string gcomm::AsioUdpSocket::remote_addr() const
 {
+    // Socket is not connected, report the address datagrams are sent to
     return uri_string(gu::scheme::udp,
-                      gu::escape_addr(socket_.remote_endpoint().address()),
-                      gu::to_string(socket_.remote_endpoint().port()));
+                      gu::escape_addr(target_ep_.address()),
+                      gu::to_string(target_ep_.port()));
 }
@@ -0,0 +1,83 @@
+//
+// Copyright (C) 2021 Codership Oy <info@codership.com>
+//
+
+/**
+ * Pool of reusable shared receive buffers.
+ *
+ * Every received message is delivered up the stack in a Datagram which
+ * owns the payload through a gu::SharedBuffer. Allocating a new buffer
+ * for each message costs two heap allocations (buffer object and its
+ * storage) plus the shared pointer control block. BufferPool keeps
+ * a fixed number of shared buffers and hands out a buffer again once
+ * the pool holds the only reference to it, that is, after the last
+ * Datagram referring to the buffer has been destroyed. Reused buffers
+ * keep their capacity, so in steady state no memory is allocated.
+ *
+ * The pool itself is not thread safe, but the buffers handed out may be
+ * released in any thread.
+ */
+
+#ifndef GCOMM_BUFFER_POOL_HPP
+#define GCOMM_BUFFER_POOL_HPP
+
+#include "gu_buffer.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace gcomm
+{
+    class BufferPool
+    {
+    public:
+        explicit BufferPool(size_t max_buffers)
+            : buffers_()
+            , next_(0)
+            , max_buffers_(max_buffers)
+        {
+            buffers_.reserve(max_buffers_);
+        }
+
+        /* Return shared buffer containing copy of [first, last). */
+        gu::SharedBuffer acquire(const gu::byte_t* first,
+                                 const gu::byte_t* last)
+        {
+            for (size_t i(0); i < buffers_.size(); ++i)
+            {
+                gu::SharedBuffer& buf(buffers_[next_]);
+                next_ = (next_ + 1) % buffers_.size();
+                if (buf.use_count() == 1)
+                {
+                    // Make sure that all accesses to the buffer by the
+                    // thread which dropped the last outside reference
+                    // are complete before the buffer is overwritten.
+                    __sync_synchronize();
+                    buf->resize(last - first);
+                    std::copy(first, last, buf->begin());
+                    return buf;
+                }
+            }
+
+            gu::SharedBuffer ret(new gu::Buffer(first, last));
+            if (buffers_.size() < max_buffers_)
+            {
+                buffers_.push_back(ret);
+            }
+            return ret;
+        }
+
+        /* Number of buffers owned by the pool. */
+        size_t size() const { return buffers_.size(); }
+
+    private:
+        BufferPool(const BufferPool&);
+        void operator=(const BufferPool&);
+
+        std::vector<gu::SharedBuffer> buffers_;
+        size_t                        next_;
+        size_t                        max_buffers_;
+    };
+}
+
+#endif // GCOMM_BUFFER_POOL_HPP
@@ -24,6 +24,8 @@ std::string const gcomm::Conf::SocketRecvBufSize =
     SocketPrefix + "recv_buf_size";
 std::string const gcomm::Conf::SocketSendBufSize =
     SocketPrefix + "send_buf_size";
+std::string const gcomm::Conf::SocketIoThreads =
+    SocketPrefix + "io_threads";
 
 // GMCast
 std::string const gcomm::Conf::GMCastScheme = "gmcast";
@@ -40,6 +42,8 @@ std::string const gcomm::Conf::GMCastMCastPort =
     GMCastPrefix + "mcast_port";
 std::string const gcomm::Conf::GMCastMCastTTL =
     GMCastPrefix + "mcast_ttl";
+std::string const gcomm::Conf::GMCastMCastMtu =
+    GMCastPrefix + "mcast_mtu";
 std::string const gcomm::Conf::GMCastTimeWait =
     GMCastPrefix + "time_wait";
 std::string const gcomm::Conf::GMCastPeerTimeout =
@@ -52,6 +56,8 @@ std::string const gcomm::Conf::GMCastIsolate =
     GMCastPrefix + "isolate";
 std::string const gcomm::Conf::GMCastSegment =
     GMCastPrefix + "segment";
+std::string const gcomm::Conf::GMCastSegmentFanout =
+    GMCastPrefix + "segment_fanout";
 
 // EVS
 std::string const gcomm::Conf::EvsScheme = "evs";
@@ -82,6 +88,8 @@ std::string const gcomm::Conf::EvsSendWindow =
     EvsPrefix + "send_window";
 std::string const gcomm::Conf::EvsUserSendWindow =
     EvsPrefix + "user_send_window";
+std::string const gcomm::Conf::EvsAdaptiveWindow =
+    EvsPrefix + "adaptive_window";
 std::string const gcomm::Conf::EvsUseAggregate =
     EvsPrefix + "use_aggregate";
 std::string const gcomm::Conf::EvsCausalKeepalivePeriod =
@@ -132,6 +140,7 @@ gcomm::Conf::register_params(gu::Config& cnf)
     GCOMM_CONF_ADD_DEFAULT(SocketChecksum);
     GCOMM_CONF_ADD_DEFAULT(SocketRecvBufSize);
     GCOMM_CONF_ADD_DEFAULT(SocketSendBufSize);
+    GCOMM_CONF_ADD_DEFAULT(SocketIoThreads);
 
     GCOMM_CONF_ADD_DEFAULT(GMCastVersion);
     GCOMM_CONF_ADD        (GMCastGroup);
@@ -139,6 +148,7 @@ gcomm::Conf::register_params(gu::Config& cnf)
     GCOMM_CONF_ADD        (GMCastMCastAddr);
     GCOMM_CONF_ADD        (GMCastMCastPort);
     GCOMM_CONF_ADD        (GMCastMCastTTL);
+    GCOMM_CONF_ADD        (GMCastMCastMtu);
     GCOMM_CONF_ADD        (GMCastMCastAddr);
     GCOMM_CONF_ADD        (GMCastTimeWait);
     GCOMM_CONF_ADD        (GMCastPeerTimeout);
@@ -146,6 +156,7 @@ gcomm::Conf::register_params(gu::Config& cnf)
     GCOMM_CONF_ADD        (GMCastPeerAddr);
     GCOMM_CONF_ADD        (GMCastIsolate);
     GCOMM_CONF_ADD_DEFAULT(GMCastSegment);
+    GCOMM_CONF_ADD_DEFAULT(GMCastSegmentFanout);
 
     GCOMM_CONF_ADD        (EvsVersion);
     GCOMM_CONF_ADD_DEFAULT(EvsViewForgetTimeout);
@@ -160,6 +171,7 @@ gcomm::Conf::register_params(gu::Config& cnf)
     GCOMM_CONF_ADD        (EvsInfoLogMask);
     GCOMM_CONF_ADD_DEFAULT(EvsSendWindow);
     GCOMM_CONF_ADD_DEFAULT(EvsUserSendWindow);
+    GCOMM_CONF_ADD_DEFAULT(EvsAdaptiveWindow);
     GCOMM_CONF_ADD        (EvsUseAggregate);
     GCOMM_CONF_ADD        (EvsCausalKeepalivePeriod);
     GCOMM_CONF_ADD_DEFAULT(EvsMaxInstallTimeouts);
@@ -21,9 +21,12 @@ namespace gcomm
         GCOMM_ASIO_AUTO_BUF_SIZE;
     std::string const Defaults::SocketSendBufSize       =
         GCOMM_ASIO_AUTO_BUF_SIZE;
+    std::string const Defaults::SocketIoThreads         = "1";
     std::string const Defaults::GMCastVersion           = "0";
     std::string const Defaults::GMCastTcpPort           = BASE_PORT_DEFAULT;
+    std::string const Defaults::GMCastMCastMtu          = "32768";
     std::string const Defaults::GMCastSegment           = "0";
+    std::string const Defaults::GMCastSegmentFanout     = "0";
     std::string const Defaults::GMCastTimeWait          = "PT5S";
     std::string const Defaults::GMCastPeerTimeout       = "PT3S";
     std::string const Defaults::EvsViewForgetTimeout    = "PT24H";
@@ -42,6 +45,7 @@ namespace gcomm
     std::string const Defaults::EvsSendWindowMin        = "1";
     std::string const Defaults::EvsUserSendWindow       = "2";
     std::string const Defaults::EvsUserSendWindowMin    = "1";
+    std::string const Defaults::EvsAdaptiveWindow       = "false";
     std::string const Defaults::EvsMaxInstallTimeouts   = "3";
     std::string const Defaults::EvsDelayMargin          = "PT1S";
     std::string const Defaults::EvsDelayedKeepPeriod    = "PT30S";
@@ -16,9 +16,12 @@ namespace gcomm
         static std::string const SocketChecksum           ;
         static std::string const SocketRecvBufSize        ;
         static std::string const SocketSendBufSize        ;
+        static std::string const SocketIoThreads          ;
         static std::string const GMCastVersion            ;
         static std::string const GMCastTcpPort            ;
+        static std::string const GMCastMCastMtu           ;
         static std::string const GMCastSegment            ;
+        static std::string const GMCastSegmentFanout      ;
         static std::string const GMCastTimeWait           ;
         static std::string const GMCastPeerTimeout        ;
         static std::string const EvsViewForgetTimeout     ;
@@ -37,6 +40,7 @@ namespace gcomm
         static std::string const EvsSendWindowMin         ;
         static std::string const EvsUserSendWindow        ;
         static std::string const EvsUserSendWindowMin     ;
+        static std::string const EvsAdaptiveWindow        ;
         static std::string const EvsMaxInstallTimeouts    ;
         static std::string const EvsDelayMargin           ;
         static std::string const EvsDelayedKeepPeriod     ;
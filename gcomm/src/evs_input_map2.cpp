@@ -10,6 +10,7 @@
 #include "gu_buffer.hpp"
 #include <stdexcept>
 #include <numeric>
+#include <algorithm>
 
 
 //////////////////////////////////////////////////////////////////////////
@@ -90,6 +91,18 @@ std::ostream& gcomm::evs::operator<<(std::ostream& os, const InputMapMsg& m)
 }
 
 
+std::ostream& gcomm::evs::operator<<(std::ostream& os,
+                                    const InputMapMsgIndex& mi)
+{
+    for (InputMapMsgIndex::iterator i(mi.begin()); i != mi.end(); ++i)
+    {
+        os << "\t" << InputMapMsgIndex::key(i) << ","
+           << InputMapMsgIndex::value(i) << "\n";
+    }
+    return os;
+}
+
+
 std::ostream& gcomm::evs::operator<<(std::ostream& os, const InputMap& im)
 {
     return (os << "evs::input_map: {"
@@ -106,6 +119,234 @@ std::ostream& gcomm::evs::operator<<(std::ostream& os, const InputMap& im)
 
 
 
+//////////////////////////////////////////////////////////////////////////
+//
+// InputMapMsgIndex
+//
+//////////////////////////////////////////////////////////////////////////
+
+
+gcomm::evs::InputMapMsgIndex::InputMapMsgIndex()
+    :
+    nodes_ (0),
+    mask_  (initial_window - 1),
+    slots_ (),
+    size_  (0),
+    lo_    (0),
+    hi_    (-1),
+    empty_ ()
+{ }
+
+
+void gcomm::evs::InputMapMsgIndex::reset(size_t const nodes)
+{
+    nodes_ = nodes;
+    mask_  = initial_window - 1;
+    slots_.clear();
+    slots_.resize(initial_window * nodes_);
+    size_  = 0;
+    lo_    = 0;
+    hi_    = -1;
+}
+
+
+gcomm::evs::InputMapMsgIndex::iterator
+gcomm::evs::InputMapMsgIndex::begin() const
+{
+    if (size_ == 0) return end();
+
+    // Messages are erased mostly from the head, so the scan is amortized
+    // by remembering where the first message was found.
+    for (; lo_ <= hi_; ++lo_)
+    {
+        for (size_t n(0); n < nodes_; ++n)
+        {
+            if (slot(lo_, n).seq_ == lo_) return iterator(this, lo_, n);
+        }
+    }
+
+    gu_throw_fatal << "message index size " << size_
+                   << " but no messages found";
+}
+
+
+void gcomm::evs::InputMapMsgIndex::next(iterator& i) const
+{
+    assert(i.index_ == this);
+    assert(i.seq_ != -1);
+
+    size_t n(i.node_ + 1);
+    for (seqno_t seq(i.seq_); seq <= hi_; ++seq, n = 0)
+    {
+        for (; n < nodes_; ++n)
+        {
+            if (slot(seq, n).seq_ == seq)
+            {
+                i.seq_  = seq;
+                i.node_ = n;
+                return;
+            }
+        }
+    }
+
+    i = end();
+}
+
+
+gcomm::evs::InputMapMsgIndex::iterator
+gcomm::evs::InputMapMsgIndex::find(const InputMapMsgKey& key) const
+{
+    if (key.seq() < lo_ || key.seq() > hi_ || key.index() >= nodes_ ||
+        slot(key.seq(), key.index()).seq_ != key.seq())
+    {
+        return end();
+    }
+    return iterator(this, key.seq(), key.index());
+}
+
+
+gcomm::evs::InputMapMsgIndex::iterator
+gcomm::evs::InputMapMsgIndex::find_checked(const InputMapMsgKey& key) const
+{
+    iterator ret(find(key));
+    if (ret == end())
+    {
+        gu_throw_fatal << "element " << key << " not found";
+    }
+    return ret;
+}
+
+
+void gcomm::evs::InputMapMsgIndex::insert_unique(const InputMapMsgKey& key,
+                                                 const InputMapMsg&    msg)
+{
+    if (key.index() >= nodes_)
+    {
+        gu_throw_fatal << "node index " << key.index()
+                       << " out of range, nodes " << nodes_;
+    }
+
+    fit(key.seq());
+
+    Slot& s(slot(key.seq(), key.index()));
+    if (s.seq_ == key.seq())
+    {
+        gu_throw_fatal << "duplicate entry "
+                       << "key=" << key << " "
+                       << "value=" << msg << " "
+                       << "map=" << *this;
+    }
+    assert(s.seq_ == -1);
+
+    s.seq_ = key.seq();
+    s.msg_ = msg;
+    ++size_;
+}
+
+
+void gcomm::evs::InputMapMsgIndex::erase(iterator i)
+{
+    assert(i.index_ == this);
+    Slot& s(slot(i.seq_, i.node_));
+    gcomm_assert(s.seq_ == i.seq_) << "erasing invalid iterator";
+    s.seq_ = -1;
+    s.msg_ = empty_;
+    --size_;
+}
+
+
+void gcomm::evs::InputMapMsgIndex::erase_up_to(seqno_t const seq)
+{
+    for (; size_ > 0 && lo_ <= std::min(seq, hi_); ++lo_)
+    {
+        for (size_t n(0); n < nodes_; ++n)
+        {
+            Slot& s(slot(lo_, n));
+            if (s.seq_ == lo_)
+            {
+                s.seq_ = -1;
+                s.msg_ = empty_;
+                --size_;
+            }
+        }
+    }
+}
+
+
+void gcomm::evs::InputMapMsgIndex::clear()
+{
+    for (size_t i(0); size_ > 0 && i < slots_.size(); ++i)
+    {
+        if (slots_[i].seq_ != -1)
+        {
+            slots_[i].seq_ = -1;
+            slots_[i].msg_ = empty_;
+            --size_;
+        }
+    }
+    assert(size_ == 0);
+    lo_ = 0;
+    hi_ = -1;
+}
+
+
+// Make the ring span seq in addition to the messages it already holds.
+void gcomm::evs::InputMapMsgIndex::fit(seqno_t const seq)
+{
+    if (size_ == 0)
+    {
+        lo_ = hi_ = seq;
+        return;
+    }
+
+    if (seq >= lo_ && seq <= hi_) return;
+
+    seqno_t lo(std::min(lo_, seq));
+    seqno_t hi(std::max(hi_, seq));
+
+    if (hi - lo > mask_)
+    {
+        // Bounds may be loose after erasures, tighten before growing.
+        lo_ = begin().seq_;
+        while (hi_ > lo_)
+        {
+            size_t n(0);
+            while (n < nodes_ && slot(hi_, n).seq_ != hi_) ++n;
+            if (n < nodes_) break;
+            --hi_;
+        }
+        lo = std::min(lo_, seq);
+        hi = std::max(hi_, seq);
+    }
+
+    if (hi - lo > mask_)
+    {
+        seqno_t window((mask_ + 1) * 2);
+        while (hi - lo >= window) window *= 2;
+
+        std::vector<Slot> slots(static_cast<size_t>(window) * nodes_);
+        seqno_t const mask(window - 1);
+        for (seqno_t s(lo_); s <= hi_; ++s)
+        {
+            for (size_t n(0); n < nodes_; ++n)
+            {
+                const Slot& from(slot(s, n));
+                if (from.seq_ == s)
+                {
+                    slots[static_cast<size_t>(s & mask) * nodes_ + n] = from;
+                }
+            }
+        }
+        slots_.swap(slots);
+        mask_ = mask;
+    }
+
+    lo_ = lo;
+    hi_ = hi;
+}
+
+
+
 //////////////////////////////////////////////////////////////////////////
 //
 // Constructors/destructors
@@ -144,6 +385,8 @@ void gcomm::evs::InputMap::reset(const size_t nodes)
     gcomm_assert(msg_index_->empty()                           == true &&
                  recovery_index_->empty()                      == true);
     node_index_->clear();
+    msg_index_->reset(nodes);
+    recovery_index_->reset(nodes);
 
     log_debug << " size " << node_index_->size();
     gu_trace(node_index_->resize(nodes, InputMapNode()));
@@ -286,19 +529,18 @@ gcomm::evs::InputMap::insert(const size_t uuid,
             Datagram ins_dg(s == msg.seq() ?
                                 Datagram(rb)   :
                                 Datagram());
-            gu_trace((void)msg_index_->insert_unique(
-                         std::make_pair(
-                             InputMapMsgKey(node.index(), s),
-                             InputMapMsg(
-                                 (s == msg.seq() ?
-                                  msg :
-                                  UserMessage(msg.version(),
-                                              msg.source(),
-                                              msg.source_view_id(),
-                                              s,
-                                              msg.aru_seq(),
-                                              0,
-                                              O_DROP)), ins_dg))));
+            gu_trace(msg_index_->insert_unique(
+                         InputMapMsgKey(node.index(), s),
+                         InputMapMsg(
+                             (s == msg.seq() ?
+                              msg :
+                              UserMessage(msg.version(),
+                                          msg.source(),
+                                          msg.source_view_id(),
+                                          s,
+                                          msg.aru_seq(),
+                                          0,
+                                          O_DROP)), ins_dg)));
         }
 
         // Update highest seen
@@ -333,7 +575,8 @@ gcomm::evs::InputMap::insert(const size_t uuid,
 
 void gcomm::evs::InputMap::erase(iterator i)
 {
-    gu_trace(recovery_index_->insert_unique(*i));
+    gu_trace(recovery_index_->insert_unique(InputMapMsgIndex::key(i),
+                                            InputMapMsgIndex::value(i)));
     gu_trace(msg_index_->erase(i));
 }
 
@@ -425,7 +668,5 @@ inline void gcomm::evs::InputMap::update_aru()
 void gcomm::evs::InputMap::cleanup_recovery_index()
 {
     gcomm_assert(node_index_->size() > 0);
-    InputMapMsgIndex::iterator i = recovery_index_->lower_bound(
-        InputMapMsgKey(0, safe_seq_ + 1));
-    recovery_index_->erase(recovery_index_->begin(), i);
+    recovery_index_->erase_up_to(safe_seq_);
 }
@@ -20,7 +20,6 @@
 #define EVS_INPUT_MAP2_HPP
 
 #include "evs_message2.hpp"
-#include "gcomm/map.hpp"
 #include "gcomm/datagram.hpp"
 
 #include <vector>
@@ -36,6 +35,7 @@ namespace gcomm
         class InputMapMsg;
         std::ostream& operator<<(std::ostream&, const InputMapMsg&);
         class InputMapMsgIndex;
+        std::ostream& operator<<(std::ostream&, const InputMapMsgIndex&);
         class InputMapNode;
         std::ostream& operator<<(std::ostream&, const InputMapNode&);
         typedef std::vector<InputMapNode> InputMapNodeIndex;
@@ -73,6 +73,7 @@ private:
 class gcomm::evs::InputMapMsg
 {
 public:
+    InputMapMsg() : msg_(), rb_() { }
     InputMapMsg(const UserMessage&  msg,
                 const Datagram&     rb)
         :
@@ -85,38 +86,141 @@ public:
     const UserMessage&  msg () const { return msg_;  }
     const Datagram& rb  () const { return rb_;   }
 private:
-    void operator=(const InputMapMsg&);
-
-    UserMessage const msg_;
-    Datagram          rb_;
+    UserMessage msg_;
+    Datagram    rb_;
 };
 
 
-#if defined(GALERA_USE_BOOST_POOL_ALLOC)
+/*
+ * Index of messages keyed by (node index, seqno) and iterated in the order
+ * of seqno first, node index second. Seqnos in the index are dense within
+ * the send window, so messages are stored in a ring of window x nodes slots
+ * indexed by seqno modulo window, which gives O(1) insert, find and erase
+ * without allocation. The ring doubles if a message falls out of the span
+ * of seqnos it can hold.
+ *
+ * Iterators hold a position (seqno, node index) instead of a pointer into
+ * the ring, so they stay valid over insertion and erasure of other
+ * messages.
+ */
+class gcomm::evs::InputMapMsgIndex
+{
+public:
+
+    class iterator
+    {
+    public:
+        iterator() : index_(0), seq_(-1), node_(0) { }
+
+        iterator& operator++()
+        {
+            index_->next(*this);
+            return *this;
+        }
+
+        bool operator==(const iterator& cmp) const
+        {
+            return (seq_ == cmp.seq_ && node_ == cmp.node_ &&
+                    index_ == cmp.index_);
+        }
+
+        bool operator!=(const iterator& cmp) const
+        {
+            return !(*this == cmp);
+        }
+
+    private:
+        friend class InputMapMsgIndex;
+
+        iterator(const InputMapMsgIndex* index, seqno_t seq, size_t node)
+            :
+            index_(index),
+            seq_  (seq),
+            node_ (node)
+        { }
+
+        const InputMapMsgIndex* index_;
+        seqno_t                 seq_;   /* -1 for end() */
+        size_t                  node_;
+    };
+
+    typedef iterator const_iterator;
+
+    InputMapMsgIndex();
+
+    /*!
+     * Discard all messages and resize the ring for given number of nodes.
+     */
+    void reset(size_t nodes);
+
+    iterator begin() const;
+    iterator end()   const { return iterator(this, -1, 0); }
+
+    bool   empty() const { return (size_ == 0); }
+    size_t size()  const { return size_; }
+
+    iterator find        (const InputMapMsgKey& key) const;
+    iterator find_checked(const InputMapMsgKey& key) const;
+
+    /*!
+     * @throws FatalException if the key is already in the index or the
+     *         node index is out of range
+     */
+    void insert_unique(const InputMapMsgKey& key, const InputMapMsg& msg);
+
+    void erase(iterator i);
+
+    /*!
+     * Erase all messages with seqno lower than or equal to seq.
+     */
+    void erase_up_to(seqno_t seq);
+
+    void clear();
+
+    static InputMapMsgKey key(iterator i)
+    {
+        return InputMapMsgKey(i.node_, i.seq_);
+    }
+
+    static const InputMapMsg& value(iterator i)
+    {
+        return i.index_->slot(i.seq_, i.node_).msg_;
+    }
+
+private:
+
+    class Slot
+    {
+    public:
+        Slot() : seq_(-1), msg_() { }
 
-#include <boost/pool/pool_alloc.hpp>
+        seqno_t     seq_; /* -1 if the slot is free */
+        InputMapMsg msg_;
+    };
 
-class gcomm::evs::InputMapMsgIndex :
-    public Map<InputMapMsgKey, InputMapMsg,
-               std::map<InputMapMsgKey,
-                        InputMapMsg,
-                        std::less<InputMapMsgKey>,
-                        boost::fast_pool_allocator<
-                            std::pair<const InputMapMsgKey, InputMapMsg>,
-                            boost::default_user_allocator_new_delete,
-                            boost::details::pool::null_mutex
-                            >
-                        >
-               >
-{};
+    static size_t const initial_window = 16;
 
-#else /* GALERA_USE_BOOST_POOL_ALLOC */
+    const Slot& slot(seqno_t seq, size_t node) const
+    {
+        return slots_[static_cast<size_t>(seq & mask_) * nodes_ + node];
+    }
+
+    Slot& slot(seqno_t seq, size_t node)
+    {
+        return slots_[static_cast<size_t>(seq & mask_) * nodes_ + node];
+    }
 
-class gcomm::evs::InputMapMsgIndex :
-    public Map<InputMapMsgKey, InputMapMsg>
-{};
+    void next(iterator& i) const;
+    void fit(seqno_t seq);
 
-#endif /* GALERA_USE_BOOST_POOL_ALLOC */
+    size_t            nodes_;
+    seqno_t           mask_;  /* window - 1 */
+    std::vector<Slot> slots_;
+    size_t            size_;
+    mutable seqno_t   lo_;    /* no messages below lo_ */
+    seqno_t           hi_;    /* no messages above hi_ */
+    InputMapMsg const empty_; /* to release slot contents on erase */
+};
 
 /* Internal node representation */
 class gcomm::evs::InputMapNode
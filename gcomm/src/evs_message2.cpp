@@ -43,6 +43,12 @@ gcomm::evs::operator<<(std::ostream& os, const gcomm::evs::Message& msg)
     os << "ru=" << msg.range_uuid() << ",";
     os << "r=" << msg.range() << ",";
     os << "fs=" << msg.fifo_seq() << ",";
+    if (msg.type() == gcomm::evs::Message::EVS_T_GAP &&
+        (msg.flags() & gcomm::evs::Message::F_SACK))
+    {
+        os << "sack=" << static_cast<const gcomm::evs::GapMessage&>(msg)
+            .sack().size() << ",";
+    }
     os << "nl=(\n" << msg.node_list() << ")\n";
     os << "}";
     return os;
@@ -114,7 +120,8 @@ bool gcomm::evs::Message::operator==(const Message& cmp) const
             install_view_id_ == cmp.install_view_id_ &&
             range_uuid_      == cmp.range_uuid_      &&
             range_           == cmp.range_           &&
-            node_list_       == cmp.node_list_);
+            node_list_       == cmp.node_list_       &&
+            sack_            == cmp.sack_);
 }
 
 //
@@ -366,6 +373,16 @@ size_t gcomm::evs::GapMessage::serialize(gu::byte_t* const buf,
     gu_trace(offset = gu::serialize8(aru_seq_, buf, buflen, offset));
     gu_trace(offset = range_uuid_.serialize(buf, buflen, offset));
     gu_trace(offset = range_.serialize(buf, buflen, offset));
+    if (flags_ & F_SACK)
+    {
+        gu_trace(offset = gu::serialize1(static_cast<uint8_t>(sack_.size()),
+                                         buf, buflen, offset));
+        for (SackBitmap::const_iterator i(sack_.begin()); i != sack_.end();
+             ++i)
+        {
+            gu_trace(offset = gu::serialize1(*i, buf, buflen, offset));
+        }
+    }
     return offset;
 }
 
@@ -382,6 +399,17 @@ size_t gcomm::evs::GapMessage::unserialize(const gu::byte_t* const buf,
     gu_trace(offset = gu::unserialize8(buf, buflen, offset, aru_seq_));
     gu_trace(offset = range_uuid_.unserialize(buf, buflen, offset));
     gu_trace(offset = range_.unserialize(buf, buflen, offset));
+    sack_.clear();
+    if (flags_ & F_SACK)
+    {
+        uint8_t sack_sz(0);
+        gu_trace(offset = gu::unserialize1(buf, buflen, offset, sack_sz));
+        sack_.resize(sack_sz);
+        for (uint8_t i(0); i < sack_sz; ++i)
+        {
+            gu_trace(offset = gu::unserialize1(buf, buflen, offset, sack_[i]));
+        }
+    }
     return offset;
 }
 
@@ -390,7 +418,8 @@ size_t gcomm::evs::GapMessage::serial_size() const
     return (Message::serial_size()
             + 2 * sizeof(seqno_t)
             + UUID::serial_size()
-            + Range::serial_size());
+            + Range::serial_size()
+            + ((flags_ & F_SACK) ? 1 + sack_.size() : 0));
 }
 
 size_t gcomm::evs::JoinMessage::serialize(gu::byte_t* const buf,
@@ -154,6 +154,18 @@ public:
     static const uint8_t F_AGGREGATE= 0x8; /*!< Message contains aggregated payload */
     static const uint8_t F_COMMIT   = 0x10;
     static const uint8_t F_BC       = 0x20;/*!< Message was sent in backward compatibility mode */
+    static const uint8_t F_SACK     = 0x40;/*!< Gap message carries selective ack bitmap */
+
+    /*!
+     * Selective ack bitmap of gap message. Bit i (LSB first) set means
+     * that the message with seqno range().lu() + i is requested.
+     */
+    typedef std::vector<uint8_t> SackBitmap;
+
+    /*!
+     * Maximum number of seqnos covered by selective ack bitmap.
+     */
+    static const seqno_t max_sack_span = 1024;
     /*!
      * Get version of the message
      *
@@ -313,7 +325,8 @@ public:
         range_           (msg.range_),
         tstamp_          (msg.tstamp_),
         node_list_       (msg.node_list_),
-        delayed_list_    (msg.delayed_list_)
+        delayed_list_    (msg.delayed_list_),
+        sack_            (msg.sack_)
     { }
 
     Message& operator=(const Message& msg)
@@ -335,6 +348,7 @@ public:
         tstamp_          = msg.tstamp_;
         node_list_       = msg.node_list_;
         delayed_list_    = msg.delayed_list_;
+        sack_            = msg.sack_;
         return *this;
     }
 
@@ -373,7 +387,8 @@ public:
         range_           (range),
         tstamp_          (gu::datetime::Date::monotonic()),
         node_list_       (node_list),
-        delayed_list_    ()
+        delayed_list_    (),
+        sack_            ()
     { }
 
 protected:
@@ -405,6 +420,7 @@ protected:
     gu::datetime::Date tstamp_;
     MessageNodeList    node_list_;
     DelayedList        delayed_list_;
+    SackBitmap         sack_;
 };
 
 /*!
@@ -491,7 +507,8 @@ public:
     DelegateMessage(const int     version   = -1,
                     const UUID&   source         = UUID::nil(),
                     const ViewId& source_view_id = ViewId(),
-                    const int64_t fifo_seq       = -1) :
+                    const int64_t fifo_seq       = -1,
+                    const uint8_t flags          = 0) :
         Message(version,
                 EVS_T_DELEGATE,
                 source,
@@ -499,7 +516,11 @@ public:
                 ViewId(),
                 0xff,
                 O_UNRELIABLE,
-                fifo_seq)
+                fifo_seq,
+                -1,
+                -1,
+                -1,
+                flags)
     { }
     size_t serialize(gu::byte_t* buf, size_t buflen, size_t offset) const;
     size_t unserialize(const gu::byte_t* buf, size_t buflen, size_t offset,
@@ -534,6 +555,34 @@ public:
                 range_uuid,
                 range)
     { }
+
+    /*!
+     * Set selective ack bitmap for retransmission request. The bitmap
+     * must not cover more than max_sack_span seqnos.
+     */
+    void set_sack(const SackBitmap& sack)
+    {
+        gcomm_assert(seqno_t(sack.size()) * 8 <= max_sack_span);
+        sack_ = sack;
+        flags_ |= F_SACK;
+    }
+
+    const SackBitmap& sack() const { return sack_; }
+
+    /*!
+     * Check whether message with given seqno is requested for
+     * retransmission. Without selective ack bitmap all seqnos in
+     * range() are requested.
+     */
+    bool is_requested(const seqno_t seq) const
+    {
+        if (seq < range_.lu() || seq > range_.hs()) return false;
+        if ((flags_ & F_SACK) == 0) return true;
+        const seqno_t i(seq - range_.lu());
+        return (i < seqno_t(sack_.size()) * 8 &&
+                (sack_[i/8] & (1 << (i % 8))) != 0);
+    }
+
     size_t serialize(gu::byte_t* buf, size_t buflen, size_t offset) const;
     size_t unserialize(const gu::byte_t* buf, size_t buflen, size_t offset,
                        bool skip_header = false);
@@ -167,6 +167,16 @@ gcomm::evs::Proto::Proto(gu::Config&    conf,
                                    Defaults::EvsUserSendWindow),
                     gu::from_string<seqno_t>(Defaults::EvsUserSendWindowMin),
                     send_window_ + 1)),
+    adaptive_window_(param<bool>(conf, uri, Conf::EvsAdaptiveWindow,
+                                 Defaults::EvsAdaptiveWindow)),
+    cur_send_window_(send_window_),
+    cur_user_send_window_(user_send_window_),
+    window_ssthresh_(send_window_),
+    window_round_seq_(-1),
+    window_round_start_(),
+    window_round_retrans_(0),
+    window_limited_(false),
+    window_min_rtt_(gu::datetime::Period::max()),
     bytes_since_request_user_msg_feedback_(),
     output_(),
     send_buf_(),
@@ -198,6 +208,7 @@ gcomm::evs::Proto::Proto(gu::Config&    conf,
              gu::to_string(causal_keepalive_period_));
     conf.set(Conf::EvsSendWindow, gu::to_string(send_window_));
     conf.set(Conf::EvsUserSendWindow, gu::to_string(user_send_window_));
+    conf.set(Conf::EvsAdaptiveWindow, gu::to_string(adaptive_window_));
     conf.set(Conf::EvsUseAggregate, gu::to_string(use_aggregate_));
     conf.set(Conf::EvsDebugLogMask, gu::to_string(debug_mask_, std::hex));
     conf.set(Conf::EvsInfoLogMask, gu::to_string(info_mask_, std::hex));
@@ -207,6 +218,14 @@ gcomm::evs::Proto::Proto(gu::Config&    conf,
     conf.set(Conf::EvsAutoEvict, gu::to_string(auto_evict_));
     //
 
+    if (adaptive_window_ == true)
+    {
+        // Start from default window and let it grow up to configured one
+        set_send_window(
+            std::min(send_window_,
+                     gu::from_string<seqno_t>(Defaults::EvsSendWindow)));
+    }
+
     known_.insert_unique(
         std::make_pair(my_uuid_, Node(*this)));
     self_i_ = known_.begin();
@@ -257,6 +276,9 @@ gcomm::evs::Proto::set_param(const std::string& key, const std::string& val,
                                    user_send_window_,
                                    std::numeric_limits<seqno_t>::max());
         conf_.set(Conf::EvsSendWindow, gu::to_string(send_window_));
+        set_send_window(adaptive_window_ == true ?
+                        std::min(cur_send_window_, send_window_) :
+                        send_window_);
         return true;
     }
     else if (key == gcomm::Conf::EvsUserSendWindow)
@@ -267,6 +289,21 @@ gcomm::evs::Proto::set_param(const std::string& key, const std::string& val,
             gu::from_string<seqno_t>(Defaults::EvsUserSendWindowMin),
             send_window_ + 1);
         conf_.set(Conf::EvsUserSendWindow, gu::to_string(user_send_window_));
+        set_send_window(adaptive_window_ == true ?
+                        cur_send_window_ : send_window_);
+        return true;
+    }
+    else if (key == gcomm::Conf::EvsAdaptiveWindow)
+    {
+        adaptive_window_ = gu::from_string<bool>(val);
+        conf_.set(Conf::EvsAdaptiveWindow, gu::to_string(adaptive_window_));
+        window_round_seq_ = -1;
+        window_ssthresh_ = send_window_;
+        set_send_window(adaptive_window_ == true ?
+                        std::min(send_window_,
+                                 gu::from_string<seqno_t>(
+                                     Defaults::EvsSendWindow)) :
+                        send_window_);
         return true;
     }
     else if (key == gcomm::Conf::EvsMaxInstallTimeouts)
@@ -462,6 +499,9 @@ void gcomm::evs::Proto::handle_get_status(gu::Status& status) const
         if (++i != evict_list().end()) evict_list_str += ",";
     }
     status.insert("evs_evict_list", evict_list_str);
+    status.insert("evs_send_window", gu::to_string(cur_send_window_));
+    status.insert("evs_user_send_window",
+                  gu::to_string(cur_user_send_window_));
 
     if (info_mask_ & I_STATISTICS)
     {
@@ -1469,6 +1509,7 @@ int gcomm::evs::Proto::send_user(Datagram& dg,
     if (win                       != -1   &&
         is_flow_control(seq, win) == true)
     {
+        window_limited_ = true;
         return EAGAIN;
     }
 
@@ -1554,6 +1595,15 @@ int gcomm::evs::Proto::send_user(Datagram& dg,
     gu_trace(pop_header(msg, dg));
     sent_msgs_[Message::EVS_T_USER]++;
 
+    if (adaptive_window_ == true && win != -1 && window_round_seq_ == -1)
+    {
+        // Start a new round, it completes when the message becomes safe
+        window_round_seq_     = last_sent_;
+        window_round_start_   = gu::datetime::Date::monotonic();
+        window_round_retrans_ = retrans_msgs_;
+        window_limited_       = false;
+    }
+
     if (delivering_ == false)
     {
         gu_trace(deliver());
@@ -1667,6 +1717,79 @@ void gcomm::evs::Proto::complete_user(const seqno_t high_seq)
 
 }
 
+void gcomm::evs::Proto::set_send_window(seqno_t const win)
+{
+    cur_send_window_ = win;
+    cur_user_send_window_ =
+        (win == send_window_ ? user_send_window_ :
+         std::max(seqno_t(1),
+                  std::min(user_send_window_,
+                           seqno_t(double(win) * user_send_window_ /
+                                   send_window_))));
+}
+
+//
+// Adaptive send window. Once per round trip of own messages the window
+// is adjusted similarly to TCP congestion control:
+// - If messages were retransmitted during the round, the window is halved
+//   (multiplicative decrease).
+// - If the round trip time has grown to twice the shortest seen and the
+//   increase is a noticeable fraction of delay margin, messages are
+//   queueing up on the way and safe delivery lags behind; the window is
+//   shrunk by quarter.
+// - Otherwise, if the window limited sending during the round, it is
+//   doubled below slow start threshold and incremented by one above it.
+//
+// The round is started by sending a user message and it completes when
+// the message has become safe, i.e. has been acknowledged by all members.
+//
+void gcomm::evs::Proto::adapt_send_window()
+{
+    if (adaptive_window_ == false ||
+        window_round_seq_ == -1 ||
+        input_map_->safe_seq() < window_round_seq_)
+    {
+        return;
+    }
+
+    const gu::datetime::Period rtt(gu::datetime::Date::monotonic() -
+                                   window_round_start_);
+    if (rtt < window_min_rtt_)
+    {
+        window_min_rtt_ = rtt;
+    }
+
+    const seqno_t min_win(gu::from_string<seqno_t>(Defaults::EvsSendWindowMin));
+    const long long queueing((rtt - window_min_rtt_).get_nsecs());
+    seqno_t win(cur_send_window_);
+
+    if (retrans_msgs_ > window_round_retrans_)
+    {
+        window_ssthresh_ = std::max(min_win, win/2);
+        win = window_ssthresh_;
+    }
+    else if (queueing > window_min_rtt_.get_nsecs() &&
+             queueing > delay_margin_.get_nsecs()/10)
+    {
+        win = std::max(min_win, win - win/4);
+        window_ssthresh_ = win;
+    }
+    else if (window_limited_ == true)
+    {
+        win = (win < window_ssthresh_ ? 2*win : win + 1);
+    }
+    win = std::min(win, send_window_);
+
+    if (win != cur_send_window_)
+    {
+        evs_log_debug(D_USER_MSGS) << "send window " << cur_send_window_
+                                   << " -> " << win << " rtt " << rtt
+                                   << " min rtt " << window_min_rtt_;
+        set_send_window(win);
+    }
+    window_round_seq_ = -1;
+}
+
 int gcomm::evs::Proto::send_delegate(Datagram& wb, const UUID& target)
 {
     DelegateMessage dm(version_, uuid(), current_view_.id(),
@@ -2060,7 +2183,21 @@ void gcomm::evs::Proto::send_delayed_list()
     handle_delayed_list(elm, self_i_);
 }
 
-void gcomm::evs::Proto::resend(const UUID& gap_source, const Range range)
+// Return true if any of the seqnos covered by msg is requested by gap
+// message.
+static bool is_requested(const gcomm::evs::GapMessage& gm,
+                         const gcomm::evs::UserMessage& msg)
+{
+    for (gcomm::evs::seqno_t seq(msg.seq());
+         seq <= msg.seq() + msg.seq_range(); ++seq)
+    {
+        if (gm.is_requested(seq) == true) return true;
+    }
+    return false;
+}
+
+void gcomm::evs::Proto::resend(const UUID& gap_source, const Range range,
+                               const GapMessage* const request)
 {
     gcomm_assert(gap_source != uuid());
     gcomm_assert(range.lu() <= range.hs()) <<
@@ -2085,6 +2222,10 @@ void gcomm::evs::Proto::resend(const UUID& gap_source, const Range range)
     // therefore it does not make sense to retransmit anything below that.
     seqno_t seq(std::max(range.lu(), input_map_->safe_seq() + 1));
     evs_log_debug(D_RETRANS) << "retransmitting from " << seq;
+    // Only nodes which are able to handle batched retransmissions
+    // send requests with selective ack bitmap.
+    const bool sack(request != 0 && (request->flags() & Message::F_SACK));
+    gu::Buffer batch;
     while (seq <= range.hs())
     {
         InputMap::iterator msg_i = input_map_->find(
@@ -2107,6 +2248,11 @@ void gcomm::evs::Proto::resend(const UUID& gap_source, const Range range)
 
         const UserMessage& msg(InputMapMsgIndex::value(msg_i).msg());
         gcomm_assert(msg.source() == uuid());
+        if (sack == true && is_requested(*request, msg) == false)
+        {
+            seq = seq + msg.seq_range() + 1;
+            continue;
+        }
         Datagram rb(InputMapMsgIndex::value(msg_i).rb());
         assert(rb.offset() == 0);
 
@@ -2125,7 +2271,16 @@ void gcomm::evs::Proto::resend(const UUID& gap_source, const Range range)
 
         push_header(um, rb);
 
-        int err = send_down(rb, ProtoDownMeta(gap_source));
+        int err;
+        if (sack == true &&
+            AggregateMessage().serial_size() + rb.len() <= retrans_batch_size())
+        {
+            err = batch_retrans(batch, rb, gap_source);
+        }
+        else if ((err = send_retrans_batch(batch, gap_source)) == 0)
+        {
+            err = send_down(rb, ProtoDownMeta(gap_source));
+        }
         if (err != 0)
         {
             log_debug << "send failed: " << strerror(err);
@@ -2138,12 +2293,19 @@ void gcomm::evs::Proto::resend(const UUID& gap_source, const Range range)
         seq = seq + msg.seq_range() + 1;
         retrans_msgs_++;
     }
+
+    int const err(send_retrans_batch(batch, gap_source));
+    if (err != 0)
+    {
+        log_debug << "send failed: " << strerror(err);
+    }
 }
 
 
 void gcomm::evs::Proto::recover(const UUID& gap_source,
                                 const UUID& range_uuid,
-                                const Range range)
+                                const Range range,
+                                const GapMessage* const request)
 {
     gcomm_assert(gap_source != uuid())
         << "gap_source (" << gap_source << ") == uuid() (" << uuid()
@@ -2173,6 +2335,8 @@ void gcomm::evs::Proto::recover(const UUID& gap_source,
     // therefore it does not make sense to retransmit anything below that.
     seqno_t seq(std::max(range.lu(), input_map_->safe_seq() + 1));
     evs_log_debug(D_RETRANS) << "recovering from " << seq;
+    const bool sack(request != 0 && (request->flags() & Message::F_SACK));
+    gu::Buffer batch;
     size_t n_recovered(0);
     while (seq <= range.hs() && seq <= im_range.hs())
     {
@@ -2192,6 +2356,11 @@ void gcomm::evs::Proto::recover(const UUID& gap_source,
 
         const UserMessage& msg(InputMapMsgIndex::value(msg_i).msg());
         assert(msg.source() == range_uuid);
+        if (sack == true && is_requested(*request, msg) == false)
+        {
+            seq = seq + msg.seq_range() + 1;
+            continue;
+        }
 
         Datagram rb(InputMapMsgIndex::value(msg_i).rb());
         assert(rb.offset() == 0);
@@ -2212,7 +2381,16 @@ void gcomm::evs::Proto::recover(const UUID& gap_source,
         push_header(um, rb);
 
         ++n_recovered;
-        int err = send_delegate(rb, gap_source);
+        int err;
+        if (sack == true &&
+            AggregateMessage().serial_size() + rb.len() <= retrans_batch_size())
+        {
+            err = batch_retrans(batch, rb, gap_source);
+        }
+        else if ((err = send_retrans_batch(batch, gap_source)) == 0)
+        {
+            err = send_delegate(rb, gap_source);
+        }
         if (err != 0)
         {
             log_debug << "send failed: " << strerror(err);
@@ -2225,10 +2403,71 @@ void gcomm::evs::Proto::recover(const UUID& gap_source,
         seq = seq + msg.seq_range() + 1;
         recovered_msgs_++;
     }
+
+    int const err(send_retrans_batch(batch, gap_source));
+    if (err != 0)
+    {
+        log_debug << "send failed: " << strerror(err);
+    }
     evs_log_debug(D_RETRANS) << "recovered: " << n_recovered;
 }
 
 
+//
+// Retransmission batch consists of retransmitted user messages with
+// headers, each prefixed by AggregateMessage header carrying the length.
+// The batch is sent as a payload of delegate message with F_AGGREGATE
+// flag set.
+//
+
+size_t gcomm::evs::Proto::retrans_batch_size() const
+{
+    const DelegateMessage dm(version_, uuid(), current_view_.id());
+    return (std::min(mtu(), size_t(std::numeric_limits<uint16_t>::max()))
+            - dm.serial_size());
+}
+
+int gcomm::evs::Proto::batch_retrans(gu::Buffer&     batch,
+                                     const Datagram& dg,
+                                     const UUID&     target)
+{
+    const AggregateMessage am(0, dg.len());
+    int err(0);
+    if (batch.size() + am.serial_size() + dg.len() > retrans_batch_size())
+    {
+        err = send_retrans_batch(batch, target);
+    }
+
+    size_t offset(batch.size());
+    batch.resize(offset + am.serial_size() + dg.len());
+    gu_trace(offset = am.serialize(&batch[0], batch.size(), offset));
+    std::copy(dg.header() + dg.header_offset(),
+              dg.header() + dg.header_size(),
+              &batch[0] + offset);
+    offset += dg.header_len();
+    std::copy(dg.payload().begin(), dg.payload().end(), &batch[0] + offset);
+    return err;
+}
+
+int gcomm::evs::Proto::send_retrans_batch(gu::Buffer& batch,
+                                          const UUID& target)
+{
+    if (batch.empty() == true)
+    {
+        return 0;
+    }
+
+    DelegateMessage dm(version_, uuid(), current_view_.id(), ++fifo_seq_,
+                       Message::F_AGGREGATE);
+    Datagram dg(gu::SharedBuffer(new gu::Buffer(batch.begin(), batch.end())));
+    batch.clear();
+    push_header(dm, dg);
+    int const ret(send_down(dg, ProtoDownMeta(target)));
+    sent_msgs_[Message::EVS_T_DELEGATE]++;
+    return ret;
+}
+
+
 void gcomm::evs::Proto::handle_foreign(const Message& msg)
 {
     // no need to handle foreign LEAVE message
@@ -2658,7 +2897,7 @@ int gcomm::evs::Proto::handle_down(Datagram& wb, const ProtoDownMeta& dm)
         err = send_user(wb,
                         dm.user_type(),
                         dm.order(),
-                        user_send_window_,
+                        cur_user_send_window_,
                         -1);
 
         switch (err)
@@ -2923,6 +3162,10 @@ void gcomm::evs::Proto::shift_to(const State s, const bool send_j)
 
         input_map_->reset(current_view_.members().size());
         last_sent_ = -1;
+        // Seqnos start over and round trip times may change with
+        // membership
+        window_round_seq_ = -1;
+        window_min_rtt_ = gu::datetime::Period::max();
         state_ = S_OPERATIONAL;
         deliver_reg_view(*install_message_, previous_view_);
 
@@ -3128,6 +3371,10 @@ void gcomm::evs::Proto::deliver()
     assert(input_map_->begin() == input_map_->end() ||
            input_map_->is_safe(input_map_->begin()) == false);
 
+    if (state() == S_OPERATIONAL)
+    {
+        adapt_send_window();
+    }
 }
 
 
@@ -3255,9 +3502,11 @@ gcomm::evs::seqno_t gcomm::evs::Proto::update_im_safe_seq(const size_t uuid,
     return im_safe_seq;
 }
 
-void gcomm::evs::Proto::send_request_retrans_gap(const UUID& target,
-                                                 const UUID& origin,
-                                                 const Range& range)
+void gcomm::evs::Proto::send_request_retrans_gap(
+    const UUID& target,
+    const UUID& origin,
+    const Range& range,
+    const Message::SackBitmap& sack)
 {
     GapMessage gm(version_,
                   uuid(),
@@ -3268,6 +3517,7 @@ void gcomm::evs::Proto::send_request_retrans_gap(const UUID& target,
                   origin,
                   range,
                   Message::F_RETRANS);
+    gm.set_sack(sack);
     gu::Buffer buf;
     serialize(gm, buf);
     Datagram dg(buf);
@@ -3305,14 +3555,39 @@ void gcomm::evs::Proto::request_retrans(const UUID& target, const UUID& origin,
                                  << input_map_->aru_seq();
         std::vector<Range> gap_ranges(input_map_->gap_range_list(
                                           origin_node.index(), range));
-        for (std::vector<Range>::const_iterator ri(gap_ranges.begin());
-             ri != gap_ranges.end(); ++ri)
-        {
+        // Request all gaps within Message::max_sack_span seqnos with
+        // single gap message, marking missing seqnos in selective ack
+        // bitmap. Ranges crossing the span boundary are split.
+        std::vector<Range>::size_type i(0);
+        seqno_t next(-1); // first seqno of split range not yet requested
+        while (i < gap_ranges.size())
+        {
+            const seqno_t lu(std::max(next, gap_ranges[i].lu()));
+            seqno_t hs(lu);
+            Message::SackBitmap sack;
+            while (i < gap_ranges.size() &&
+                   gap_ranges[i].lu() < lu + Message::max_sack_span)
+            {
+                const seqno_t begin(std::max(lu, gap_ranges[i].lu()));
+                hs = std::min(gap_ranges[i].hs(),
+                              lu + Message::max_sack_span - 1);
+                sack.resize((hs - lu)/8 + 1);
+                for (seqno_t seq(begin); seq <= hs; ++seq)
+                {
+                    sack[(seq - lu)/8] |= 1 << ((seq - lu) % 8);
+                }
+                if (hs < gap_ranges[i].hs())
+                {
+                    next = hs + 1;
+                    break;
+                }
+                ++i;
+            }
             evs_log_debug(D_RETRANS)
                 << "Requesting retransmssion from " << target
                 << " origin: " << origin
-                << " range: " << *ri;
-            send_request_retrans_gap(target, origin, *ri);
+                << " range: " << Range(lu, hs);
+            send_request_retrans_gap(target, origin, Range(lu, hs), sack);
         }
         NodeMap::iterator target_i(known_.find(target));
         if (target_i != known_.end())
@@ -3729,7 +4004,7 @@ void gcomm::evs::Proto::handle_user(const UserMessage& msg,
         while (output_.empty() == false)
         {
             int err;
-            gu_trace(err = send_user(send_window_));
+            gu_trace(err = send_user(cur_send_window_));
             if (err != 0)
             {
                 if (err == EAGAIN && n_sent == 0)
@@ -3775,6 +4050,37 @@ void gcomm::evs::Proto::handle_delegate(const DelegateMessage& msg,
 {
     gcomm_assert(ii != known_.end());
     evs_log_debug(D_DELEGATE_MSGS) << "delegate message " << msg;
+    if ((msg.flags() & Message::F_AGGREGATE) != 0)
+    {
+        // Batch of retransmitted messages, see send_retrans_batch().
+        // Messages originating from the sender of the batch don't
+        // carry source.
+        const gu::byte_t* const begin(gcomm::begin(rb));
+        const size_t available(gcomm::available(rb));
+        size_t offset(0);
+        while (offset < available)
+        {
+            AggregateMessage am;
+            gu_trace(offset = am.unserialize(begin, available, offset));
+            if (offset + am.len() > available)
+            {
+                gu_throw_error(EINVAL) << "retransmission batch message "
+                                       << "length " << am.len()
+                                       << " exceeds available "
+                                       << available - offset;
+            }
+            Datagram dg(gu::SharedBuffer(
+                            new gu::Buffer(begin + offset,
+                                           begin + offset + am.len())));
+            Message umsg;
+            size_t msg_offset;
+            gu_trace(msg_offset = unserialize_message(msg.source(), dg,
+                                                      &umsg));
+            gu_trace(handle_msg(umsg, Datagram(dg, msg_offset), false));
+            offset += am.len();
+        }
+        return;
+    }
     Message umsg;
     size_t offset;
     gu_trace(offset = unserialize_message(UUID::nil(), rb, &umsg));
@@ -3902,13 +4208,13 @@ void gcomm::evs::Proto::handle_gap(const GapMessage& msg, NodeMap::iterator ii)
         if (msg.range().lu() <= upper_bound)
         {
             gu_trace(resend(msg.source(),
-                            Range(msg.range().lu(), upper_bound)));
+                            Range(msg.range().lu(), upper_bound), &msg));
         }
     }
     else if ((msg.flags() & Message::F_RETRANS) != 0 &&
              msg.source() != uuid())
     {
-        gu_trace(recover(msg.source(), msg.range_uuid(), msg.range()));
+        gu_trace(recover(msg.source(), msg.range_uuid(), msg.range(), &msg));
     }
 
     //
@@ -3919,7 +4225,7 @@ void gcomm::evs::Proto::handle_gap(const GapMessage& msg, NodeMap::iterator ii)
             while (output_.empty() == false)
             {
                 int err;
-                gu_trace(err = send_user(send_window_));
+                gu_trace(err = send_user(cur_send_window_));
                 if (err != 0)
                     break;
             }
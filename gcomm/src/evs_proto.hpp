@@ -168,6 +168,11 @@ public:
     size_t aggregate_len() const;
     int send_user(const seqno_t);
     void complete_user(const seqno_t);
+    // Set send window in effect, user send window follows in proportion
+    // to configured windows.
+    void set_send_window(seqno_t);
+    // Adjust send windows in effect when the current round completes.
+    void adapt_send_window();
     int send_delegate(Datagram&, const UUID& target);
     bool gap_rate_limit(const UUID&, const Range&) const;
     // Send GAP message.
@@ -190,8 +195,22 @@ public:
     void send_install(EVS_CALLER_ARG);
     void send_delayed_list();
 
-    void resend(const UUID&, const Range);
-    void recover(const UUID&, const UUID&, const Range);
+    // Retransmit own messages in range to given node. If the
+    // retransmission request carries selective ack bitmap, only
+    // requested messages are sent and they are batched into
+    // delegate messages.
+    void resend(const UUID&, const Range, const GapMessage* request = 0);
+    // Retransmit messages of other node in range to given node,
+    // see resend().
+    void recover(const UUID&, const UUID&, const Range,
+                 const GapMessage* request = 0);
+    // Maximum size of retransmission batch
+    size_t retrans_batch_size() const;
+    // Append message to retransmission batch, sending the batch to target
+    // first if the message would not fit in.
+    int batch_retrans(gu::Buffer& batch, const Datagram&, const UUID& target);
+    // Send retransmission batch to target as single delegate message.
+    int send_retrans_batch(gu::Buffer& batch, const UUID& target);
 
     void retrans_leaves(const MessageNodeList&);
 
@@ -254,7 +273,8 @@ private:
     void asymmetry_elimination();
     void handle_foreign(const Message&);
     void send_request_retrans_gap(const UUID& target, const UUID& origin,
-                                  const Range& range);
+                                  const Range& range,
+                                  const Message::SackBitmap& sack);
     // Request retransmission of messages.
     // @param target Target node to request messages from.
     // @param origin Origin of the range of messages to request.
@@ -512,6 +532,25 @@ private:
     seqno_t send_window_;
     // User send window size
     seqno_t user_send_window_;
+    // Adaptive windowing (Conf::EvsAdaptiveWindow). The windows in effect
+    // are adjusted once per round trip of own messages between minimum
+    // and configured send windows, see adapt_send_window().
+    bool adaptive_window_;
+    // Send windows currently in effect
+    seqno_t cur_send_window_;
+    seqno_t cur_user_send_window_;
+    // Slow start threshold
+    seqno_t window_ssthresh_;
+    // Last seqno of the message which started the current round,
+    // -1 if no round is in progress
+    seqno_t window_round_seq_;
+    gu::datetime::Date window_round_start_;
+    // Value of retrans_msgs_ at the start of the round
+    long long int window_round_retrans_;
+    // Whether sending was blocked by flow control during the round
+    bool window_limited_;
+    // Shortest round trip time seen in the current view
+    gu::datetime::Period window_min_rtt_;
     // Bytes since the last user msg which will require feedback from
     // other nodes (i.e. sent without F_MSG_MORE)
     size_t bytes_since_request_user_msg_feedback_;
@@ -73,6 +73,14 @@ namespace gcomm
          */
         static std::string const SocketSendBufSize;
 
+        /*!
+         * @brief Number of threads running socket I/O. Socket reads and
+         *        writes, SSL and message checksums of different connections
+         *        are processed in parallel, protocol processing remains
+         *        serialized.
+         */
+        static std::string const SocketIoThreads;
+
         /*!
          * @brief GMCast scheme for transport URI ("gmcast")
          */
@@ -130,6 +138,17 @@ namespace gcomm
          */
         static std::string const GMCastMCastTTL;
 
+        /*!
+         * @brief GMCast multicast MTU ("gmcast.mcast_mtu")
+         *
+         * Maximum size of UDP payload sent to multicast address. Transport
+         * MTU is limited accordingly, so that user messages get fragmented
+         * to fit into single datagram. Set it to link MTU minus IP and UDP
+         * headers (1472 for Ethernet) to avoid IP fragmentation. Messages
+         * exceeding the limit are sent over unicast connections.
+         */
+        static std::string const GMCastMCastMtu;
+
         static std::string const GMCastTimeWait;
         static std::string const GMCastPeerTimeout;
 
@@ -165,6 +184,19 @@ namespace gcomm
          */
         static std::string const GMCastSegment;
 
+        /*!
+         * @brief Fan-out of the dissemination tree within local segment
+         *        ("gmcast.segment_fanout")
+         *
+         * When set to non-zero value, user messages are not sent directly
+         * to every peer in the local segment. Instead, peers ordered by
+         * UUID form a tree rooted at the message source in which every
+         * node forwards the message to at most this many peers. All nodes
+         * in the segment should use the same value. Zero (default) means
+         * full mesh.
+         */
+        static std::string const GMCastSegmentFanout;
+
 
         /*!
          * @brief EVS scheme for transport URI ("evs")
@@ -291,6 +323,16 @@ namespace gcomm
          */
         static std::string const EvsUserSendWindow;
 
+        /*!
+         * @brief EVS adaptive send window ("evs.adaptive_window")
+         *
+         * If enabled, send windows in effect are adjusted according to
+         * measured round trip time and retransmissions, Conf::EvsSendWindow
+         * and Conf::EvsUserSendWindow act as upper limits. Disabled by
+         * default.
+         */
+        static std::string const EvsAdaptiveWindow;
+
         /*!
          * @brief EVS message aggregation mode ("evs.use_aggregate")
          *
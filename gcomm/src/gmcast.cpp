@@ -14,6 +14,8 @@
 #include "gu_resolver.hpp"
 #include "gu_asio.hpp" // gu::conf::use_ssl
 
+#include <algorithm>
+
 using namespace std::rel_ops;
 
 using gcomm::gmcast::Proto;
@@ -80,6 +82,11 @@ gcomm::GMCast::GMCast(Protonet& net, const gu::URI& uri,
     segment_ (check_range(Conf::GMCastSegment,
                           param<int>(conf_, uri, Conf::GMCastSegment, "0"),
                           0, 255)),
+    segment_fanout_(check_range(Conf::GMCastSegmentFanout,
+                                param<int>(conf_, uri,
+                                           Conf::GMCastSegmentFanout,
+                                           Defaults::GMCastSegmentFanout),
+                                0, 255)),
     my_uuid_      (my_uuid ? *my_uuid : UUID(0, 0)),
     use_ssl_      (param<bool>(conf_, uri, gu::conf::use_ssl, "false")),
     // @todo: technically group name should be in path component
@@ -95,6 +102,11 @@ gcomm::GMCast::GMCast(Protonet& net, const gu::URI& uri,
                        Conf::GMCastMCastTTL,
                        param<int>(conf_, uri, Conf::GMCastMCastTTL, "1"),
                        1, 256)),
+    mcast_mtu_    (check_range(
+                       Conf::GMCastMCastMtu,
+                       param<int>(conf_, uri, Conf::GMCastMCastMtu,
+                                  Defaults::GMCastMCastMtu),
+                       1024, int(net.mtu() + NetHeader::serial_size_ + 1))),
     listener_     (0),
     mcast_        (),
     pending_addrs_(),
@@ -107,6 +119,9 @@ gcomm::GMCast::GMCast(Protonet& net, const gu::URI& uri,
     relay_set_    (),
     segment_map_  (),
     self_index_   (std::numeric_limits<size_t>::max()),
+    segment_tree_ (),
+    segment_direct_(),
+    mcast_peers_  (),
     time_wait_    (param<gu::datetime::Period>(
                        conf_, uri,
                        Conf::GMCastTimeWait, Defaults::GMCastTimeWait)),
@@ -222,8 +237,10 @@ gcomm::GMCast::GMCast(Protonet& net, const gu::URI& uri,
     conf_.set(Conf::GMCastVersion, gu::to_string(version_));
     conf_.set(Conf::GMCastTimeWait, gu::to_string(time_wait_));
     conf_.set(Conf::GMCastMCastTTL, gu::to_string(mcast_ttl_));
+    conf_.set(Conf::GMCastMCastMtu, gu::to_string(mcast_mtu_));
     conf_.set(Conf::GMCastPeerTimeout, gu::to_string(peer_timeout_));
     conf_.set(Conf::GMCastSegment, gu::to_string<int>(segment_));
+    conf_.set(Conf::GMCastSegmentFanout, gu::to_string(segment_fanout_));
 }
 
 gcomm::GMCast::~GMCast()
@@ -332,6 +349,8 @@ void gcomm::GMCast::connect()
             + gu::URI(listen_addr_).get_host()+'&'
             + gcomm::Socket::OptNonBlocking + "=1&"
             + gcomm::Socket::OptMcastTTL    + '=' + gu::to_string(mcast_ttl_)
+            + '&' + gcomm::Socket::OptIfLoop + '='
+            + uri_.get_option(gcomm::Socket::OptIfLoop, "false")
             );
 
         mcast_ = pnet().socket(mcast_uri);
@@ -377,6 +396,9 @@ void gcomm::GMCast::close(bool force)
     listener_ = 0;
 
     segment_map_.clear();
+    segment_tree_.clear();
+    segment_direct_.clear();
+    mcast_peers_.clear();
     for (ProtoMap::iterator
              i = proto_map_->begin(); i != proto_map_->end(); ++i)
     {
@@ -474,7 +496,7 @@ bool gcomm::GMCast::is_not_own_and_duplicate_exists(
 }
 
 // Erase proto entry in safe manner
-// 1) Erase from relay_set_
+// 1) Erase from relay_set_, segment_tree_ and segment_direct_
 // 2) Erase from proto_map_
 // 3) Delete proto entry
 void gcomm::GMCast::erase_proto(gmcast::ProtoMap::iterator i)
@@ -486,6 +508,33 @@ void gcomm::GMCast::erase_proto(gmcast::ProtoMap::iterator i)
     {
         relay_set_.erase(si);
     }
+    for (SegmentTree::iterator ti(segment_tree_.begin());
+         ti != segment_tree_.end(); ++ti)
+    {
+        if (ti->second.proto == p)
+        {
+            segment_tree_.erase(ti);
+            break;
+        }
+    }
+    for (Segment::iterator di(segment_direct_.begin());
+         di != segment_direct_.end(); ++di)
+    {
+        if (di->proto == p)
+        {
+            segment_direct_.erase(di);
+            break;
+        }
+    }
+    for (Segment::iterator mi(mcast_peers_.begin());
+         mi != mcast_peers_.end(); ++mi)
+    {
+        if (mi->proto == p)
+        {
+            mcast_peers_.erase(mi);
+            break;
+        }
+    }
     proto_map_->erase(i);
     delete p;
 }
@@ -864,6 +913,19 @@ void gcomm::GMCast::insert_address (const std::string& addr,
 }
 
 
+namespace
+{
+    // Orders segment tree entries by UUID
+    struct SegmentTreeCmp
+    {
+        template <typename T>
+        bool operator()(const T& a, const T& b) const
+        {
+            return (a.first < b.first);
+        }
+    };
+}
+
 void gcomm::GMCast::update_addresses()
 {
     LinkMap link_map;
@@ -986,6 +1048,9 @@ void gcomm::GMCast::update_addresses()
     // Build multicast tree
     log_debug << self_string() << " --- mcast tree begin ---";
     segment_map_.clear();
+    segment_tree_.clear();
+    segment_direct_.clear();
+    mcast_peers_.clear();
 
     Segment& local_segment(segment_map_[segment_]);
 
@@ -1014,6 +1079,26 @@ void gcomm::GMCast::update_addresses()
                 {
                     ++self_index_;
                 }
+                if (segment_fanout_ > 0 && !mcast_)
+                {
+                    // Only peers which forward along the same tree can
+                    // be part of it.
+                    if (p->remote_segment_fanout() == segment_fanout_)
+                    {
+                        segment_tree_.push_back(
+                            std::make_pair(p->remote_uuid(),
+                                           RelayEntry(p, p->socket().get())));
+                    }
+                    else
+                    {
+                        segment_direct_.push_back(
+                            RelayEntry(p, p->socket().get()));
+                    }
+                }
+            }
+            else if (p->state() == Proto::S_OK && mcast_)
+            {
+                mcast_peers_.push_back(RelayEntry(p, p->socket().get()));
             }
         }
         else
@@ -1025,6 +1110,12 @@ void gcomm::GMCast::update_addresses()
             }
         }
     }
+    if (segment_tree_.empty() == false)
+    {
+        segment_tree_.push_back(std::make_pair(uuid(), RelayEntry(0, 0)));
+        std::sort(segment_tree_.begin(), segment_tree_.end(),
+                  SegmentTreeCmp());
+    }
     log_debug << self_string() << " self index: " << self_index_;
     log_debug << self_string() << " --- mcast tree end ---";
 }
@@ -1310,11 +1401,33 @@ gu::datetime::Date gcomm::GMCast::handle_timers()
 
 void gcomm::GMCast::send(const RelayEntry& re, int segment, gcomm::Datagram& dg)
 {
+    const bool is_mcast(mcast_ && re.socket == mcast_.get());
+    if (is_mcast &&
+        dg.len() + NetHeader::serial_size_ > size_t(mcast_mtu_))
+    {
+        // Datagram does not fit into multicast MTU, deliver to peers
+        // listening to multicast over unicast connections.
+        for (Segment::iterator i(mcast_peers_.begin());
+             i != mcast_peers_.end(); ++i)
+        {
+            send(*i, segment, dg);
+        }
+        return;
+    }
+
     int err;
     if ((err = re.socket->send(segment, dg)) != 0)
     {
         log_debug << "failed to send to " << re.socket->remote_addr()
                   << ": (" << err << ") " << strerror(err);
+        if (is_mcast)
+        {
+            for (Segment::iterator i(mcast_peers_.begin());
+                 i != mcast_peers_.end(); ++i)
+            {
+                send(*i, segment, dg);
+            }
+        }
     }
     else if (re.proto)
     {
@@ -1322,6 +1435,34 @@ void gcomm::GMCast::send(const RelayEntry& re, int segment, gcomm::Datagram& dg)
     }
 }
 
+bool gcomm::GMCast::send_tree(const UUID& root, int segment,
+                              gcomm::Datagram& dg)
+{
+    const size_t n(segment_tree_.size());
+    size_t root_idx(n);
+    size_t self_idx(n);
+    for (size_t i(0); i < n; ++i)
+    {
+        if (segment_tree_[i].first == root) root_idx = i;
+        if (segment_tree_[i].second.socket == 0) self_idx = i;
+    }
+    if (root_idx == n || self_idx == n)
+    {
+        return false;
+    }
+
+    // Ranks relative to root form complete k-ary tree, children of
+    // rank r are r*k + 1 ... r*k + k.
+    const size_t fanout(segment_fanout_);
+    const size_t rank((self_idx + n - root_idx) % n);
+    for (size_t child(rank*fanout + 1);
+         child <= rank*fanout + fanout && child < n; ++child)
+    {
+        send(segment_tree_[(child + root_idx) % n].second, segment, dg);
+    }
+    return true;
+}
+
 void gcomm::GMCast::relay(const Message& msg,
                           const Datagram& dg,
                           const void* exclude_id)
@@ -1332,7 +1473,8 @@ void gcomm::GMCast::relay(const Message& msg,
 
     // reset all relay flags from message to be relayed
     relay_msg.set_flags(relay_msg.flags() &
-                        ~(Message::F_RELAY | Message::F_SEGMENT_RELAY));
+                        ~(Message::F_RELAY | Message::F_SEGMENT_RELAY |
+                          Message::F_TREE_RELAY));
 
     // if F_RELAY is set in received message, relay to all peers except
     // the originator
@@ -1387,6 +1529,32 @@ void gcomm::GMCast::relay(const Message& msg,
             send(*i, msg.segment_id(), relay_dg);
         }
     }
+    else if (msg.flags() & Message::F_TREE_RELAY)
+    {
+        // Source sends tree messages only to peers which advertised the
+        // same fanout, and directly to the rest of the segment. Forward to
+        // children in the tree rooted at source.
+        relay_msg.set_flags(relay_msg.flags() | Message::F_TREE_RELAY);
+        gu_trace(push_header(relay_msg, relay_dg));
+        if (send_tree(msg.source_uuid(), msg.segment_id(), relay_dg) == false)
+        {
+            // Source is not directly connected or this node does not see
+            // any tree peers, tree rooted at source can't be determined.
+            // Deliver to the whole segment instead so that descendants
+            // don't lose the message.
+            gu_trace(pop_header(relay_msg, relay_dg));
+            relay_msg.set_flags(relay_msg.flags() & ~Message::F_TREE_RELAY);
+            gu_trace(push_header(relay_msg, relay_dg));
+            Segment& segment(segment_map_[segment_]);
+            for (Segment::iterator i(segment.begin()); i != segment.end(); ++i)
+            {
+                if (i->socket->id() != exclude_id)
+                {
+                    send(*i, msg.segment_id(), relay_dg);
+                }
+            }
+        }
+    }
     else
     {
         log_warn << "GMCast::relay() called without relay flags set";
@@ -1433,6 +1601,13 @@ void gcomm::GMCast::handle_up(const void*        id,
 
         if (msg.type() >= Message::GMCAST_T_USER_BASE)
         {
+            // Own messages are looped back if socket.if_loop is set
+            if (msg.source_uuid() == uuid() ||
+                (evict_list().empty() == false &&
+                 evict_list().find(msg.source_uuid()) != evict_list().end()))
+            {
+                return;
+            }
             gu_trace(send_up(Datagram(dg, dg.offset() + msg.serial_size()),
                              ProtoUpMeta(msg.source_uuid())));
         }
@@ -1481,7 +1656,8 @@ void gcomm::GMCast::handle_up(const void*        id,
                     return;
                 }
                 if (msg.flags() &
-                    (Message::F_RELAY | Message::F_SEGMENT_RELAY))
+                    (Message::F_RELAY | Message::F_SEGMENT_RELAY |
+                     Message::F_TREE_RELAY))
                 {
                     relay(msg,
                           Datagram(dg, dg.offset() + msg.serial_size()),
@@ -1641,6 +1817,27 @@ int gcomm::GMCast::handle_down(Datagram& dg, const ProtoDownMeta& dm)
                 gu_trace(pop_header(msg, dg));
             }
         }
+        else if (segment_tree_.empty() == false && relay_set_.empty() == true)
+        {
+            // disseminate along the tree rooted at self, peers outside
+            // of the tree get the message directly
+            msg.set_flags((msg.flags() & ~Message::F_SEGMENT_RELAY) |
+                          Message::F_TREE_RELAY);
+            gu_trace(push_header(msg, dg));
+            send_tree(uuid(), msg.segment_id(), dg);
+            gu_trace(pop_header(msg, dg));
+            msg.set_flags(msg.flags() & ~Message::F_TREE_RELAY);
+            if (segment_direct_.empty() == false)
+            {
+                gu_trace(push_header(msg, dg));
+                for (Segment::iterator i(segment_direct_.begin());
+                     i != segment_direct_.end(); ++i)
+                {
+                    send(*i, msg.segment_id(), dg);
+                }
+                gu_trace(pop_header(msg, dg));
+            }
+        }
         else
         {
             msg.set_flags(msg.flags() & ~Message::F_SEGMENT_RELAY);
@@ -1920,7 +2117,8 @@ bool gcomm::GMCast::set_param(const std::string& key, const std::string& val,
                  key == Conf::GMCastMCastTTL    ||
                  key == Conf::GMCastTimeWait    ||
                  key == Conf::GMCastPeerTimeout ||
-                 key == Conf::GMCastSegment)
+                 key == Conf::GMCastSegment     ||
+                 key == Conf::GMCastSegmentFanout)
         {
             gu_throw_error(EPERM) << "can't change value during runtime";
         }
@@ -18,6 +18,7 @@
 
 
 #include <set>
+#include <algorithm>
 
 #ifndef GCOMM_GMCAST_MAX_VERSION
 #define GCOMM_GMCAST_MAX_VERSION 0
@@ -50,6 +51,7 @@ namespace gcomm
         // Transport interface
         const UUID& uuid() const { return my_uuid_; }
         SegmentId segment() const { return segment_; }
+        uint8_t segment_fanout() const { return segment_fanout_; }
         void connect_precheck(bool start_prim);
         void connect();
         void connect(const gu::URI&);
@@ -87,7 +89,11 @@ namespace gcomm
 
         size_t mtu() const
         {
-            return pnet_.mtu() - (4 + UUID::serial_size());
+            size_t const mtu(mcast_addr_.empty() ? pnet_.mtu() :
+                             std::min(pnet_.mtu(),
+                                      size_t(mcast_mtu_) -
+                                      NetHeader::serial_size_));
+            return mtu - (4 + UUID::serial_size());
         }
 
         void remove_viewstate_file() const
@@ -177,6 +183,7 @@ namespace gcomm
         int               version_;
         static const int  max_version_ = GCOMM_GMCAST_MAX_VERSION;
         uint8_t           segment_;
+        int               segment_fanout_;
         UUID              my_uuid_;
         bool              use_ssl_;
         std::string       group_name_;
@@ -185,6 +192,7 @@ namespace gcomm
         std::string       mcast_addr_;
         std::string       bind_ip_;
         int               mcast_ttl_;
+        int               mcast_mtu_;
         Acceptor*         listener_;
         SocketPtr         mcast_;
         AddrList          pending_addrs_;
@@ -215,6 +223,22 @@ namespace gcomm
         SegmentMap segment_map_;
         // self index in local segment when ordered by UUID
         size_t self_index_;
+        // Local segment members including self (null relay entry) ordered
+        // by UUID, non-empty only if segment fanout is enabled and some
+        // peers advertised the same fanout in handshake. Messages are
+        // disseminated along complete k-ary tree rooted at source.
+        typedef std::vector<std::pair<UUID, RelayEntry> > SegmentTree;
+        SegmentTree segment_tree_;
+        // Local segment peers which don't forward along the segment tree,
+        // messages are sent to them directly.
+        Segment segment_direct_;
+        // Send to children of this node in the segment tree rooted at root.
+        // Returns false if root is not found in the tree.
+        bool send_tree(const UUID& root, int segment, gcomm::Datagram& dg);
+        // Local segment peers which receive messages from multicast
+        // socket, unicast fallback for datagrams which can't be sent
+        // over multicast.
+        Segment mcast_peers_;
         gu::datetime::Period time_wait_;
         gu::datetime::Period check_period_;
         gu::datetime::Period peer_timeout_;
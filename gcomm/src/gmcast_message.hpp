@@ -33,7 +33,13 @@ public:
         // and to all other segments except source segment
         F_RELAY                   = 1 << 5,
         // relay message to all peers in the same segment
-        F_SEGMENT_RELAY           = 1 << 6
+        F_SEGMENT_RELAY           = 1 << 6,
+        // relay message to children in the local segment dissemination
+        // tree rooted at source (user messages)
+        F_TREE_RELAY              = 1 << 7,
+        // segment fanout of the sender is appended to the message
+        // (handshake and handshake response, shares bit with F_TREE_RELAY)
+        F_SEGMENT_FANOUT          = 1 << 7
     };
 
     enum Type
@@ -67,6 +73,14 @@ private:
     Message& operator=(const Message&);
 
     NodeList node_list_;
+    gu::byte_t        segment_fanout_;
+
+    bool has_segment_fanout() const
+    {
+        return ((flags_ & F_SEGMENT_FANOUT) &&
+                (type_ == GMCAST_T_HANDSHAKE ||
+                 type_ == GMCAST_T_HANDSHAKE_RESPONSE));
+    }
 public:
 
     static const char* type_to_string (Type t)
@@ -99,7 +113,8 @@ public:
         source_uuid_           (msg.source_uuid_),
         node_address_or_error_ (msg.node_address_or_error_),
         group_name_            (msg.group_name_),
-        node_list_             (msg.node_list_)
+        node_list_             (msg.node_list_),
+        segment_fanout_        (msg.segment_fanout_)
     { }
 
     /* Default ctor */
@@ -113,7 +128,8 @@ public:
         source_uuid_           (),
         node_address_or_error_ (),
         group_name_            (),
-        node_list_             ()
+        node_list_             (),
+        segment_fanout_        (0)
     {}
 
     /* Ctor for handshake */
@@ -121,17 +137,20 @@ public:
              const Type  type,
              const UUID& handshake_uuid,
              const UUID& source_uuid,
-             uint8_t     segment_id)
+             uint8_t     segment_id,
+             uint8_t     segment_fanout = 0)
         :
         version_               (version),
         type_                  (type),
-        flags_                 (F_HANDSHAKE_UUID),
+        flags_                 (F_HANDSHAKE_UUID |
+                                (segment_fanout > 0 ? F_SEGMENT_FANOUT : 0)),
         segment_id_            (segment_id),
         handshake_uuid_        (handshake_uuid),
         source_uuid_           (source_uuid),
         node_address_or_error_ (),
         group_name_            (),
-        node_list_             ()
+        node_list_             (),
+        segment_fanout_        (segment_fanout)
     {
         if (type_ != GMCAST_T_HANDSHAKE)
             gu_throw_fatal << "Invalid message type " << type_to_string(type_)
@@ -153,7 +172,8 @@ public:
         source_uuid_           (source_uuid),
         node_address_or_error_ (error),
         group_name_            (),
-        node_list_             ()
+        node_list_             (),
+        segment_fanout_        (0)
     {
         if (type_ != GMCAST_T_OK &&
             type_ != GMCAST_T_FAIL &&
@@ -180,7 +200,8 @@ public:
         source_uuid_           (source_uuid),
         node_address_or_error_ (),
         group_name_            (),
-        node_list_             ()
+        node_list_             (),
+        segment_fanout_        (0)
     {
         if (type_ < GMCAST_T_USER_BASE)
             gu_throw_fatal << "Invalid message type " << type_to_string(type_)
@@ -194,18 +215,21 @@ public:
              const gcomm::UUID& source_uuid,
              const std::string& node_address,
              const std::string& group_name,
-             uint8_t            segment_id)
+             uint8_t            segment_id,
+             uint8_t            segment_fanout = 0)
         :
         version_               (version),
         type_                  (type),
         flags_                 (F_GROUP_NAME | F_NODE_ADDRESS_OR_ERROR |
-                                F_HANDSHAKE_UUID),
+                                F_HANDSHAKE_UUID |
+                                (segment_fanout > 0 ? F_SEGMENT_FANOUT : 0)),
         segment_id_            (segment_id),
         handshake_uuid_        (handshake_uuid),
         source_uuid_           (source_uuid),
         node_address_or_error_ (node_address),
         group_name_            (group_name),
-        node_list_             ()
+        node_list_             (),
+        segment_fanout_        (segment_fanout)
     {
         if (type_ != GMCAST_T_HANDSHAKE_RESPONSE)
             gu_throw_fatal << "Invalid message type " << type_to_string(type_)
@@ -227,7 +251,8 @@ public:
         source_uuid_           (source_uuid),
         node_address_or_error_ (),
         group_name_            (group_name),
-        node_list_             (nodes)
+        node_list_             (nodes),
+        segment_fanout_        (0)
     {
         if (type_ != GMCAST_T_TOPOLOGY_CHANGE)
             gu_throw_fatal << "Invalid message type " << type_to_string(type_)
@@ -267,6 +292,12 @@ public:
         {
             gu_trace(off = node_list_.serialize(buf, buflen, off));
         }
+
+        // Last, so that peers which don't know the flag can ignore it
+        if (has_segment_fanout())
+        {
+            gu_trace(off = gu::serialize1(segment_fanout_, buf, buflen, off));
+        }
         return off;
     }
 
@@ -315,6 +346,12 @@ public:
             gu_trace(off = node_list_.unserialize(buf, buflen, off));
         }
 
+        if (has_segment_fanout())
+        {
+            gu_trace(off = gu::unserialize1(buf, buflen, off,
+                                            segment_fanout_));
+        }
+
         return off;
     }
 
@@ -343,7 +380,9 @@ public:
             /* Group name if set */
             + (flags_ & F_GROUP_NAME ? group_name_.serial_size() : 0)
             /* Node list if set */
-            + (flags_ & F_NODE_LIST ? node_list_.serial_size() : 0);
+            + (flags_ & F_NODE_LIST ? node_list_.serial_size() : 0)
+            /* Segment fanout if set */
+            + (has_segment_fanout() ? 1 : 0);
     }
 
     int version() const { return version_; }
@@ -364,6 +403,12 @@ public:
     const std::string&   group_name()   const { return group_name_.to_string();   }
 
     const NodeList& node_list()    const { return node_list_;    }
+
+    /* Segment fanout of the sender, 0 if not advertised */
+    uint8_t segment_fanout() const
+    {
+        return (has_segment_fanout() ? segment_fanout_ : 0);
+    }
 };
 
 #endif // GCOMM_GMCAST_MESSAGE_HPP
@@ -24,6 +24,7 @@ std::ostream& gcomm::gmcast::operator<<(std::ostream& os, const Proto& p)
        << "ru=" << p.remote_uuid_ << ","
        << "ls=" << static_cast<int>(p.local_segment_) << ","
        << "rs=" << static_cast<int>(p.remote_segment_) << ","
+       << "rf=" << static_cast<int>(p.remote_segment_fanout_) << ","
        << "la=" << p.local_addr_ << ","
        << "ra=" << p.remote_addr_ << ","
        << "mc=" << p.mcast_addr_ << ","
@@ -92,7 +93,7 @@ void gcomm::gmcast::Proto::send_handshake()
 {
     handshake_uuid_ = UUID(0, 0);
     Message hs (version_, Message::GMCAST_T_HANDSHAKE, handshake_uuid_,
-                gmcast_.uuid(), local_segment_);
+                gmcast_.uuid(), local_segment_, gmcast_.segment_fanout());
 
     send_msg(hs, false);
 
@@ -180,6 +181,7 @@ void gcomm::gmcast::Proto::handle_handshake(const Message& hs)
     handshake_uuid_ = hs.handshake_uuid();
     remote_uuid_ = hs.source_uuid();
     remote_segment_ = hs.segment_id();
+    remote_segment_fanout_ = hs.segment_fanout();
 
     if (validate_handshake_uuid() == false)
     {
@@ -192,7 +194,8 @@ void gcomm::gmcast::Proto::handle_handshake(const Message& hs)
                  gmcast_.uuid(),
                  local_addr_,
                  group_name_,
-                 local_segment_);
+                 local_segment_,
+                 gmcast_.segment_fanout());
     send_msg(hsr, false);
 
     set_state(S_HANDSHAKE_RESPONSE_SENT);
@@ -220,6 +223,7 @@ void gcomm::gmcast::Proto::handle_handshake_response(const Message& hs)
         }
         remote_uuid_ = hs.source_uuid();
         remote_segment_ = hs.segment_id();
+        remote_segment_fanout_ = hs.segment_fanout();
         gu::URI remote_uri(tp_->remote_addr());
         remote_addr_ = uri_string(remote_uri.get_scheme(),
                                   remote_uri.get_host(),
@@ -91,6 +91,7 @@ public:
         remote_uuid_      (),
         local_segment_    (local_segment),
         remote_segment_   (0),
+        remote_segment_fanout_(0),
         local_addr_       (local_addr),
         remote_addr_      (remote_addr),
         mcast_addr_       (mcast_addr),
@@ -142,6 +143,9 @@ public:
     const gcomm::UUID& local_uuid() const;
     const gcomm::UUID& remote_uuid() const { return remote_uuid_; }
     uint8_t remote_segment() const { return remote_segment_; }
+    // Segment fanout advertised by the peer in handshake, 0 if the peer
+    // does not forward messages along the segment tree.
+    uint8_t remote_segment_fanout() const { return remote_segment_fanout_; }
 
     SocketPtr socket() const { return tp_; }
 
@@ -177,6 +181,7 @@ private:
     gcomm::UUID       remote_uuid_;
     uint8_t           local_segment_;
     uint8_t           remote_segment_;
+    uint8_t           remote_segment_fanout_;
     std::string       local_addr_;
     std::string       remote_addr_;
     std::string       mcast_addr_;
@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2021 Codership Oy <info@codership.com>
+ */
+
+/**
+ * Throughput benchmark of gcomm TCP transport for small messages. A client
+ * socket streams datagrams of given size over loopback to an accepted socket
+ * of the same protonet, keeping up to window datagrams in flight. Reports
+ * messages and bytes per second as seen by the receiving side.
+ *
+ * Usage: asio_tcp_bench [msg_size [msgs [window [uri [conf]]]]]
+ *
+ * SSL throughput with the test certificates, in 4 I/O threads:
+ *
+ *   asio_tcp_bench 1024 1000000 1024 ssl://127.0.0.1:10071 \
+ *       "socket.ssl_key=tests/conf/galera_key.pem;\
+ *        socket.ssl_cert=tests/conf/galera_cert.pem;\
+ *        socket.ssl_ca=tests/conf/galera_ca.pem;socket.io_threads=4"
+ */
+
+#include "gcomm/protonet.hpp"
+#include "gcomm/conf.hpp"
+
+#include "gu_asio.hpp" // gu::ssl_register_params(), gu::ssl_init_options()
+#include "gu_config.hpp"
+#include "gu_crc32c.h" // gu_crc32c_configure()
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+
+class Bench : public gcomm::Toplay
+{
+public:
+    Bench(gu::Config& conf, gcomm::Protonet& pnet, const std::string& uri,
+          size_t msg_size, long msgs, long window)
+        :
+        gcomm::Toplay(conf),
+        uri_     (uri),
+        pnet_    (pnet),
+        pstack_  (),
+        listener_(0),
+        accepted_(),
+        client_  (),
+        msg_     (gu::Buffer(msg_size)),
+        msgs_    (msgs),
+        window_  (window),
+        sent_    (0),
+        received_(0),
+        start_   (),
+        stop_    ()
+    {
+        pstack_.push_proto(this);
+        pnet_.insert(&pstack_);
+        listener_ = pnet_.acceptor(uri_);
+        listener_->listen(uri_);
+        client_ = pnet_.socket(uri_);
+        client_->connect(uri_);
+    }
+
+    ~Bench()
+    {
+        client_->close();
+        if (accepted_) accepted_->close();
+        delete listener_;
+        pnet_.erase(&pstack_);
+        pstack_.pop_proto(this);
+    }
+
+    bool done() const { return received_ == msgs_; }
+
+    double elapsed() const
+    {
+        return double((stop_ - start_).get_nsecs()) / gu::datetime::Sec;
+    }
+
+    void handle_up(const void* id, const gcomm::Datagram& dg,
+                   const gcomm::ProtoUpMeta& um)
+    {
+        if (um.err_no() != 0)
+        {
+            std::cerr << "socket failed: " << um.err_no() << std::endl;
+            ::exit(EXIT_FAILURE);
+        }
+
+        if (id == listener_->id())
+        {
+            accepted_ = listener_->accept();
+        }
+        else if (id == client_->id())
+        {
+            // connected
+            start_ = gu::datetime::Date::monotonic();
+            send_more();
+        }
+        else if (accepted_ && id == accepted_->id() && dg.len() > 0)
+        {
+            ++received_;
+            if (done())
+            {
+                stop_ = gu::datetime::Date::monotonic();
+            }
+            else if (sent_ - received_ <= window_ / 2)
+            {
+                send_more();
+            }
+        }
+    }
+
+private:
+    Bench(const Bench&);
+    void operator=(const Bench&);
+
+    void send_more()
+    {
+        while (sent_ < msgs_ && sent_ - received_ < window_)
+        {
+            int const err(client_->send(0, msg_));
+            if (err != 0)
+            {
+                std::cerr << "send failed: " << err << std::endl;
+                ::exit(EXIT_FAILURE);
+            }
+            ++sent_;
+        }
+    }
+
+    gu::URI            uri_;
+    gcomm::Protonet&   pnet_;
+    gcomm::Protostack  pstack_;
+    gcomm::Acceptor*   listener_;
+    gcomm::SocketPtr   accepted_;
+    gcomm::SocketPtr   client_;
+    gcomm::Datagram    msg_;
+    long               msgs_;
+    long               window_;
+    long               sent_;
+    long               received_;
+    gu::datetime::Date start_;
+    gu::datetime::Date stop_;
+};
+
+int main(int argc, char* argv[])
+{
+    size_t const msg_size(argc > 1 ? ::strtoul(argv[1], NULL, 10) : 64);
+    long   const msgs    (argc > 2 ? ::strtol (argv[2], NULL, 10) : 1000000);
+    long   const window  (argc > 3 ? ::strtol (argv[3], NULL, 10) : 1024);
+    std::string const uri(argc > 4 ? argv[4] : "tcp://127.0.0.1:10071");
+
+    gu_crc32c_configure();
+
+    gu::Config conf;
+    gu::ssl_register_params(conf);
+    gcomm::Conf::register_params(conf);
+    if (argc > 5) conf.parse(argv[5]);
+    gu::ssl_init_options(conf);
+
+    gcomm::Protonet* const pnet(gcomm::Protonet::create(conf));
+    {
+        Bench bench(conf, *pnet, uri, msg_size, msgs, window);
+
+        while (not bench.done())
+        {
+            pnet->event_loop(gu::datetime::Period(10 * gu::datetime::MSec));
+        }
+
+        double const secs(bench.elapsed());
+        std::cout << "msg size " << msg_size
+                  << ", msgs " << msgs
+                  << ", window " << window
+                  << ": " << std::fixed << std::setprecision(3) << secs
+                  << " s, " << std::setprecision(0) << msgs / secs
+                  << " msgs/s, " << std::setprecision(1)
+                  << msgs * double(msg_size) / secs / (1 << 20)
+                  << " MiB/s" << std::endl;
+    }
+    delete pnet;
+
+    return 0;
+}
@@ -0,0 +1,83 @@
+//
+// Copyright (C) 2021 Codership Oy <info@codership.com>
+//
+
+#include "check_gcomm.hpp"
+#include "buffer_pool.hpp"
+
+#include "gcomm/datagram.hpp"
+
+#include <check.h>
+
+static const gu::byte_t data[4] = { 1, 2, 3, 4 };
+
+START_TEST(test_acquire)
+{
+    gcomm::BufferPool pool(2);
+    gu::SharedBuffer buf(pool.acquire(data, data + 3));
+    ck_assert(buf->size() == 3);
+    ck_assert(std::equal(buf->begin(), buf->end(), data));
+    ck_assert(pool.size() == 1);
+}
+END_TEST
+
+// Buffer is handed out again only after all the outside references
+// have been dropped.
+START_TEST(test_reuse)
+{
+    gcomm::BufferPool pool(2);
+    const gu::Buffer* first;
+    {
+        gcomm::Datagram dg(pool.acquire(data, data + 4));
+        first = &dg.payload();
+        gcomm::Datagram dg2(pool.acquire(data, data + 2));
+        ck_assert(&dg2.payload() != first);
+        gcomm::Datagram copy(dg);
+        ck_assert(pool.size() == 2);
+    }
+    gcomm::Datagram dg(pool.acquire(data + 1, data + 3));
+    ck_assert(&dg.payload() == first);
+    ck_assert(dg.payload().size() == 2);
+    ck_assert(dg.payload()[0] == 2 && dg.payload()[1] == 3);
+}
+END_TEST
+
+// When all pooled buffers are in use, new buffers are allocated but
+// not retained.
+START_TEST(test_exhausted)
+{
+    gcomm::BufferPool pool(1);
+    gu::SharedBuffer buf1(pool.acquire(data, data + 1));
+    gu::SharedBuffer buf2(pool.acquire(data, data + 2));
+    ck_assert(buf1 != buf2);
+    ck_assert(buf2.use_count() == 1);
+    ck_assert(pool.size() == 1);
+    buf2.reset();
+    gu::SharedBuffer buf3(pool.acquire(data, data + 3));
+    ck_assert(buf3 != buf1);
+    buf1.reset();
+    gu::SharedBuffer buf4(pool.acquire(data, data + 4));
+    ck_assert(buf4->size() == 4);
+    ck_assert(buf4.use_count() == 2);
+}
+END_TEST
+
+Suite* buffer_pool_suite()
+{
+    Suite* ret(suite_create("gcomm::BufferPool"));
+    TCase* tc;
+
+    tc = tcase_create("test_acquire");
+    tcase_add_test(tc, test_acquire);
+    suite_add_tcase(ret, tc);
+
+    tc = tcase_create("test_reuse");
+    tcase_add_test(tc, test_reuse);
+    suite_add_tcase(ret, tc);
+
+    tc = tcase_create("test_exhausted");
+    tcase_add_test(tc, test_exhausted);
+    suite_add_tcase(ret, tc);
+
+    return ret;
+}
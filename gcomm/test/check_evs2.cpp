@@ -122,6 +122,22 @@ START_TEST(test_message)
     check_serialization(lm, lm.serial_size(), LeaveMessage());
 
 
+    GapMessage gm(0, uuid1, view_id, 8, 5, 27, UUID(2), Range(7, 17),
+                  Message::F_RETRANS);
+    Message::SackBitmap sack(2);
+    sack[0] = 0x05; // seqnos 7 and 9
+    sack[1] = 0x04; // seqno 17
+    gm.set_sack(sack);
+    gm.set_source(uuid1);
+    check_serialization(gm, gm.serial_size(), GapMessage());
+    ck_assert(gm.is_requested(6)  == false);
+    ck_assert(gm.is_requested(7)  == true);
+    ck_assert(gm.is_requested(8)  == false);
+    ck_assert(gm.is_requested(9)  == true);
+    ck_assert(gm.is_requested(16) == false);
+    ck_assert(gm.is_requested(17) == true);
+    ck_assert(gm.is_requested(18) == false);
+
     DelayedListMessage dlm(0, uuid1, view_id, 4576);
     dlm.add(UUID(2), 23);
     dlm.add(UUID(3), 45);
@@ -400,6 +416,81 @@ START_TEST(test_input_map_random_insert)
 }
 END_TEST
 
+START_TEST(test_input_map_msg_index)
+{
+    log_info << "START";
+    UUID uuid1(1), uuid2(2);
+    ViewId view(V_REG, uuid1, 1);
+    InputMapMsgIndex mi;
+    mi.reset(2);
+
+    mi.insert_unique(InputMapMsgKey(1, 6),
+                     InputMapMsg(UserMessage(0, uuid2, view, 6), Datagram()));
+    mi.insert_unique(InputMapMsgKey(0, 5),
+                     InputMapMsg(UserMessage(0, uuid1, view, 5), Datagram()));
+    mi.insert_unique(InputMapMsgKey(1, 5),
+                     InputMapMsg(UserMessage(0, uuid2, view, 5), Datagram()));
+    // out of the initial window, ring must grow
+    mi.insert_unique(InputMapMsgKey(0, 40),
+                     InputMapMsg(UserMessage(0, uuid1, view, 40), Datagram()));
+    mi.insert_unique(InputMapMsgKey(0, 20),
+                     InputMapMsg(UserMessage(0, uuid1, view, 20), Datagram()));
+    ck_assert(mi.size() == 5);
+
+    try
+    {
+        mi.insert_unique(InputMapMsgKey(0, 20),
+                         InputMapMsg(UserMessage(0, uuid1, view, 20),
+                                     Datagram()));
+        ck_abort_msg("Exception not thrown for duplicate entry");
+    }
+    catch (...)
+    {  }
+
+    // iteration is ordered by seqno first, node index second
+    const size_t  order_idx[] = { 0, 1, 1,  0,  0 };
+    const seqno_t order_seq[] = { 5, 5, 6, 20, 40 };
+    size_t n(0);
+    for (InputMapMsgIndex::iterator i(mi.begin()); i != mi.end(); ++i, ++n)
+    {
+        ck_assert(InputMapMsgIndex::key(i).index() == order_idx[n]);
+        ck_assert(InputMapMsgIndex::key(i).seq() == order_seq[n]);
+        ck_assert(InputMapMsgIndex::value(i).msg().seq() == order_seq[n]);
+    }
+    ck_assert(n == 5);
+
+    // erasing other messages does not invalidate iterator
+    InputMapMsgIndex::iterator i(mi.find(InputMapMsgKey(1, 6)));
+    ck_assert(i != mi.end());
+    mi.erase(mi.find(InputMapMsgKey(0, 5)));
+    mi.erase(mi.find(InputMapMsgKey(1, 5)));
+    ++i;
+    ck_assert(InputMapMsgIndex::key(i).seq() == 20);
+    ck_assert(mi.find(InputMapMsgKey(0, 5)) == mi.end());
+    ck_assert(mi.begin() == mi.find(InputMapMsgKey(1, 6)));
+
+    mi.erase_up_to(20);
+    ck_assert(mi.size() == 1);
+    ck_assert(mi.begin() == mi.find(InputMapMsgKey(0, 40)));
+
+    // ring wraps around with the head moving forward
+    for (seqno_t seq(41); seq < 1000; ++seq)
+    {
+        mi.insert_unique(InputMapMsgKey(seq % 2, seq),
+                         InputMapMsg(UserMessage(0, seq % 2 ? uuid2 : uuid1,
+                                                 view, seq), Datagram()));
+        mi.erase(mi.begin());
+        ck_assert(mi.size() == 1);
+        ck_assert(InputMapMsgIndex::key(mi.begin()).seq() == seq);
+    }
+
+    mi.clear();
+    ck_assert(mi.empty() == true);
+    ck_assert(mi.begin() == mi.end());
+}
+END_TEST
+
+
 START_TEST(test_input_map_gap_range_list)
 {
     gcomm::evs::InputMap im;
@@ -523,9 +614,14 @@ static void single_join(DummyTransport* t, Proto* p)
 class DummyUser : public Toplay
 {
 public:
-    DummyUser(gu::Config& conf) : Toplay(conf) { }
-    void handle_up(const void*, const Datagram&, const ProtoUpMeta&) { }
+    DummyUser(gu::Config& conf) : Toplay(conf), delivered_(0) { }
+    void handle_up(const void*, const Datagram& dg, const ProtoUpMeta&)
+    {
+        if (dg.len() > 0) ++delivered_;
+    }
+    size_t delivered() const { return delivered_; }
 private:
+    size_t delivered_;
 };
 
 
@@ -2508,6 +2604,174 @@ START_TEST(test_out_queue_limit)
 }
 END_TEST
 
+static std::string evs_status(const gcomm::evs::Proto& evs,
+                              const std::string& key)
+{
+    gu::Status status;
+    evs.get_status(status);
+    for (gu::Status::const_iterator i(status.begin()); i != status.end(); ++i)
+    {
+        if (i->first == key) return i->second;
+    }
+    return "";
+}
+
+// Pass messages between two nodes until both transports are empty.
+static void exchange(TwoNodeFixture& f)
+{
+    gcomm::Datagram* dg;
+    do
+    {
+        while ((dg = f.tr1.out()) != 0)
+        {
+            f.evs2.handle_up(0, *dg, ProtoUpMeta(f.uuid1));
+            delete dg;
+        }
+        while ((dg = f.tr2.out()) != 0)
+        {
+            f.evs1.handle_up(0, *dg, ProtoUpMeta(f.uuid2));
+            delete dg;
+        }
+    }
+    while (f.tr1.empty() == false || f.tr2.empty() == false);
+}
+
+// Verify that adaptive send window grows when limiting sending
+// and shrinks when round trip time grows.
+START_TEST(test_adaptive_window)
+{
+    log_info << "START test_adaptive_window";
+    gu::datetime::SimClock::init(gu::datetime::Sec);
+    TwoNodeFixture f;
+    gcomm::Protolay::sync_param_cb_t spcb;
+
+    f.evs1.set_param("evs.send_window", "64", spcb);
+    f.evs1.set_param("evs.user_send_window", "32", spcb);
+    ck_assert(evs_status(f.evs1, "evs_send_window") == "64");
+    ck_assert(evs_status(f.evs1, "evs_user_send_window") == "32");
+
+    // Enabling adaptive window starts from the default window
+    f.evs1.set_param("evs.adaptive_window", "true", spcb);
+    ck_assert(evs_status(f.evs1, "evs_send_window") == "4");
+    ck_assert(evs_status(f.evs1, "evs_user_send_window") == "2");
+
+    char data[1] = { 0 };
+    gcomm::Datagram dg(gu::SharedBuffer(new gu::Buffer(data, data + 1)));
+
+    // Keep output queue full so that every round is window limited,
+    // the window must grow up to the configured one.
+    for (size_t round(0); round < 100; ++round)
+    {
+        for (size_t i(0); i < 64; ++i)
+        {
+            ck_assert(f.evs1.handle_down(dg, ProtoDownMeta(O_SAFE)) == 0);
+        }
+        exchange(f);
+    }
+    ck_assert_msg(evs_status(f.evs1, "evs_send_window") == "64",
+                  "send window %s",
+                  evs_status(f.evs1, "evs_send_window").c_str());
+    ck_assert(evs_status(f.evs1, "evs_user_send_window") == "32");
+
+    // Delay acknowledgements by more than a tenth of delay margin,
+    // the window must shrink.
+    ck_assert(f.evs1.handle_down(dg, ProtoDownMeta(O_SAFE)) == 0);
+    gu::datetime::SimClock::inc_time(200*gu::datetime::MSec);
+    exchange(f);
+    ck_assert_msg(evs_status(f.evs1, "evs_send_window") == "48",
+                  "send window %s",
+                  evs_status(f.evs1, "evs_send_window").c_str());
+    ck_assert(evs_status(f.evs1, "evs_user_send_window") == "24");
+
+    // Disabling adaptive window restores the configured windows
+    f.evs1.set_param("evs.adaptive_window", "false", spcb);
+    ck_assert(evs_status(f.evs1, "evs_send_window") == "64");
+    ck_assert(evs_status(f.evs1, "evs_user_send_window") == "32");
+    log_info << "END test_adaptive_window";
+}
+END_TEST
+
+// Verify that missing messages are requested with single selective ack
+// gap message and retransmitted in single batch.
+START_TEST(test_sack_retrans_batch)
+{
+    log_info << "START test_sack_retrans_batch";
+    gu::datetime::SimClock::init(gu::datetime::Sec);
+    TwoNodeFixture f;
+    gcomm::Protolay::sync_param_cb_t spcb;
+
+    f.evs1.set_param("evs.send_window", "8", spcb);
+    f.evs1.set_param("evs.user_send_window", "8", spcb);
+    char data[1] = { 0 };
+    gcomm::Datagram dg(gu::SharedBuffer(new gu::Buffer(data, data + 1)));
+    std::vector<gcomm::Datagram*> dgs;
+    for (size_t i(0); i < 5; ++i)
+    {
+        f.evs1.handle_down(dg, ProtoDownMeta(O_SAFE));
+        gcomm::Datagram* const read_dg(f.tr1.out());
+        ck_assert(read_dg != 0);
+        dgs.push_back(read_dg);
+    }
+
+    // Lose messages with seqnos 1 and 3. Skip past gap rate limit
+    // period before handling the last message.
+    f.evs2.handle_up(0, *dgs[0], ProtoUpMeta(f.uuid1));
+    f.evs2.handle_up(0, *dgs[2], ProtoUpMeta(f.uuid1));
+    gcomm::Datagram* read_dg;
+    while ((read_dg = f.tr2.out()) != 0) delete read_dg;
+    gu::datetime::SimClock::inc_time(200*gu::datetime::MSec);
+    f.evs2.handle_up(0, *dgs[4], ProtoUpMeta(f.uuid1));
+    std::for_each(dgs.begin(), dgs.end(), DeleteObject());
+
+    // Both gaps must be requested with single gap message
+    gcomm::evs::Message gm;
+    gcomm::Datagram* gap_dg(0);
+    while ((read_dg = get_msg(&f.tr2, &gm, false)) != 0)
+    {
+        if (gm.type() == gcomm::evs::Message::EVS_T_GAP &&
+            (gm.flags() & gcomm::evs::Message::F_RETRANS))
+        {
+            ck_assert(gap_dg == 0);
+            gap_dg = read_dg;
+        }
+        else
+        {
+            delete read_dg;
+        }
+    }
+    ck_assert(gap_dg != 0);
+    gcomm::evs::GapMessage gap;
+    gcomm::evs::Proto::unserialize_message(f.uuid2, *gap_dg, &gap);
+    ck_assert(gap.flags() & gcomm::evs::Message::F_SACK);
+    ck_assert(gap.range_uuid() == f.uuid1);
+    ck_assert_msg(gap.range() == gcomm::evs::Range(1, 3),
+                  "range %s", gu::to_string(gap.range()).c_str());
+    ck_assert(gap.is_requested(1) == true);
+    ck_assert(gap.is_requested(2) == false);
+    ck_assert(gap.is_requested(3) == true);
+
+    // Requested messages must be retransmitted in single batch
+    f.evs1.handle_up(0, *gap_dg, ProtoUpMeta(f.uuid2));
+    delete gap_dg;
+    gcomm::evs::Message dm;
+    read_dg = get_msg(&f.tr1, &dm, false);
+    ck_assert(read_dg != 0);
+    ck_assert(dm.type() == gcomm::evs::Message::EVS_T_DELEGATE);
+    ck_assert(dm.flags() & gcomm::evs::Message::F_AGGREGATE);
+    ck_assert(f.tr1.empty() == true);
+    f.evs2.handle_up(0, *read_dg, ProtoUpMeta(f.uuid1));
+    delete read_dg;
+
+    // Send one more message to let node2 know node1 aru, all of the
+    // messages must now get delivered.
+    f.evs1.handle_down(dg, ProtoDownMeta(O_SAFE));
+    exchange(f);
+    ck_assert_msg(f.top2.delivered() == 6, "delivered %zu",
+                  f.top2.delivered());
+    log_info << "END test_sack_retrans_batch";
+}
+END_TEST
+
 Suite* evs2_suite()
 {
     Suite* s = suite_create("gcomm::evs");
@@ -2546,6 +2810,10 @@ Suite* evs2_suite()
     tcase_add_test(tc, test_input_map_random_insert);
     suite_add_tcase(s, tc);
 
+    tc = tcase_create("test_input_map_msg_index");
+    tcase_add_test(tc, test_input_map_msg_index);
+    suite_add_tcase(s, tc);
+
     tc = tcase_create("test_input_map_gap_range_list");
     tcase_add_test(tc, test_input_map_gap_range_list);
     suite_add_tcase(s, tc);
@@ -2695,5 +2963,13 @@ Suite* evs2_suite()
     tcase_add_test(tc, test_out_queue_limit);
     suite_add_tcase(s, tc);
 
+    tc = tcase_create("test_adaptive_window");
+    tcase_add_test(tc, test_adaptive_window);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_sack_retrans_batch");
+    tcase_add_test(tc, test_sack_retrans_batch);
+    suite_add_tcase(s, tc);
+
     return s;
 }
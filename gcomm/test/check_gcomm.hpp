@@ -37,5 +37,7 @@ Suite* pc_suite();
 Suite* pc_nondet_suite();
 /* Fair send queue suite */
 Suite* fair_send_queue_suite();
+/* Receive buffer pool suite */
+Suite* buffer_pool_suite();
 
 #endif // CHECK_GCOMM_HPP
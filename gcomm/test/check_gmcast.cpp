@@ -43,115 +43,118 @@ START_TEST(test_gmcast_multicast)
 END_TEST
 
 
-START_TEST(test_gmcast_w_user_messages)
+class User : public Toplay
 {
-    class User : public Toplay
+    Transport* tp_;
+    size_t recvd_;
+    Protostack pstack_;
+    explicit User(const User&);
+    void operator=(User&);
+
+public:
+
+    User(Protonet& pnet,
+         const std::string& listen_addr,
+         const std::string& remote_addr,
+         const std::string& options = "") :
+        Toplay(pnet.conf()),
+        tp_(0),
+        recvd_(0),
+        pstack_()
     {
-        Transport* tp_;
-        size_t recvd_;
-        Protostack pstack_;
-        explicit User(const User&);
-        void operator=(User&);
-
-    public:
-
-        User(Protonet& pnet,
-             const std::string& listen_addr,
-             const std::string& remote_addr) :
-            Toplay(pnet.conf()),
-            tp_(0),
-            recvd_(0),
-            pstack_()
+        string uri("gmcast://");
+        uri += remote_addr; // != 0 ? remote_addr : "";
+        uri += "?";
+        uri += "tcp.non_blocking=1";
+        uri += "&";
+        uri += "gmcast.group=testgrp";
+        uri += "&gmcast.time_wait=PT0.5S";
+        if (test_multicast == true)
         {
-            string uri("gmcast://");
-            uri += remote_addr; // != 0 ? remote_addr : "";
-            uri += "?";
-            uri += "tcp.non_blocking=1";
-            uri += "&";
-            uri += "gmcast.group=testgrp";
-            uri += "&gmcast.time_wait=PT0.5S";
-            if (test_multicast == true)
-            {
-                uri += "&" + mcast_param;
-            }
-            uri += "&gmcast.listen_addr=tcp://";
-            uri += listen_addr;
-
-            tp_ = Transport::create(pnet, uri);
+            uri += "&" + mcast_param;
         }
+        uri += "&gmcast.listen_addr=tcp://";
+        uri += listen_addr;
+        uri += options;
+
+        tp_ = Transport::create(pnet, uri);
+    }
 
-        ~User()
+    ~User()
+    {
+        delete tp_;
+    }
+
+    void start(const std::string& peer = "")
+    {
+        if (peer == "")
         {
-            delete tp_;
+            tp_->connect();
         }
-
-        void start(const std::string& peer = "")
+        else
         {
-            if (peer == "")
-            {
-                tp_->connect();
-            }
-            else
-            {
-                tp_->connect(peer);
-            }
-            pstack_.push_proto(tp_);
-            pstack_.push_proto(this);
+            tp_->connect(peer);
         }
+        pstack_.push_proto(tp_);
+        pstack_.push_proto(this);
+    }
 
 
-        void stop()
-        {
-            pstack_.pop_proto(this);
-            pstack_.pop_proto(tp_);
-            tp_->close();
-        }
+    void stop()
+    {
+        pstack_.pop_proto(this);
+        pstack_.pop_proto(tp_);
+        tp_->close();
+    }
 
-        void handle_timer()
-        {
-            byte_t buf[16];
-            memset(buf, 0xa5, sizeof(buf));
+    void handle_timer(size_t size = 16)
+    {
+        Buffer buf(size);
+        std::fill(buf.begin(), buf.end(), 0xa5);
 
-            Datagram dg(Buffer(buf, buf + sizeof(buf)));
+        Datagram dg(buf);
 
-            send_down(dg, ProtoDownMeta());
-        }
+        send_down(dg, ProtoDownMeta());
+    }
 
-        void handle_up(const void* cid, const Datagram& rb,
-                       const ProtoUpMeta& um)
+    void handle_up(const void* cid, const Datagram& rb,
+                   const ProtoUpMeta& um)
+    {
+        if (rb.len() < rb.offset() + 16)
         {
-            if (rb.len() < rb.offset() + 16)
-            {
-                gu_throw_fatal << "offset error";
-            }
-            char buf[16];
-            memset(buf, 0xa5, sizeof(buf));
-            // cppcheck-suppress uninitstring
-            if (memcmp(buf, &rb.payload()[0] + rb.offset(), 16) != 0)
-            {
-                gu_throw_fatal << "content mismatch";
-            }
-            recvd_++;
+            gu_throw_fatal << "offset error";
         }
-
-        size_t recvd() const
+        char buf[16];
+        memset(buf, 0xa5, sizeof(buf));
+        // cppcheck-suppress uninitstring
+        if (memcmp(buf, &rb.payload()[0] + rb.offset(), 16) != 0)
         {
-            return recvd_;
+            gu_throw_fatal << "content mismatch";
         }
+        recvd_++;
+    }
 
-        void set_recvd(size_t val)
-        {
-            recvd_ = val;
-        }
+    size_t recvd() const
+    {
+        return recvd_;
+    }
 
-        Protostack& pstack() { return pstack_; }
+    void set_recvd(size_t val)
+    {
+        recvd_ = val;
+    }
 
-        std::string listen_addr() const
-        {
-            return tp_->listen_addr();
-        }
-    };
+    Protostack& pstack() { return pstack_; }
 
+    std::string listen_addr() const
+    {
+        return tp_->listen_addr();
+    }
+};
+
+
+START_TEST(test_gmcast_w_user_messages)
+{
     log_info << "START";
     gu::Config conf;
     gu::ssl_register_params(conf);
@@ -252,6 +255,154 @@ START_TEST(test_gmcast_w_user_messages)
 END_TEST
 
 
+// Four users in one segment, every user sends one message per round.
+// Checks that every user receives all the messages from the others.
+static void segment_fanout_helper(const char* const fanouts[4])
+{
+    gu::Config conf;
+    gu::ssl_register_params(conf);
+    gcomm::Conf::register_params(conf);
+    auto_ptr<Protonet> pnet(Protonet::create(conf));
+
+    User u1(*pnet, "127.0.0.1:0", "",
+            std::string("&gmcast.segment_fanout=") + fanouts[0]);
+    pnet->insert(&u1.pstack());
+    u1.start();
+    pnet->event_loop(Sec/10);
+
+    const std::string addr1(u1.listen_addr().erase(0, strlen("tcp://")));
+    User u2(*pnet, "127.0.0.1:0", addr1,
+            std::string("&gmcast.segment_fanout=") + fanouts[1]);
+    User u3(*pnet, "127.0.0.1:0", addr1,
+            std::string("&gmcast.segment_fanout=") + fanouts[2]);
+    User u4(*pnet, "127.0.0.1:0", addr1,
+            std::string("&gmcast.segment_fanout=") + fanouts[3]);
+    User* users[4] = { &u1, &u2, &u3, &u4 };
+    for (size_t i(1); i < 4; ++i)
+    {
+        pnet->insert(&users[i]->pstack());
+        users[i]->start();
+    }
+
+    // let the full mesh form
+    pnet->event_loop(2*Sec);
+
+    for (size_t i(0); i < 4; ++i) users[i]->set_recvd(0);
+
+    const size_t rounds(10);
+    for (size_t r(0); r < rounds; ++r)
+    {
+        for (size_t i(0); i < 4; ++i) users[i]->handle_timer();
+        pnet->event_loop(Sec/10);
+    }
+    pnet->event_loop(Sec/2);
+
+    for (size_t i(0); i < 4; ++i)
+    {
+        ck_assert_msg(users[i]->recvd() == 3*rounds,
+                      "user %zu received %zu messages, expected %zu",
+                      i + 1, users[i]->recvd(), 3*rounds);
+    }
+
+    for (size_t i(0); i < 4; ++i)
+    {
+        pnet->erase(&users[i]->pstack());
+        users[i]->stop();
+    }
+    pnet->event_loop(0);
+}
+
+START_TEST(test_gmcast_segment_fanout)
+{
+    log_info << "START test_gmcast_segment_fanout";
+    // Fanout 1 makes dissemination tree a chain, every message must be
+    // forwarded by all but the last node.
+    const char* const fanouts[4] = { "1", "1", "1", "1" };
+    segment_fanout_helper(fanouts);
+    log_info << "END test_gmcast_segment_fanout";
+}
+END_TEST
+
+START_TEST(test_gmcast_segment_fanout_mixed)
+{
+    log_info << "START test_gmcast_segment_fanout_mixed";
+    // Nodes with fanout 0 or different fanout don't forward tree messages
+    // and must be sent to directly. Only u1 and u3 form a tree.
+    const char* const fanouts[4] = { "1", "0", "1", "2" };
+    segment_fanout_helper(fanouts);
+    log_info << "END test_gmcast_segment_fanout_mixed";
+}
+END_TEST
+
+
+// Multicast over loopback interface, hard coded multicast port
+START_TEST(test_gmcast_mcast_loopback)
+{
+    log_info << "START test_gmcast_mcast_loopback";
+    gu::Config conf;
+    gu::ssl_register_params(conf);
+    gcomm::Conf::register_params(conf);
+    auto_ptr<Protonet> pnet(Protonet::create(conf));
+
+    // Own messages are looped back to all sockets on the host and
+    // must be filtered out.
+    const std::string options("&gmcast.mcast_addr=239.192.0.12"
+                              "&gmcast.mcast_port=10099"
+                              "&gmcast.mcast_mtu=1024"
+                              "&socket.if_loop=1");
+    User u1(*pnet, "127.0.0.1:0", "", options);
+    pnet->insert(&u1.pstack());
+    u1.start();
+    pnet->event_loop(Sec/10);
+
+    const std::string addr1(u1.listen_addr().erase(0, strlen("tcp://")));
+    User u2(*pnet, "127.0.0.1:0", addr1, options);
+    User u3(*pnet, "127.0.0.1:0", addr1, options);
+    User* users[3] = { &u1, &u2, &u3 };
+    for (size_t i(1); i < 3; ++i)
+    {
+        pnet->insert(&users[i]->pstack());
+        users[i]->start();
+    }
+
+    pnet->event_loop(2*Sec);
+
+    // Small messages go over multicast only, datagrams exceeding
+    // multicast MTU are sent over TCP connections. Either way every
+    // message must be delivered exactly once.
+    const size_t sizes[2] = { 16, 2048 };
+    for (size_t s(0); s < 2; ++s)
+    {
+        for (size_t i(0); i < 3; ++i) users[i]->set_recvd(0);
+
+        const size_t rounds(10);
+        for (size_t r(0); r < rounds; ++r)
+        {
+            for (size_t i(0); i < 3; ++i) users[i]->handle_timer(sizes[s]);
+            pnet->event_loop(Sec/10);
+        }
+        pnet->event_loop(Sec/2);
+
+        for (size_t i(0); i < 3; ++i)
+        {
+            ck_assert_msg(users[i]->recvd() == 2*rounds,
+                          "user %zu received %zu messages of size %zu, "
+                          "expected %zu",
+                          i + 1, users[i]->recvd(), sizes[s], 2*rounds);
+        }
+    }
+
+    for (size_t i(0); i < 3; ++i)
+    {
+        pnet->erase(&users[i]->pstack());
+        users[i]->stop();
+    }
+    pnet->event_loop(0);
+    log_info << "END test_gmcast_mcast_loopback";
+}
+END_TEST
+
+
 // not run by default, hard coded port
 START_TEST(test_gmcast_auto_addr)
 {
@@ -496,6 +647,21 @@ Suite* gmcast_suite()
     tcase_set_timeout(tc, 30);
     suite_add_tcase(s, tc);
 
+    tc = tcase_create("test_gmcast_segment_fanout");
+    tcase_add_test(tc, test_gmcast_segment_fanout);
+    tcase_set_timeout(tc, 30);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_gmcast_segment_fanout_mixed");
+    tcase_add_test(tc, test_gmcast_segment_fanout_mixed);
+    tcase_set_timeout(tc, 30);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_gmcast_mcast_loopback");
+    tcase_add_test(tc, test_gmcast_mcast_loopback);
+    tcase_set_timeout(tc, 30);
+    suite_add_tcase(s, tc);
+
     // not run by default, hard coded port
     tc = tcase_create("test_gmcast_auto_addr");
     tcase_add_test(tc, test_gmcast_auto_addr);
@@ -16,6 +16,7 @@
 #include <assert.h>
 
 #include <galerautils.h>
+#include "gu_histogram.hpp"
 
 #include "gcs_priv.hpp"
 #include "gcs_params.hpp"
@@ -89,17 +90,6 @@ static const char* gcs_conn_state_str[GCS_CONN_STATE_MAX] =
     "ERROR"
 };
 
-static bool const GCS_FC_STOP = true;
-static bool const GCS_FC_CONT = false;
-
-/** Flow control message */
-struct gcs_fc_event
-{
-    uint32_t conf_id; // least significant part of configuraiton seqno
-    uint32_t stop;    // boolean value
-}
-__attribute__((__packed__));
-
 struct gcs_conn
 {
     long  my_idx;
@@ -130,6 +120,22 @@ struct gcs_conn
     ssize_t      recv_q_size;
     gu_thread_t  recv_thread;
 
+    /* Receive pipeline: recv_thread gets ordered actions from core and hands
+     * them over to disp_thread, which delivers them to application */
+    gu_fifo_t*   disp_q;
+    gu_thread_t  disp_thread;
+    long         disp_pushed;  // actions pushed to disp_q by recv_thread
+    long         disp_done;    // actions dispatched by disp_thread
+    long         disp_err;     // error that stopped disp_thread
+    bool         disp_stopped;
+    int          disp_wait;    // recv_thread waits for disp_q to drain
+    gu_mutex_t   disp_lock;
+    gu_cond_t    disp_cond;
+
+    /* pipeline stage latencies */
+    gu::LatencyHistogram* disp_lat;   // core -> disp_thread
+    gu::LatencyHistogram* recv_q_lat; // disp_thread -> application
+
     /* Message receiving timeout - absolute date in nanoseconds */
     long long    timeout;
 
@@ -171,6 +177,8 @@ struct gcs_conn
     long         stats_fc_cont_sent;  //
     long         stats_fc_received;   //
     gcs_fc_t     stfc; // state transfer FC object
+    gcs_fc_rate_t rfc; // rate-based FC object
+    bool         fc_pulse;            // STOP was sent to pace replication
 
     /* #603, #606 join control */
     gcs_seqno_t volatile join_seqno;
@@ -202,18 +210,33 @@ struct gcs_recv_act
 {
     struct gcs_act_rcvd rcvd;
     gcs_seqno_t         local_id;
+    long long           ts;       // when queued, for latency stats
 };
 
+/* received action waiting for dispatch */
+struct gcs_disp_act
+{
+    struct gcs_act_rcvd rcvd;
+    long                ret;      // gcs_core_recv() return code
+    long long           ts;       // when received, for latency stats
+};
+
+/* disp_q does not need to be long: actions are dispatched quickly, and
+ * recv_thread may block in the meantime */
+static size_t const GCS_DISP_Q_LEN = 1 << 12;
+
 struct gcs_repl_act
 {
     const struct gu_buf* act_in;
     struct gcs_action*   action;
     gu_mutex_t           wait_mutex;
     gu_cond_t            wait_cond;
+    bool                 delivered; // protected by wait_mutex
     gcs_repl_act(const struct gu_buf* a_act_in, struct gcs_action* a_action)
       :
         act_in(a_act_in),
-        action(a_action)
+        action(a_action),
+        delivered(false)
     { }
 };
 
@@ -292,6 +315,8 @@ gcs_create (gu_config_t* const conf, gcache_t* const gcache,
         goto core_create_failed;
     }
 
+    gcs_core_set_frag_time (conn->core, conn->params.frag_time * 1000LL);
+
     conn->repl_q = gcs_fifo_lite_create (GCS_MAX_REPL_THREADS,
                                          sizeof (struct gcs_repl_act*));
     if (!conn->repl_q) {
@@ -310,6 +335,12 @@ gcs_create (gu_config_t* const conf, gcache_t* const gcache,
         goto recv_q_failed;
     }
 
+    conn->disp_q = gu_fifo_create (GCS_DISP_Q_LEN, sizeof(struct gcs_disp_act));
+    if (!conn->disp_q) {
+        gu_error ("Failed to create disp_q.");
+        goto disp_q_failed;
+    }
+
     conn->sm = gcs_sm_create(1<<16, 1);
 
     if (!conn->sm) {
@@ -317,6 +348,9 @@ gcs_create (gu_config_t* const conf, gcache_t* const gcache,
         goto sm_create_failed;
     }
 
+    gcs_sm_set_batch (conn->sm, conn->params.aggregate_size,
+                      conn->params.aggregate_delay * 1000LL);
+
     conn->state        = GCS_CONN_CLOSED;
     conn->my_idx       = -1;
     conn->local_act_id = GCS_SEQNO_FIRST;
@@ -327,12 +361,24 @@ gcs_create (gu_config_t* const conf, gcache_t* const gcache,
     conn->max_fc_state = conn->params.sync_donor ?
         GCS_CONN_DONOR : GCS_CONN_JOINED;
 
+    gcs_fc_rate_init  (&conn->rfc, 0, 0, gu_time_monotonic());
+    gcs_fc_rate_debug (&conn->rfc, conn->params.fc_debug);
+
     gu_mutex_init (&conn->fc_lock, NULL);
+    gu_mutex_init (&conn->disp_lock, NULL);
+    gu_cond_init  (&conn->disp_cond, NULL);
+
+    conn->disp_lat   = new gu::LatencyHistogram();
+    conn->recv_q_lat = new gu::LatencyHistogram();
 
     return conn; // success
 
 sm_create_failed:
 
+    gu_fifo_destroy (conn->disp_q);
+
+disp_q_failed:
+
     gu_fifo_destroy (conn->recv_q);
 
 recv_q_failed:
@@ -469,6 +515,46 @@ gcs_fc_stop_end (gcs_conn_t* conn)
     return ret;
 }
 
+/* To be called under slave queue lock after the action was accounted for
+ * in queue_len. Returns the length of a pause in replication that must be
+ * requested to pace it to the rate this node can apply actions at. */
+static inline long long
+gcs_fc_pace_begin (gcs_conn_t* conn)
+{
+    if (!conn->params.fc_rate || conn->state > conn->max_fc_state) return 0;
+
+    long long const pause(gcs_fc_rate_process (&conn->rfc,
+                                               conn->queue_len -
+                                               conn->fc_offset,
+                                               gu_time_monotonic()));
+
+    /* a pause is requested with a STOP message only if there is none in
+     * effect already, otherwise it just gets extended */
+    if (pause > 0 && conn->stop_sent_ <= 0) conn->fc_pulse = true;
+
+    return (conn->fc_pulse ? pause : 0);
+}
+
+/* Complement to gcs_fc_pace_begin(), schedules FC_CONT at the end of pause */
+static inline int
+gcs_fc_pace_end (gcs_conn_t* conn, long long const pause)
+{
+    long long const until(gu_time_calendar() + pause);
+
+    if (GU_TIME_ETERNITY == conn->timeout || conn->timeout < until) {
+        conn->timeout = until;
+    }
+
+    int const err(gu_mutex_lock (&conn->fc_lock));
+
+    if (gu_unlikely(err)) {
+        gu_fatal ("Mutex lock failed: %d (%s)", err, strerror(err));
+        abort();
+    }
+
+    return gcs_fc_stop_end (conn);
+}
+
 /* To be called under slave queue lock. Returns true if FC_CONT must be sent */
 static inline bool
 gcs_fc_cont_begin (gcs_conn_t* conn)
@@ -478,7 +564,11 @@ gcs_fc_cont_begin (gcs_conn_t* conn)
     bool queue_decreased = (conn->fc_offset > conn->queue_len &&
                             (conn->fc_offset = conn->queue_len, true));
 
+    /* pacing pause ends early if applier runs out of work */
+    if (conn->fc_pulse && 0 == conn->queue_len) conn->fc_pulse = false;
+
     bool ret = (conn->stop_sent_  >  0                                    &&
+                !conn->fc_pulse                                           &&
                 (conn->lower_limit >= conn->queue_len || queue_decreased) &&
                 conn->state        <= conn->max_fc_state                  &&
                 !(err = gu_mutex_lock (&conn->fc_lock)));
@@ -840,8 +930,16 @@ _set_fc_limits (gcs_conn_t* conn)
     conn->upper_limit = conn->params.fc_base_limit * fn + .5;
     conn->lower_limit = conn->upper_limit * conn->params.fc_resume_factor + .5;
 
-    gu_info ("Flow-control interval: [%ld, %ld]",
-             conn->lower_limit, conn->upper_limit);
+    /* rate-based FC paces replication between lower and upper limits,
+     * if there is no gap between them, from the middle of the interval */
+    gcs_fc_rate_limits (&conn->rfc,
+                        conn->lower_limit < conn->upper_limit ?
+                        conn->lower_limit : conn->upper_limit / 2,
+                        conn->upper_limit);
+
+    gu_info ("Flow-control interval: [%ld, %ld]%s",
+             conn->lower_limit, conn->upper_limit,
+             conn->params.fc_rate ? ", rate-based" : "");
 }
 
 /*! Handles flow control events
@@ -923,6 +1021,7 @@ gcs_handle_act_conf (gcs_conn_t* conn, const void* action)
 
             conn->stop_sent_  = 0;
             conn->stop_count  = 0;
+            conn->fc_pulse    = false;
             conn->conf_id     = conf->conf_id;
             conn->memb_num    = conf->memb_num;
 
@@ -937,7 +1036,7 @@ gcs_handle_act_conf (gcs_conn_t* conn, const void* action)
 
         conn->sync_sent(false);
     }
-    gu_fifo_release (conn->recv_q);
+    gu_fifo_release(conn->recv_q);
 
     if (conf->conf_id < 0) {
         if (0 == conf->memb_num) {
@@ -1118,12 +1217,34 @@ gcs_handle_actions (gcs_conn_t*          conn,
 }
 
 static inline void
-GCS_FIFO_PUSH_TAIL (gcs_conn_t* conn, ssize_t size)
+GCS_FIFO_PUSH_TAIL (gcs_conn_t* conn, struct gcs_recv_act* act)
 {
-    conn->recv_q_size += size;
+    act->ts = gu_time_monotonic();
+    conn->recv_q_size += act->rcvd.act.buf_len;
     gu_fifo_push_tail(conn->recv_q);
 }
 
+/* Ends replication pause requested by rate-based flow control, unless
+ * slave queue has grown past upper limit in the meantime: then the STOP stays
+ * in effect until the queue drains below lower limit as usual. */
+static void
+_release_pace_flow_control (gcs_conn_t* conn)
+{
+    gu_fifo_lock(conn->recv_q);
+    bool const release(conn->fc_pulse &&
+                       conn->queue_len <= conn->upper_limit + conn->fc_offset);
+    conn->fc_pulse = false;
+    gu_fifo_release(conn->recv_q);
+
+    int const err(release ? _release_flow_control (conn) : 0);
+
+    if (gu_unlikely(err < 0)) {
+        gu_warn ("Failed to send FC_CONT at the end of replication pause: "
+                 "%d (%s). Will retry when slave queue drains.",
+                 err, strerror(-err));
+    }
+}
+
 /* Returns true if timeout was handled and false otherwise */
 static bool
 _handle_timeout (gcs_conn_t* conn)
@@ -1134,8 +1255,13 @@ _handle_timeout (gcs_conn_t* conn)
     /* TODO: now the only point for timeout is flow control (#412),
      *       later we might need to handle more timers. */
     if (conn->timeout <= now) {
-        ret = ((GCS_CONN_JOINER != conn->state) ||
-               (_release_sst_flow_control (conn) >= 0));
+        if (GCS_CONN_JOINER != conn->state) {
+            _release_pace_flow_control (conn);
+            ret = true;
+        }
+        else {
+            ret = (_release_sst_flow_control (conn) >= 0);
+        }
     }
     else {
         gu_error ("Unplanned timeout! (tout: %lld, now: %lld)",
@@ -1238,6 +1364,7 @@ _close(gcs_conn_t* conn, bool join_recv_thread)
              * they'll quit on their own,
              * they don't depend on the conn object after waking */
             gu_mutex_lock   (&act->wait_mutex);
+            act->delivered = true;
             gu_cond_signal  (&act->wait_cond);
             gu_mutex_unlock (&act->wait_mutex);
         }
@@ -1253,182 +1380,338 @@ _close(gcs_conn_t* conn, bool join_recv_thread)
     return ret;
 }
 
-/*
- * gcs_recv_thread() receives whatever actions arrive from group,
- * and performs necessary actions based on action type.
- */
-static void *gcs_recv_thread (void *arg)
+/* Delivers received action to application or to the thread that
+ * replicated it, handles flow control and group events.
+ * Returns negative error code if receiving must stop. */
+static long
+gcs_dispatch (gcs_conn_t* conn, struct gcs_act_rcvd& rcvd, long ret)
 {
-    gcs_conn_t* conn = (gcs_conn_t*)arg;
-    ssize_t     ret  = -ECONNABORTED;
+    gcs_seqno_t this_act_id = GCS_SEQNO_ILL;
+    struct gcs_repl_act** repl_act_ptr;
 
-    // To avoid race between gcs_open() and the following state check in while()
-    gu_cond_t tmp_cond; /* TODO: rework when concurrency in SM is allowed */
-    gu_cond_init (&tmp_cond, NULL);
-    gcs_sm_enter(conn->sm, &tmp_cond, false, true);
-    gcs_sm_leave(conn->sm);
-    gu_cond_destroy (&tmp_cond);
+    if (gu_unlikely(ret <= 0)) {
 
-    while (conn->state < GCS_CONN_CLOSED)
-    {
-        gcs_seqno_t this_act_id = GCS_SEQNO_ILL;
-        struct gcs_repl_act** repl_act_ptr;
-        struct gcs_act_rcvd   rcvd;
+        assert (NULL          == rcvd.act.buf);
+        assert (0             == rcvd.act.buf_len);
+        assert (GCS_ACT_ERROR == rcvd.act.type ||
+                GCS_ACT_INCONSISTENCY == rcvd.act.type);
+        assert (GCS_SEQNO_ILL == rcvd.id);
 
-        ret = gcs_core_recv (conn->core, &rcvd, conn->timeout);
-
-        if (gu_unlikely(ret <= 0)) {
+        if (GCS_ACT_INCONSISTENCY == rcvd.act.type) {
+            /* In the case of inconsistency our concern is to report it to
+             * replicator ASAP. Current contents of the slave queue are
+             * meaningless. */
+            gu_fifo_clear(conn->recv_q);
+        }
 
-            gu_debug ("gcs_core_recv returned %d: %s", ret, strerror(-ret));
+        struct gcs_recv_act* err_act =
+            (struct gcs_recv_act*) gu_fifo_get_tail(conn->recv_q);
 
-            if (-ETIMEDOUT == ret && _handle_timeout(conn)) continue;
+        if (gu_likely(NULL != err_act)) {
+            err_act->rcvd     = rcvd;
+            err_act->local_id = GCS_SEQNO_ILL;
 
-            assert (NULL          == rcvd.act.buf);
-            assert (0             == rcvd.act.buf_len);
-            assert (GCS_ACT_ERROR == rcvd.act.type ||
-                    GCS_ACT_INCONSISTENCY == rcvd.act.type);
-            assert (GCS_SEQNO_ILL == rcvd.id);
+            GCS_FIFO_PUSH_TAIL (conn, err_act);
+        }
 
-            if (GCS_ACT_INCONSISTENCY == rcvd.act.type) {
-                /* In the case of inconsistency our concern is to report it to
-                 * replicator ASAP. Current contents of the slave queue are
-                 * meaningless. */
-                gu_fifo_clear(conn->recv_q);
-            }
+        return (ret < 0 ? ret : -ECONNABORTED);
+    }
 
-            struct gcs_recv_act* err_act =
-                (struct gcs_recv_act*) gu_fifo_get_tail(conn->recv_q);
+//    gu_info ("Received action type: %d, size: %d, global seqno: %lld",
+//             act_type, act_size, (long long)act_id);
 
-            err_act->rcvd     = rcvd;
-            err_act->local_id = GCS_SEQNO_ILL;
+    assert (rcvd.act.type < GCS_ACT_ERROR);
+    assert (ret == rcvd.act.buf_len);
 
-            GCS_FIFO_PUSH_TAIL (conn, rcvd.act.buf_len);
+    if (gu_unlikely(rcvd.act.type >= GCS_ACT_STATE_REQ)) {
+        ret = gcs_handle_actions (conn, &rcvd);
 
-            break;
+        if (gu_unlikely(ret < 0)) {         // error
+            gu_debug ("gcs_handle_actions returned %ld: %s",
+                      ret, strerror(-ret));
+            return ret;
         }
 
-//        gu_info ("Received action type: %d, size: %d, global seqno: %lld",
-//                 act_type, act_size, (long long)act_id);
+        if (gu_likely(ret <= 0)) return 0; // not for application
+    }
+
+    /* deliver to application (note matching assert in the bottom-half of
+     * gcs_repl()) */
+    if (gu_likely (rcvd.act.type != GCS_ACT_TORDERED ||
+                   (rcvd.id > 0 && (conn->global_seqno = rcvd.id)))) {
+        /* successful delivery - increment local order */
+        this_act_id = gu_atomic_fetch_and_add(&conn->local_act_id, 1);
+    }
+
+    if (NULL != rcvd.local                                          &&
+        (repl_act_ptr = (struct gcs_repl_act**)
+         gcs_fifo_lite_get_head (conn->repl_q))                     &&
+        (gu_likely ((*repl_act_ptr)->act_in == rcvd.local)  ||
+         /* at this point repl_q is locked and we need to unlock it and
+          * return false to fall to the 'else' branch; unlikely case */
+         (gcs_fifo_lite_release (conn->repl_q), false)))
+    {
+        /* local action from repl_q */
+        struct gcs_repl_act* repl_act = *repl_act_ptr;
+        gcs_fifo_lite_pop_head (conn->repl_q);
+
+        assert (repl_act->action->type == rcvd.act.type);
+        assert (repl_act->action->size == rcvd.act.buf_len ||
+                repl_act->action->type == GCS_ACT_STATE_REQ);
+
+        repl_act->action->buf     = rcvd.act.buf;
+        repl_act->action->seqno_g = rcvd.id;
+        repl_act->action->seqno_l = this_act_id;
+
+        gu_mutex_lock   (&repl_act->wait_mutex);
+        repl_act->delivered = true;
+        gu_cond_signal  (&repl_act->wait_cond);
+        gu_mutex_unlock (&repl_act->wait_mutex);
+    }
+    else if (gu_likely(this_act_id >= 0))
+    {
+        /* remote/non-repl'ed action */
+        struct gcs_recv_act* recv_act =
+            (struct gcs_recv_act*)gu_fifo_get_tail (conn->recv_q);
+
+        if (gu_likely (NULL != recv_act)) {
 
-        assert (rcvd.act.type < GCS_ACT_ERROR);
-        assert (ret == rcvd.act.buf_len);
+            recv_act->rcvd     = rcvd;
+            recv_act->local_id = this_act_id;
 
-        if (gu_unlikely(rcvd.act.type >= GCS_ACT_STATE_REQ)) {
-            ret = gcs_handle_actions (conn, &rcvd);
+            conn->queue_len = gu_fifo_length (conn->recv_q) + 1;
+            bool const send_stop(gcs_fc_stop_begin(conn));
+            long long const pause(send_stop ? 0 : gcs_fc_pace_begin(conn));
 
-            if (gu_unlikely(ret < 0)) {         // error
-                gu_debug ("gcs_handle_actions returned %d: %s",
+            // release queue
+            GCS_FIFO_PUSH_TAIL (conn, recv_act);
+
+            if (gu_unlikely(GCS_CONN_JOINER == conn->state && !send_stop)) {
+                ret = _check_recv_queue_growth (conn, rcvd.act.buf_len);
+                assert (ret <= 0);
+                if (ret < 0) return ret;
+            }
+
+            if (gu_unlikely(send_stop) && (ret = gcs_fc_stop_end(conn))) {
+                gu_error ("gcs_fc_stop() returned %ld: %s",
                           ret, strerror(-ret));
-                break;
+                return ret;
             }
 
-            if (gu_likely(ret <= 0)) continue; // not for application
+            if (gu_unlikely(pause > 0) &&
+                (ret = gcs_fc_pace_end(conn, pause))) {
+                gu_error ("gcs_fc_pace() returned %ld: %s",
+                          ret, strerror(-ret));
+                return ret;
+            }
         }
+        else {
+            assert (GCS_CONN_CLOSED == conn->state);
+            return -EBADFD;
+        }
+//        gu_info("Received foreign action of type %d, size %d, id=%llu, "
+//                "action %p", rcvd.act.type, rcvd.act.buf_len,
+//                this_act_id, rcvd.act.buf);
+    }
+    else if (conn->my_idx == rcvd.sender_idx)
+    {
+        gu_fatal("Protocol violation: unordered local action not in repl_q:"
+                 " { {%p, %zd, %s}, %ld, %lld }.",
+                 rcvd.act.buf, rcvd.act.buf_len,
+                 gcs_act_type_to_str(rcvd.act.type), rcvd.sender_idx,
+                 rcvd.id);
+        assert(0);
+        return -ENOTRECOVERABLE;
+    }
+    else
+    {
+        gu_fatal ("Protocol violation: unordered remote action: "
+                  "{ {%p, %zd, %s}, %ld, %lld }",
+                  rcvd.act.buf, rcvd.act.buf_len,
+                  gcs_act_type_to_str(rcvd.act.type), rcvd.sender_idx,
+                  rcvd.id);
+        assert (0);
+        return -ENOTRECOVERABLE;
+    }
 
-        /* deliver to application (note matching assert in the bottom-half of
-         * gcs_repl()) */
-        if (gu_likely (rcvd.act.type != GCS_ACT_TORDERED ||
-                       (rcvd.id > 0 && (conn->global_seqno = rcvd.id)))) {
-            /* successful delivery - increment local order */
-            this_act_id = gu_atomic_fetch_and_add(&conn->local_act_id, 1);
+    return 0;
+}
+
+/*
+ * gcs_disp_thread() dispatches actions received by gcs_recv_thread() in
+ * the order they were received. It also owns flow control timers.
+ */
+static void *gcs_disp_thread (void *arg)
+{
+    gcs_conn_t* conn = (gcs_conn_t*)arg;
+    long        ret  = 0;
+
+    for (;;)
+    {
+        struct gcs_disp_act act;
+        int                 err;
+
+        struct gcs_disp_act* const head((struct gcs_disp_act*)
+            gu_fifo_get_head_until (conn->disp_q, &err, conn->timeout));
+
+        if (gu_likely(NULL != head)) {
+            act = *head;
+            gu_fifo_pop_head (conn->disp_q);
+            conn->disp_lat->insert (gu_time_monotonic() - act.ts);
         }
+        else if (-ETIMEDOUT == err) {
+            /* timeout could have been moved while we were waiting */
+            if (conn->timeout > gu_time_calendar() || _handle_timeout(conn))
+                continue;
 
-        if (NULL != rcvd.local                                          &&
-            (repl_act_ptr = (struct gcs_repl_act**)
-             gcs_fifo_lite_get_head (conn->repl_q))                     &&
-            (gu_likely ((*repl_act_ptr)->act_in == rcvd.local)  ||
-             /* at this point repl_q is locked and we need to unlock it and
-              * return false to fall to the 'else' branch; unlikely case */
-             (gcs_fifo_lite_release (conn->repl_q), false)))
-        {
-            /* local action from repl_q */
-            struct gcs_repl_act* repl_act = *repl_act_ptr;
-            gcs_fifo_lite_pop_head (conn->repl_q);
+            act.rcvd = gcs_act_rcvd();
+            act.ret  = -ETIMEDOUT;
+        }
+        else {
+            assert (-ENODATA == err); // closed by gcs_recv_thread()
+            break;
+        }
 
-            assert (repl_act->action->type == rcvd.act.type);
-            assert (repl_act->action->size == rcvd.act.buf_len ||
-                    repl_act->action->type == GCS_ACT_STATE_REQ);
+        if (gu_unlikely((ret = gcs_dispatch (conn, act.rcvd, act.ret)) < 0)) {
+            /* release gcs_recv_thread() and repl_q waiters */
+            (void)_close(conn, false);
+            break;
+        }
 
-            repl_act->action->buf     = rcvd.act.buf;
-            repl_act->action->seqno_g = rcvd.id;
-            repl_act->action->seqno_l = this_act_id;
+        gu_atomic_fetch_and_add (&conn->disp_done, 1);
 
-            gu_mutex_lock   (&repl_act->wait_mutex);
-            gu_cond_signal  (&repl_act->wait_cond);
-            gu_mutex_unlock (&repl_act->wait_mutex);
+        int wait;
+        gu_atomic_get (&conn->disp_wait, &wait);
+        if (gu_unlikely(wait)) {
+            gu_mutex_lock (&conn->disp_lock);
+            gu_cond_signal (&conn->disp_cond);
+            gu_mutex_unlock (&conn->disp_lock);
         }
-        else if (gu_likely(this_act_id >= 0))
-        {
-            /* remote/non-repl'ed action */
-            struct gcs_recv_act* recv_act =
-                (struct gcs_recv_act*)gu_fifo_get_tail (conn->recv_q);
+    }
 
-            if (gu_likely (NULL != recv_act)) {
+    gu_fifo_close (conn->disp_q);
 
-                recv_act->rcvd     = rcvd;
-                recv_act->local_id = this_act_id;
+    gu_mutex_lock (&conn->disp_lock);
+    conn->disp_err     = ret;
+    conn->disp_stopped = true;
+    gu_cond_signal (&conn->disp_cond);
+    gu_mutex_unlock (&conn->disp_lock);
 
-                conn->queue_len = gu_fifo_length (conn->recv_q) + 1;
-                bool const send_stop(gcs_fc_stop_begin(conn));
+    gu_debug ("DISP thread exiting %ld: %s", ret, strerror(-ret));
+    return NULL;
+}
 
-                // release queue
-                GCS_FIFO_PUSH_TAIL (conn, rcvd.act.buf_len);
+/* Waits until all actions pushed to disp_q are dispatched. Returns negative
+ * error code if gcs_disp_thread() has stopped. */
+static long
+gcs_disp_sync (gcs_conn_t* conn)
+{
+    long ret(0);
 
-                if (gu_unlikely(GCS_CONN_JOINER == conn->state && !send_stop)) {
-                    ret = _check_recv_queue_growth (conn, rcvd.act.buf_len);
-                    assert (ret <= 0);
-                    if (ret < 0) break;
-                }
+    gu_mutex_lock (&conn->disp_lock);
 
-                if (gu_unlikely(send_stop) && (ret = gcs_fc_stop_end(conn))) {
-                    gu_error ("gcs_fc_stop() returned %d: %s",
-                              ret, strerror(-ret));
-                    break;
-                }
-            }
-            else {
-                assert (GCS_CONN_CLOSED == conn->state);
-                ret = -EBADFD;
-                break;
+    int wait(1);
+    gu_atomic_set (&conn->disp_wait, &wait);
+
+    long done;
+    gu_atomic_get (&conn->disp_done, &done);
+
+    while (done < conn->disp_pushed && !conn->disp_stopped) {
+        gu_cond_wait (&conn->disp_cond, &conn->disp_lock);
+        gu_atomic_get (&conn->disp_done, &done);
+    }
+
+    wait = 0;
+    gu_atomic_set (&conn->disp_wait, &wait);
+
+    if (conn->disp_stopped) {
+        ret = conn->disp_err < 0 ? conn->disp_err : -ECONNABORTED;
+    }
+
+    gu_mutex_unlock (&conn->disp_lock);
+
+    return ret;
+}
+
+/*
+ * gcs_recv_thread() receives whatever actions arrive from group and passes
+ * them to gcs_disp_thread(), so that defragmentation and ordering of the
+ * next action overlap with the delivery of the previous one. Actions other
+ * than writesets change connection state, so the thread waits for them to
+ * be dispatched before receiving more.
+ */
+static void *gcs_recv_thread (void *arg)
+{
+    gcs_conn_t* conn = (gcs_conn_t*)arg;
+    long        ret  = -ECONNABORTED;
+
+    // To avoid race between gcs_open() and the following state check in while()
+    gu_cond_t tmp_cond; /* TODO: rework when concurrency in SM is allowed */
+    gu_cond_init (&tmp_cond, NULL);
+    gcs_sm_enter(conn->sm, &tmp_cond, false, true);
+    gcs_sm_leave(conn->sm);
+    gu_cond_destroy (&tmp_cond);
+
+    conn->disp_pushed  = 0;
+    conn->disp_done    = 0;
+    conn->disp_err     = 0;
+    conn->disp_stopped = false;
+    gu_fifo_open (conn->disp_q);
+
+    if ((ret = gu_thread_create (&conn->disp_thread, NULL, gcs_disp_thread,
+                                 conn))) {
+        gu_error ("Failed to create dispatch thread: %ld (%s)",
+                  ret, strerror(ret));
+        ret = -ret;
+        goto out;
+    }
+
+    while (conn->state < GCS_CONN_CLOSED)
+    {
+        struct gcs_disp_act act;
+
+        act.ret = gcs_core_recv (conn->core, &act.rcvd, GU_TIME_ETERNITY);
+        act.ts  = gu_time_monotonic();
+
+        struct gcs_disp_act* const tail((struct gcs_disp_act*)
+                                        gu_fifo_get_tail (conn->disp_q));
+
+        if (gu_unlikely(NULL == tail)) {
+            /* gcs_disp_thread() has stopped, the action won't be
+             * dispatched */
+            if (act.ret > 0 && GCS_ACT_TORDERED == act.rcvd.act.type &&
+                act.rcvd.act.buf) {
+                gcs_gcache_free (conn->gcache, act.rcvd.act.buf);
             }
-//            gu_info("Received foreign action of type %d, size %d, id=%llu, "
-//                    "action %p", rcvd.act.type, rcvd.act.buf_len,
-//                    this_act_id, rcvd.act.buf);
-        }
-        else if (conn->my_idx == rcvd.sender_idx)
-        {
-            gu_fatal("Protocol violation: unordered local action not in repl_q:"
-                     " { {%p, %zd, %s}, %ld, %lld }.",
-                     rcvd.act.buf, rcvd.act.buf_len,
-                     gcs_act_type_to_str(rcvd.act.type), rcvd.sender_idx,
-                     rcvd.id);
-            assert(0);
-            ret = -ENOTRECOVERABLE;
+            ret = gcs_disp_sync (conn);
             break;
         }
-        else
-        {
-            gu_fatal ("Protocol violation: unordered remote action: "
-                      "{ {%p, %zd, %s}, %ld, %lld }",
-                      rcvd.act.buf, rcvd.act.buf_len,
-                      gcs_act_type_to_str(rcvd.act.type), rcvd.sender_idx,
-                      rcvd.id);
-            assert (0);
-            ret = -ENOTRECOVERABLE;
+
+        *tail = act;
+        gu_fifo_push_tail (conn->disp_q);
+        conn->disp_pushed++;
+
+        if (gu_unlikely(act.ret <= 0 ||
+                        GCS_ACT_TORDERED != act.rcvd.act.type) &&
+            (ret = gcs_disp_sync (conn)) < 0) {
             break;
         }
-    }
 
-    if (ret > 0) {
         ret = 0;
     }
-    else if (ret < 0)
+
+    gu_fifo_close (conn->disp_q);
+    gu_thread_join (conn->disp_thread, NULL);
+    gu_fifo_clear (conn->disp_q); // left over on error
+
+out:
+    if (ret < 0)
     {
         /* In case of error call _close() to release repl_q waiters. */
         (void)_close(conn, false);
         gcs_shift_state (conn, GCS_CONN_CLOSED);
     }
-    gu_info ("RECV thread exiting %d: %s", ret, strerror(-ret));
+    gu_info ("RECV thread exiting %ld: %s", ret, strerror(-ret));
     return NULL;
 }
 
@@ -1551,6 +1834,7 @@ long gcs_destroy (gcs_conn_t *conn)
         // We should still cleanup resources
     }
 
+    gu_fifo_destroy (conn->disp_q);
     gu_fifo_destroy (conn->recv_q);
 
     gu_cond_destroy (&tmp_cond);
@@ -1568,6 +1852,11 @@ long gcs_destroy (gcs_conn_t *conn)
 
     /* This must not last for long */
     while (gu_mutex_destroy (&conn->fc_lock));
+    while (gu_mutex_destroy (&conn->disp_lock));
+    gu_cond_destroy (&conn->disp_cond);
+
+    delete conn->disp_lat;
+    delete conn->recv_q_lat;
 
     _cleanup_params (conn);
 
@@ -1576,6 +1865,30 @@ long gcs_destroy (gcs_conn_t *conn)
     return 0;
 }
 
+struct gcs_send_ctx
+{
+    gcs_conn_t*          conn;
+    const struct gu_buf* act_bufs;
+    size_t               act_size;
+    gcs_act_type_t       act_type;
+};
+
+/* Sends action from inside the send monitor, maybe on behalf of another
+ * thread, see gcs_sm_job_t */
+static long
+_send_action (void* const arg)
+{
+    const gcs_send_ctx* const ctx(static_cast<const gcs_send_ctx*>(arg));
+    gcs_conn_t* const conn(ctx->conn);
+    long ret = -ENOTCONN;
+
+    while ((GCS_CONN_OPEN >= conn->state) &&
+           (ret = gcs_core_send (conn->core, ctx->act_bufs,
+                                 ctx->act_size, ctx->act_type)) == -ERESTART);
+
+    return ret;
+}
+
 /* Puts action in the send queue and returns */
 long gcs_sendv (gcs_conn_t*          const conn,
                 const struct gu_buf* const act_bufs,
@@ -1587,20 +1900,29 @@ long gcs_sendv (gcs_conn_t*          const conn,
 
     long ret = -ENOTCONN;
 
+    gcs_send_ctx ctx = { conn, act_bufs, act_size, act_type };
+    gcs_sm_job_t job = { _send_action, NULL, &ctx, act_size, 0, false,
+                         false };
+
     /*! locking connection here to avoid race with gcs_close()
      *  @note: gcs_repl() and gcs_recv() cannot lock connection
      *         because they block indefinitely waiting for actions */
     gu_cond_t tmp_cond;
     gu_cond_init (&tmp_cond, NULL);
 
-    if (!(ret = gcs_sm_enter (conn->sm, &tmp_cond, scheduled, true)))
+    ret = gcs_sm_enter (conn->sm, &tmp_cond, scheduled, true, &job);
+
+    if (!ret)
     {
-        while ((GCS_CONN_OPEN >= conn->state) &&
-               (ret = gcs_core_send (conn->core, act_bufs,
-                                     act_size, act_type)) == -ERESTART);
+        ret = _send_action (&ctx);
         gcs_sm_leave (conn->sm);
-        gu_cond_destroy (&tmp_cond);
     }
+    else if (1 == ret)
+    {
+        ret = job.ret;
+    }
+
+    gu_cond_destroy (&tmp_cond);
 
     return ret;
 }
@@ -1626,6 +1948,150 @@ fc_active(gcs_conn_t* conn)
     return conn->stop_count > 0;
 }
 
+struct gcs_repl_ctx
+{
+    gcs_conn_t*          conn;
+    struct gcs_repl_act* repl_act;
+};
+
+/* Queues replicated action for delivery and sends it from inside the send
+ * monitor, maybe on behalf of another thread, see gcs_sm_job_t */
+static long
+_repl_action (void* const arg)
+{
+    const gcs_repl_ctx* const ctx(static_cast<const gcs_repl_ctx*>(arg));
+    gcs_conn_t*          const conn    (ctx->conn);
+    struct gcs_repl_act* const repl_act(ctx->repl_act);
+    const struct gu_buf* const act_in  (repl_act->act_in);
+    struct gcs_action*   const act     (repl_act->action);
+    struct gcs_repl_act** act_ptr;
+    long ret;
+
+    // some hack here to achieve one if() instead of two:
+    // ret = -EAGAIN part is a workaround for #569
+    // if (conn->state >= GCS_CONN_CLOSE) or (act_ptr == NULL)
+    // ret will be -ENOTCONN
+    if ((ret = -EAGAIN,
+         !fc_active(conn) || act->type != GCS_ACT_TORDERED) &&
+        (ret = -ENOTCONN, GCS_CONN_OPEN >= conn->state)     &&
+        (act_ptr = (struct gcs_repl_act**)gcs_fifo_lite_get_tail (conn->repl_q)))
+    {
+        *act_ptr = repl_act;
+        gcs_fifo_lite_push_tail (conn->repl_q);
+
+        // Keep on trying until something else comes out
+        while ((ret = gcs_core_send (conn->core, act_in, act->size,
+                                     act->type)) == -ERESTART) {}
+
+        if (ret < 0) {
+            /* remove item from the queue, it will never be delivered */
+            gu_warn ("Send action {%p, %zd, %s} returned %d (%s)",
+                     act->buf, act->size,gcs_act_type_to_str(act->type),
+                     ret, strerror(-ret));
+
+            if (!gcs_fifo_lite_remove (conn->repl_q)) {
+                gu_fatal ("Failed to remove unsent item from repl_q");
+                assert(0);
+                ret = -ENOTRECOVERABLE;
+            }
+        }
+        else {
+            assert (ret == (ssize_t)act->size);
+        }
+    }
+
+    return ret;
+}
+
+/* Queues a group of actions for delivery and sends them in a single message.
+ * @return 0 on success or negative error code, none of the actions was sent */
+static long
+_repl_aggr (gcs_conn_t* const conn, gcs_sm_job_t** const jobs, long const n)
+{
+    gcs_core_act_t acts[GCS_SM_COMBINE_MAX];
+    long i;
+    long ret;
+
+    for (i = 0; i < n; i++) {
+        const gcs_repl_ctx* const ctx(static_cast<gcs_repl_ctx*>(jobs[i]->ctx));
+        struct gcs_repl_act** const act_ptr(
+            (struct gcs_repl_act**)gcs_fifo_lite_get_tail (conn->repl_q));
+
+        if (!act_ptr) break;
+
+        *act_ptr = ctx->repl_act;
+        gcs_fifo_lite_push_tail (conn->repl_q);
+
+        acts[i].act      = ctx->repl_act->act_in;
+        acts[i].act_size = ctx->repl_act->action->size;
+        acts[i].act_type = ctx->repl_act->action->type;
+    }
+
+    if (gu_likely(i == n)) {
+        while ((ret = gcs_core_send_aggr (conn->core, acts, n)) == -ERESTART)
+        {}
+    }
+    else {
+        ret = -ENOTCONN;
+    }
+
+    if (ret < 0) {
+        /* remove items from the queue, they will never be delivered */
+        while (i-- > 0) {
+            if (!gcs_fifo_lite_remove (conn->repl_q)) {
+                gu_fatal ("Failed to remove unsent item from repl_q");
+                assert(0);
+                ret = -ENOTRECOVERABLE;
+            }
+        }
+        return ret;
+    }
+
+    return 0;
+}
+
+/* Sends replicated actions in as few messages as gcs.aggregate_size and group
+ * protocol allow, see gcs_sm_job_t */
+static void
+_repl_batch (gcs_sm_job_t** const jobs, long const n)
+{
+    gcs_conn_t* const conn(static_cast<gcs_repl_ctx*>(jobs[0]->ctx)->conn);
+    long begin(0);
+
+    while (begin < n) {
+        size_t const limit(std::min<size_t>(conn->params.aggregate_size,
+                                            gcs_core_aggr_limit(conn->core)));
+        size_t size(GCS_ACT_PROTO_AGGR_HDR_SIZE + jobs[begin]->size);
+        long   end(begin + 1);
+
+        while (end < n &&
+               size + GCS_ACT_PROTO_AGGR_HDR_SIZE + jobs[end]->size <= limit) {
+            size += GCS_ACT_PROTO_AGGR_HDR_SIZE + jobs[end]->size;
+            end++;
+        }
+
+        if (end - begin < 2 || fc_active(conn) || GCS_CONN_OPEN < conn->state) {
+            /* single action or an error, take the usual route */
+            jobs[begin]->ret = _repl_action (jobs[begin]->ctx);
+            begin++;
+            continue;
+        }
+
+        long const ret(_repl_aggr (conn, jobs + begin, end - begin));
+
+        if (-EPROTONOSUPPORT == ret || -EMSGSIZE == ret) {
+            /* group protocol or packet size changed, try again */
+            continue;
+        }
+
+        for (; begin < end; begin++) {
+            jobs[begin]->ret = ret < 0 ? ret :
+                static_cast<gcs_repl_ctx*>(jobs[begin]->ctx)->repl_act->
+                action->size;
+        }
+    }
+}
+
 /* Puts action in the send queue and returns after it is replicated */
 long gcs_replv (gcs_conn_t*          const conn,      //!<in
                 const struct gu_buf* const act_in,    //!<in
@@ -1645,108 +2111,93 @@ long gcs_replv (gcs_conn_t*          const conn,      //!<in
     /* This is good - we don't have to do a copy because we wait */
     struct gcs_repl_act repl_act(act_in, act);
 
+    gcs_repl_ctx ctx = { conn, &repl_act };
+    gcs_sm_job_t job = { _repl_action,
+                         GCS_ACT_TORDERED == act->type ? _repl_batch : NULL,
+                         &ctx, size_t(act->size), 0, false, false };
+
     gu_mutex_init (&repl_act.wait_mutex, NULL);
     gu_cond_init  (&repl_act.wait_cond,  NULL);
 
-    /* Send action and wait for signal from recv_thread
-     * we need to lock a mutex before we can go wait for signal */
-    if (!(ret = gu_mutex_lock (&repl_act.wait_mutex)))
+    /* The thread in the send monitor may send actions of the threads queued
+     * behind it, so an action can be delivered while its thread still waits
+     * in the monitor queue. Hence a separate condition for the monitor. */
+    gu_cond_t send_cond;
+    gu_cond_init  (&send_cond, NULL);
+
+    // Send monitor does the following:
+    // 1. serializes gcs_core_send() access between gcs_repl() and
+    //    gcs_send()
+    // 2. avoids race with gcs_close() and gcs_destroy()
+    // wait_mutex is not held here, otherwise recv thread would block on it
+    // while the sends of other threads are being done.
+    ret = gcs_sm_enter (conn->sm, &send_cond, scheduled, true, &job);
+
+    if (ret >= 0)
     {
-        // Lock here does the following:
-        // 1. serializes gcs_core_send() access between gcs_repl() and
-        //    gcs_send()
-        // 2. avoids race with gcs_close() and gcs_destroy()
-        if (!(ret = gcs_sm_enter (conn->sm, &repl_act.wait_cond, scheduled, true)))
-        {
-            struct gcs_repl_act** act_ptr;
-
 //#ifndef NDEBUG
-            const void* const orig_buf = act->buf;
+        const void* const orig_buf = act->buf;
 //#endif
-
-            // some hack here to achieve one if() instead of two:
-            // ret = -EAGAIN part is a workaround for #569
-            // if (conn->state >= GCS_CONN_CLOSE) or (act_ptr == NULL)
-            // ret will be -ENOTCONN
-            if ((ret = -EAGAIN,
-                 !fc_active(conn) || act->type != GCS_ACT_TORDERED) &&
-                (ret = -ENOTCONN, GCS_CONN_OPEN >= conn->state)     &&
-                (act_ptr = (struct gcs_repl_act**)gcs_fifo_lite_get_tail (conn->repl_q)))
-            {
-                *act_ptr = &repl_act;
-                gcs_fifo_lite_push_tail (conn->repl_q);
-
-                // Keep on trying until something else comes out
-                while ((ret = gcs_core_send (conn->core, act_in, act->size,
-                                             act->type)) == -ERESTART) {}
-
-                if (ret < 0) {
-                    /* remove item from the queue, it will never be delivered */
-                    gu_warn ("Send action {%p, %zd, %s} returned %d (%s)",
-                             act->buf, act->size,gcs_act_type_to_str(act->type),
-                             ret, strerror(-ret));
-
-                    if (!gcs_fifo_lite_remove (conn->repl_q)) {
-                        gu_fatal ("Failed to remove unsent item from repl_q");
-                        assert(0);
-                        ret = -ENOTRECOVERABLE;
-                    }
-                }
-                else {
-                    assert (ret == (ssize_t)act->size);
-                }
-            }
-
+        if (1 == ret) {
+            /* action was sent by the thread ahead in the send queue */
+            ret = job.ret;
+        }
+        else {
+            ret = _repl_action (&ctx);
             gcs_sm_leave (conn->sm);
+        }
 
-            assert(ret);
+        assert(ret);
 
-            /* now we can go waiting for action delivery */
-            if (ret >= 0) {
+        /* now we can go waiting for action delivery */
+        if (ret >= 0) {
+            gu_mutex_lock (&repl_act.wait_mutex);
+            while (!repl_act.delivered) {
                 gu_cond_wait (&repl_act.wait_cond, &repl_act.wait_mutex);
+            }
+            gu_mutex_unlock (&repl_act.wait_mutex);
 #ifndef GCS_FOR_GARB
-                /* assert (act->buf != 0); */
-                if (act->buf == 0)
-                {
-                    /* Recv thread purged repl_q before action was delivered */
-                    ret = -ENOTCONN;
-                    goto out;
-                }
+            /* assert (act->buf != 0); */
+            if (act->buf == 0)
+            {
+                /* Recv thread purged repl_q before action was delivered */
+                ret = -ENOTCONN;
+                goto out;
+            }
 #else
-                assert (act->buf == 0);
+            assert (act->buf == 0);
 #endif /* GCS_FOR_GARB */
 
-                if (act->seqno_g < 0) {
-                    assert (GCS_SEQNO_ILL    == act->seqno_l ||
-                            GCS_ACT_TORDERED != act->type);
-
-                    if (act->seqno_g == GCS_SEQNO_ILL) {
-                        /* action was not replicated for some reason */
-                        assert (orig_buf == act->buf);
-                        ret = -EINTR;
-                    }
-                    else {
-                        /* core provided an error code in global seqno */
-                        assert (orig_buf != act->buf);
-                        ret = act->seqno_g;
-                        act->seqno_g = GCS_SEQNO_ILL;
-                    }
-
-                    if (orig_buf != act->buf) // action was allocated in gcache
-                    {
-                        gu_debug("Freeing gcache buffer %p after receiving %d",
-                                 act->buf, ret);
-                        gcs_gcache_free (conn->gcache, act->buf);
-                        act->buf = orig_buf;
-                    }
+            if (act->seqno_g < 0) {
+                assert (GCS_SEQNO_ILL    == act->seqno_l ||
+                        GCS_ACT_TORDERED != act->type);
+
+                if (act->seqno_g == GCS_SEQNO_ILL) {
+                    /* action was not replicated for some reason */
+                    assert (orig_buf == act->buf);
+                    ret = -EINTR;
+                }
+                else {
+                    /* core provided an error code in global seqno */
+                    assert (orig_buf != act->buf);
+                    ret = act->seqno_g;
+                    act->seqno_g = GCS_SEQNO_ILL;
+                }
+
+                if (orig_buf != act->buf) // action was allocated in gcache
+                {
+                    gu_debug("Freeing gcache buffer %p after receiving %d",
+                             act->buf, ret);
+                    gcs_gcache_free (conn->gcache, act->buf);
+                    act->buf = orig_buf;
                 }
             }
         }
+    }
 #ifndef GCS_FOR_GARB
-    out:
+out:
 #endif /* GCS_FOR_GARB */
-        gu_mutex_unlock  (&repl_act.wait_mutex);
-    }
+    gu_cond_destroy  (&send_cond);
     gu_mutex_destroy (&repl_act.wait_mutex);
     gu_cond_destroy  (&repl_act.wait_cond);
 
@@ -1886,7 +2337,10 @@ long gcs_recv (gcs_conn_t*        conn,
 
     if ((recv_act = (struct gcs_recv_act*)gu_fifo_get_head (conn->recv_q, &err)))
     {
+        conn->recv_q_lat->insert (gu_time_monotonic() - recv_act->ts);
+
         conn->queue_len = gu_fifo_length (conn->recv_q) - 1;
+        gcs_fc_rate_applied (&conn->rfc, conn->queue_len, gu_time_monotonic());
         bool send_cont  = gcs_fc_cont_begin   (conn);
         bool send_sync  = gcs_send_sync_begin (conn);
 
@@ -2073,6 +2527,8 @@ gcs_get_stats (gcs_conn_t* conn, struct gcs_stats* stats)
     stats->fc_received = conn->stats_fc_received;
     stats->fc_active   = fc_active(conn);
     stats->fc_requested= conn->stop_sent_ > 0;
+    stats->fc_lower_limit = conn->lower_limit;
+    stats->fc_upper_limit = conn->upper_limit;
 }
 
 void
@@ -2083,6 +2539,8 @@ gcs_flush_stats(gcs_conn_t* conn)
     conn->stats_fc_stop_sent = 0;
     conn->stats_fc_cont_sent = 0;
     conn->stats_fc_received  = 0;
+    conn->disp_lat->clear();
+    conn->recv_q_lat->clear();
 }
 
 void gcs_get_status(gcs_conn_t* conn, gu::Status& status)
@@ -2091,6 +2549,9 @@ void gcs_get_status(gcs_conn_t* conn, gu::Status& status)
     {
         gcs_core_get_status(conn->core, status);
     }
+
+    status.insert("gcs_dispatch_latency", conn->disp_lat->to_string());
+    status.insert("gcs_recv_q_latency", conn->recv_q_lat->to_string());
 }
 
 static long
@@ -2117,7 +2578,7 @@ _set_fc_limit (gcs_conn_t* conn, const char* value)
                 abort();
             }
         }
-        gu_fifo_release (conn->recv_q);
+        gu_fifo_release(conn->recv_q);
 
         return 0;
     }
@@ -2150,7 +2611,7 @@ _set_fc_factor (gcs_conn_t* conn, const char* value)
                 abort();
             }
         }
-        gu_fifo_release (conn->recv_q);
+        gu_fifo_release(conn->recv_q);
 
         return 0;
     }
@@ -2171,6 +2632,7 @@ _set_fc_debug (gcs_conn_t* conn, const char* value)
 
         conn->params.fc_debug = debug;
         gcs_fc_debug (&conn->stfc, debug);
+        gcs_fc_rate_debug (&conn->rfc, debug);
         gu_config_set_bool (conn->config, GCS_PARAMS_FC_DEBUG, debug);
 
         return 0;
@@ -2180,6 +2642,103 @@ _set_fc_debug (gcs_conn_t* conn, const char* value)
     }
 }
 
+static long
+_set_fc_rate (gcs_conn_t* conn, const char* value)
+{
+    bool rate;
+    const char* const endptr = gu_str2bool(value, &rate);
+
+    if (*endptr != '\0') return -EINVAL;
+
+    if (conn->params.fc_rate != rate) {
+
+        gu_fifo_lock(conn->recv_q);
+        {
+            conn->params.fc_rate = rate;
+            /* start measurements afresh */
+            gcs_fc_rate_init (&conn->rfc, conn->rfc.soft_limit,
+                              conn->rfc.hard_limit, gu_time_monotonic());
+            gcs_fc_rate_debug (&conn->rfc, conn->params.fc_debug);
+        }
+        gu_fifo_release(conn->recv_q);
+
+        gu_config_set_bool (conn->config, GCS_PARAMS_FC_RATE, rate);
+    }
+
+    return 0;
+}
+
+static long
+_set_aggregate_size (gcs_conn_t* conn, const char* value)
+{
+    long long size;
+    const char* const endptr = gu_str2ll (value, &size);
+
+    if (size >= 0 && *endptr == '\0') {
+
+        if (size > LONG_MAX) size = LONG_MAX;
+
+        if (conn->params.aggregate_size == size) return 0;
+
+        gu_config_set_int64 (conn->config, GCS_PARAMS_AGGREGATE_SIZE, size);
+        conn->params.aggregate_size = size;
+        gcs_sm_set_batch (conn->sm, conn->params.aggregate_size,
+                          conn->params.aggregate_delay * 1000LL);
+
+        return 0;
+    }
+    else {
+        return -EINVAL;
+    }
+}
+
+static long
+_set_aggregate_delay (gcs_conn_t* conn, const char* value)
+{
+    long long delay;
+    const char* const endptr = gu_str2ll (value, &delay);
+
+    if (delay >= 0 && *endptr == '\0') {
+
+        if (delay > LONG_MAX / 1000) delay = LONG_MAX / 1000;
+
+        if (conn->params.aggregate_delay == delay) return 0;
+
+        gu_config_set_int64 (conn->config, GCS_PARAMS_AGGREGATE_DELAY, delay);
+        conn->params.aggregate_delay = delay;
+        gcs_sm_set_batch (conn->sm, conn->params.aggregate_size,
+                          conn->params.aggregate_delay * 1000LL);
+
+        return 0;
+    }
+    else {
+        return -EINVAL;
+    }
+}
+
+static long
+_set_frag_time (gcs_conn_t* conn, const char* value)
+{
+    long long frag_time;
+    const char* const endptr = gu_str2ll (value, &frag_time);
+
+    if (frag_time >= 0 && *endptr == '\0') {
+
+        if (frag_time > LONG_MAX / 1000) frag_time = LONG_MAX / 1000;
+
+        if (conn->params.frag_time == frag_time) return 0;
+
+        gu_config_set_int64 (conn->config, GCS_PARAMS_FRAG_TIME, frag_time);
+        conn->params.frag_time = frag_time;
+        gcs_core_set_frag_time (conn->core, conn->params.frag_time * 1000LL);
+
+        return 0;
+    }
+    else {
+        return -EINVAL;
+    }
+}
+
 static long
 _set_sync_donor (gcs_conn_t* conn, const char* value)
 {
@@ -2305,6 +2864,9 @@ long gcs_param_set  (gcs_conn_t* conn, const char* key, const char *value)
     else if (!strcmp (key, GCS_PARAMS_FC_DEBUG)) {
         return _set_fc_debug (conn, value);
     }
+    else if (!strcmp (key, GCS_PARAMS_FC_RATE)) {
+        return _set_fc_rate (conn, value);
+    }
     else if (!strcmp (key, GCS_PARAMS_SYNC_DONOR)) {
         return _set_sync_donor (conn, value);
     }
@@ -2320,6 +2882,15 @@ long gcs_param_set  (gcs_conn_t* conn, const char* key, const char *value)
     else if (!strcmp (key, GCS_PARAMS_MAX_THROTTLE)) {
         return _set_max_throttle (conn, value);
     }
+    else if (!strcmp (key, GCS_PARAMS_AGGREGATE_SIZE)) {
+        return _set_aggregate_size (conn, value);
+    }
+    else if (!strcmp (key, GCS_PARAMS_AGGREGATE_DELAY)) {
+        return _set_aggregate_delay (conn, value);
+    }
+    else if (!strcmp (key, GCS_PARAMS_FRAG_TIME)) {
+        return _set_frag_time (conn, value);
+    }
 #ifdef GCS_SM_DEBUG
     else if (!strcmp (key, GCS_PARAMS_SM_DUMP)) {
         gcs_sm_dump_state(conn->sm, stderr);
@@ -436,6 +436,8 @@ struct gcs_stats
     int       send_q_len;     //! current send queue length
     int       send_q_len_max; //! maximum send queue length
     int       send_q_len_min; //! minimum send queue length
+    long      fc_lower_limit; //! recv queue length to resume replication at
+    long      fc_upper_limit; //! recv queue length to stop replication at
     bool      fc_active;      //! flow control is currently active
     bool      fc_requested;   //! flow control is requested by this node
 };
@@ -5,7 +5,7 @@
  */
 /*
  * Interface to action protocol
- * (to be extended to support protocol versions, currently supports only v0)
+ * (v1 adds aggregated messages which carry several complete actions)
  */
 #include <errno.h>
 #include "gcs_act_proto.hpp"
@@ -22,10 +22,24 @@ bytes: 00 01                07 08       11 12       15 16       19 20
 PV - protocol version
 AT - action type
 
+  Version 1 header structure is the same, except for byte 17 which holds
+  flags. The only flag so far is AG - aggregated message. Such message is
+  always a single fragment, its act_id is the id of the first action and
+  act_size is the size of the whole payload, which is a sequence of complete
+  actions, each preceded by a header:
+
+bytes: 00       03 04 05    07 08
+      +--+--+--+--+--+--+--+--+--+--+---
+      | act_size  |AT|reserved|  data...
+      +--+--+--+--+--+--+--+--+--+--+---
+
+  Actions are assigned consecutive act_ids.
+
 */
 
 static const size_t PROTO_PV_OFFSET       = 0;
 static const size_t PROTO_AT_OFFSET       = 16;
+static const size_t PROTO_FLAGS_OFFSET    = 17;
 static const size_t PROTO_DATA_OFFSET     = 20;
 // static const size_t PROTO_ACT_ID_OFFSET   = 0;
 // static const size_t PROTO_ACT_SIZE_OFFSET = 8;
@@ -37,6 +51,10 @@ static const size_t PROTO_DATA_OFFSET     = 20;
 
 static const int PROTO_VERSION = GCS_ACT_PROTO_MAX;
 
+static const uint8_t PROTO_FLAG_AGGR = 0x01;
+
+static const size_t PROTO_AGGR_AT_OFFSET = 4;
+
 #define PROTO_MAX_HDR_SIZE PROTO_DATA_OFFSET // for now
 
 /*! Writes header data into actual header of the message.
@@ -71,6 +89,10 @@ gcs_act_proto_write (gcs_act_frag_t* frag, void* buf, size_t buf_len)
     ((uint8_t *)buf)[PROTO_PV_OFFSET] = frag->proto_ver;
     ((uint8_t *)buf)[PROTO_AT_OFFSET] = frag->act_type;
 
+    if (frag->proto_ver >= GCS_ACT_PROTO_AGGR_VER) {
+        ((uint8_t *)buf)[PROTO_FLAGS_OFFSET] = frag->aggr * PROTO_FLAG_AGGR;
+    }
+
     frag->frag     = (uint8_t*)buf + PROTO_DATA_OFFSET;
     frag->frag_len = buf_len - PROTO_DATA_OFFSET;
 
@@ -98,14 +120,25 @@ gcs_act_proto_read (gcs_act_frag_t* frag, const void* buf, size_t buf_len)
         return -EPROTO; // this fragment should be dropped
     }
 
-    ((uint8_t*)buf)[PROTO_PV_OFFSET] = 0x0;
-    frag->act_id   = gu_be64(*(uint64_t*)buf);
+    /* buffer may be shared with the backend, so the version byte is masked
+     * out of act_id rather than zeroed in place */
+    frag->act_id   = gu_be64(*(uint64_t*)buf) & GU_ULONG_LONG(0x00ffffffffffffff);
     frag->act_size = gtohl  (((uint32_t*)buf)[2]);
     frag->frag_no  = gtohl  (((uint32_t*)buf)[3]);
     frag->act_type = static_cast<gcs_act_type_t>(
         ((uint8_t*)buf)[PROTO_AT_OFFSET]);
     frag->frag     = ((uint8_t*)buf) + PROTO_DATA_OFFSET;
     frag->frag_len = buf_len - PROTO_DATA_OFFSET;
+    frag->aggr     = (frag->proto_ver >= GCS_ACT_PROTO_AGGR_VER &&
+                      (((uint8_t*)buf)[PROTO_FLAGS_OFFSET] & PROTO_FLAG_AGGR));
+
+    if (gu_unlikely(frag->aggr && (frag->frag_no != 0 ||
+                                   frag->frag_len != frag->act_size))) {
+        gu_error ("Malformed aggregated message: frag_no %lu, payload %zu, "
+                  "expected %zu", frag->frag_no, frag->frag_len,
+                  frag->act_size);
+        return -EBADMSG;
+    }
 
     /* return 0 or -EMSGSIZE */
     return ((frag->act_size > GCS_MAX_ACT_SIZE) * -EMSGSIZE);
@@ -122,3 +155,38 @@ gcs_act_proto_hdr_size (long version)
     return PROTO_DATA_OFFSET;
 }
 
+
+void
+gcs_act_proto_aggr_write (void* buf, size_t act_size, gcs_act_type_t act_type)
+{
+    ((uint32_t*)buf)[0] = htogl((uint32_t)act_size);
+    ((uint32_t*)buf)[1] = 0;
+    ((uint8_t *)buf)[PROTO_AGGR_AT_OFFSET] = act_type;
+}
+
+long
+gcs_act_proto_aggr_read (gcs_act_frag_t* frag, const void* buf, size_t buf_len)
+{
+    if (gu_unlikely(buf_len < GCS_ACT_PROTO_AGGR_HDR_SIZE)) {
+        gu_error ("Aggregated action header too short: %zu, expected %d",
+                  buf_len, GCS_ACT_PROTO_AGGR_HDR_SIZE);
+        return -EBADMSG;
+    }
+
+    frag->act_size = gtohl(((const uint32_t*)buf)[0]);
+    frag->act_type = static_cast<gcs_act_type_t>(
+        ((const uint8_t*)buf)[PROTO_AGGR_AT_OFFSET]);
+    frag->frag     = ((const uint8_t*)buf) + GCS_ACT_PROTO_AGGR_HDR_SIZE;
+    frag->frag_len = frag->act_size;
+    frag->frag_no  = 0;
+    frag->aggr     = false;
+
+    if (gu_unlikely(0 == frag->act_size ||
+                    frag->act_size > buf_len - GCS_ACT_PROTO_AGGR_HDR_SIZE)) {
+        gu_error ("Bad aggregated action size: %zu, %zu bytes left",
+                  frag->act_size, buf_len - GCS_ACT_PROTO_AGGR_HDR_SIZE);
+        return -EBADMSG;
+    }
+
+    return GCS_ACT_PROTO_AGGR_HDR_SIZE + frag->act_size;
+}
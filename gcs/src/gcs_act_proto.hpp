@@ -5,7 +5,7 @@
  */
 /*
  * Interface to action protocol
- * (to be extended to support protocol versions, currently supports only v0)
+ * (v1 adds aggregated messages which carry several complete actions)
  */
 
 #ifndef _gcs_act_proto_h_
@@ -17,8 +17,18 @@
 #include <stdint.h>
 typedef uint8_t gcs_proto_t;
 
-/*! Supported protocol range (for now only version 0 is supported) */
-#define GCS_ACT_PROTO_MAX 0
+/*! Supported protocol range */
+#define GCS_ACT_PROTO_MAX 2
+
+/*! First protocol version to support aggregated messages */
+#define GCS_ACT_PROTO_AGGR_VER 1
+
+/*! First protocol version to select state transfer donors by load
+ *  (wire format is the same as in version 1) */
+#define GCS_ACT_PROTO_DONOR_LOAD_VER 2
+
+/*! Size of the header preceding every action in aggregated message payload */
+#define GCS_ACT_PROTO_AGGR_HDR_SIZE 8
 
 /*! Internal action fragment data representation */
 typedef struct gcs_act_frag
@@ -30,6 +40,7 @@ typedef struct gcs_act_frag
     unsigned long  frag_no;
     gcs_act_type_t act_type;
     int            proto_ver;
+    bool           aggr;     // fragment is an aggregated message (v1+)
 }
 gcs_act_frag_t;
 
@@ -62,11 +73,24 @@ gcs_act_proto_inc (void* buf)
 extern long
 gcs_act_proto_hdr_size (long version);
 
+/*! Writes header of an action inside aggregated message payload.
+ *  Action data shall follow it. */
+extern void
+gcs_act_proto_aggr_write (void* buf, size_t act_size, gcs_act_type_t act_type);
+
+/*! Reads the next action from aggregated message payload. Sets act_size,
+ *  act_type and frag pointing at complete action data, act_id is left to the
+ *  caller.
+ *
+ * @return number of payload bytes consumed or negative error code */
+extern long
+gcs_act_proto_aggr_read (gcs_act_frag_t* frag, const void* buf, size_t buf_len);
+
 /*! Returns message protocol version */
 static inline int
-gcs_act_proto_ver (void* buf)
+gcs_act_proto_ver (const void* buf)
 {
-    return *((uint8_t*)buf);
+    return *((const uint8_t*)buf);
 }
 
 #endif /* _gcs_act_proto_h_ */
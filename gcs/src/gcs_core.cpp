@@ -24,6 +24,7 @@
 
 #include <string.h> // for mempcpy
 #include <errno.h>
+#include <sstream>
 
 bool
 gcs_core_register (gu_config_t* conf)
@@ -34,6 +35,16 @@ gcs_core_register (gu_config_t* conf)
 const size_t CORE_FIFO_LEN = (1 << 10); // 1024 elements (no need to have more)
 const size_t CORE_INIT_BUF_SIZE = (1 << 16); // 65K - IP packet size
 
+/* Adaptive fragmentation never makes fragments smaller than that */
+#ifndef GCS_CORE_TESTING
+const size_t CORE_FRAG_MIN = (1 << 12);
+#else
+const size_t CORE_FRAG_MIN = (1 << 9); // dummy backend packets are page-sized
+#endif
+/* Sent fragment size histogram buckets: up to 1K, 2K, ... 64K and above */
+const int    CORE_FRAG_HIST_MIN = 10;
+const int    CORE_FRAG_HIST_LEN = 8;
+
 typedef enum core_state
 {
     CORE_PRIMARY,
@@ -65,9 +76,18 @@ struct gcs_core
     void*           send_buf;
     size_t          send_buf_len;
     gcs_seqno_t     send_act_no;
+    long long       frag_time;  // target fragment send time (ns), 0 - static
+    double          send_rate;  // own fragments delivery rate (bytes/s)
+    long long       frag_hist[CORE_FRAG_HIST_LEN]; // sent fragment sizes
+    gcs_seqno_t     frag_act_id; // last delivered own fragmented action
+    long long       frag_ts;     // and when its last fragment was delivered
 
     /* recv part */
     gcs_recv_msg_t  recv_msg;
+    const uint8_t*  recv_aggr;      // next action in aggregated recv_msg
+    size_t          recv_aggr_left; // bytes left in aggregated recv_msg
+    gcs_seqno_t     recv_aggr_id;   // act_id of the next aggregated action
+    int             recv_aggr_ver;  // protocol version of aggregated recv_msg
 
     /* local action FIFO */
     gcs_fifo_lite_t* fifo;
@@ -102,7 +122,7 @@ typedef struct causal_act
     gu_cond_t*   cond;
 } causal_act_t;
 
-static int const GCS_PROTO_MAX = 0;
+static int const GCS_PROTO_MAX = 2;
 
 gcs_core_t*
 gcs_core_create (gu_config_t* const conf,
@@ -300,6 +320,89 @@ core_msg_send_retry (gcs_core_t*    core,
     return ret;
 }
 
+/* Accounts sent action fragment in the histogram */
+static inline void
+core_frag_sent (gcs_core_t* const core, size_t const frag_len)
+{
+    int i(0);
+    while (i < CORE_FRAG_HIST_LEN - 1 &&
+           frag_len > (size_t(1) << (CORE_FRAG_HIST_MIN + i))) ++i;
+
+    if (gu_mutex_lock (&core->send_lock)) abort();
+    core->frag_hist[i]++;
+    gu_mutex_unlock (&core->send_lock);
+}
+
+/* Measures the rate at which own action fragments are delivered.
+ * gcs_core_send() does not wait for delivery between fragments, so the
+ * interval between deliveries of consecutive fragments is the time it takes
+ * the group to deliver one, including flow control and other nodes' messages
+ * ordered in between. This is what matters for the other nodes, unlike the
+ * time backend send() takes to queue a fragment. */
+static inline void
+core_frag_rcvd (gcs_core_t* const core, const gcs_act_frag_t& frg)
+{
+    if (frg.act_size <= frg.frag_len) return; // not fragmented
+
+    long long const now(gu_time_monotonic());
+
+    if (gu_mutex_lock (&core->send_lock)) abort();
+
+    if (core->frag_time > 0 && frg.frag_no > 0 &&
+        frg.act_id == core->frag_act_id && frg.frag_len >= CORE_FRAG_MIN)
+    {
+        long long const interval(now - core->frag_ts);
+
+        if (interval > 0) {
+            double const rate(frg.frag_len * 1.0e9 / interval);
+            core->send_rate = core->send_rate > 0 ?
+                core->send_rate * 0.875 + rate * 0.125 : rate;
+        }
+    }
+
+    core->frag_act_id = frg.act_id;
+    core->frag_ts     = now;
+
+    gu_mutex_unlock (&core->send_lock);
+}
+
+/* Chooses fragment length for an action of a given size.
+ * Actions that fit in max_len are never fragmented. Bigger ones are split
+ * into fragments that take at most frag_time to deliver at the measured rate
+ * (so that other nodes' messages don't wait behind them for too long), but
+ * not smaller than CORE_FRAG_MIN, and the action is spread evenly between
+ * the fragments instead of leaving a short tail. */
+static inline size_t
+core_frag_len (gcs_core_t* const core, size_t const act_size,
+               size_t const max_len)
+{
+    if (act_size <= max_len) return max_len;
+
+    if (gu_mutex_lock (&core->send_lock)) abort();
+    long long const frag_time(core->frag_time);
+    double    const send_rate(core->send_rate);
+    gu_mutex_unlock (&core->send_lock);
+
+    if (0 == frag_time) return max_len;
+
+    size_t len(max_len);
+
+    if (send_rate > 0)
+    {
+        double const rate_len(send_rate * frag_time * 1.0e-9);
+
+        if (rate_len < len)
+        {
+            len = std::min(max_len,
+                           std::max(CORE_FRAG_MIN, size_t(rate_len)));
+        }
+    }
+
+    size_t const frags((act_size - 1) / len + 1);
+
+    return (act_size - 1) / frags + 1;
+}
+
 ssize_t
 gcs_core_send (gcs_core_t*          const conn,
                const struct gu_buf* const action,
@@ -330,10 +433,13 @@ gcs_core_send (gcs_core_t*          const conn,
     frg.act_id    = conn->send_act_no; /* incremented for every new action */
     frg.frag_no   = 0;
     frg.proto_ver = proto_ver;
+    frg.aggr      = false;
 
     if ((ret = gcs_act_proto_write (&frg, conn->send_buf, conn->send_buf_len)))
         return ret;
 
+    frg.frag_len = core_frag_len (conn, act_size, frg.frag_len);
+
     if ((local_act = (core_act_t*)gcs_fifo_lite_get_tail (conn->fifo))) {
         *local_act = (core_act_t){ conn->send_act_no, action, act_size };
         gcs_fifo_lite_push_tail (conn->fifo);
@@ -397,6 +503,8 @@ gcs_core_send (gcs_core_t*          const conn,
             sent     += ret;
             act_size -= ret;
 
+            core_frag_sent (conn, ret);
+
             if (gu_unlikely((size_t)ret < chunk_size)) {
                 /* Could not send all that was copied: */
 
@@ -457,6 +565,103 @@ out:
     return ret;
 }
 
+ssize_t
+gcs_core_send_aggr (gcs_core_t*           const conn,
+                    const gcs_core_act_t* const acts,
+                    int                   const acts_num)
+{
+    ssize_t        ret;
+    gcs_act_frag_t frg;
+    int const      proto_ver = conn->proto_ver;
+    long const     hdr_size  = gcs_act_proto_hdr_size (proto_ver);
+    size_t         payload   = 0;
+    int            i;
+
+    assert (acts_num > 0);
+
+    if (gu_unlikely(proto_ver < GCS_ACT_PROTO_AGGR_VER))
+        return -EPROTONOSUPPORT;
+
+    for (i = 0; i < acts_num; i++) {
+        assert (acts[i].act_size > 0);
+        payload += GCS_ACT_PROTO_AGGR_HDR_SIZE + acts[i].act_size;
+    }
+
+    if (gu_unlikely(hdr_size + payload > conn->send_buf_len)) return -EMSGSIZE;
+
+    frg.act_size  = payload;
+    frg.act_type  = GCS_ACT_TORDERED; /* each action carries its own type */
+    frg.act_id    = conn->send_act_no;
+    frg.frag_no   = 0;
+    frg.proto_ver = proto_ver;
+    frg.aggr      = true;
+
+    if ((ret = gcs_act_proto_write (&frg, conn->send_buf, conn->send_buf_len)))
+        return ret;
+
+    char* dst = (char*)frg.frag;
+
+    for (i = 0; i < acts_num; i++) {
+        core_act_t* local_act;
+
+        if ((local_act = (core_act_t*)gcs_fifo_lite_get_tail (conn->fifo))) {
+            *local_act = (core_act_t){ conn->send_act_no + i, acts[i].act,
+                                       acts[i].act_size };
+            gcs_fifo_lite_push_tail (conn->fifo);
+        }
+        else {
+            ret = core_error (conn->state);
+            gu_error ("Failed to access core FIFO: %d (%s)",
+                      ret, strerror (-ret));
+            goto remove;
+        }
+
+        gcs_act_proto_aggr_write (dst, acts[i].act_size, acts[i].act_type);
+        dst += GCS_ACT_PROTO_AGGR_HDR_SIZE;
+
+        size_t left = acts[i].act_size;
+        for (int idx = 0; left > 0; idx++) { // gather action bufs into one
+            size_t const len = std::min<size_t>(left, acts[i].act[idx].size);
+            memcpy (dst, acts[i].act[idx].ptr, len);
+            dst  += len;
+            left -= len;
+        }
+    }
+
+#ifdef GCS_CORE_TESTING
+    gu_lock_step_wait (&conn->ls);
+#endif
+    ret = core_msg_send_retry (conn, conn->send_buf, hdr_size + payload,
+                               GCS_MSG_ACTION);
+
+    if (gu_likely(ret == (ssize_t)(hdr_size + payload))) {
+        core_frag_sent (conn, payload);
+        conn->send_act_no += acts_num;
+        return payload - acts_num * GCS_ACT_PROTO_AGGR_HDR_SIZE;
+    }
+
+    if (ret >= 0) {
+        /* aggregated message can't be fragmented */
+        gu_fatal ("Failed to send aggregated message: sent %zd out of %zu "
+                  "bytes", ret, hdr_size + payload);
+        ret = -ENOTRECOVERABLE;
+    }
+
+remove:
+    /* none of the actions will be received, remove them from local FIFO */
+    while (i-- > 0) gcs_fifo_lite_remove (conn->fifo);
+
+    return ret;
+}
+
+long
+gcs_core_aggr_limit (const gcs_core_t* const core)
+{
+    if (core->proto_ver < GCS_ACT_PROTO_AGGR_VER) return 0;
+
+    return core->send_buf_len - gcs_act_proto_hdr_size (core->proto_ver);
+}
+
 /* A helper for gcs_core_recv().
  * Deals with fetching complete message from backend
  * and reallocates recv buf if needed */
@@ -466,9 +671,12 @@ core_msg_recv (gcs_backend_t* backend, gcs_recv_msg_t* recv_msg,
 {
     long ret;
 
+    recv_msg->ext = NULL;
+
     ret = backend->recv (backend, recv_msg, timeout);
 
-    while (gu_unlikely(ret > recv_msg->buf_len)) {
+    /* payload left in backend buffer needs no reallocation */
+    while (gu_unlikely(ret > recv_msg->buf_len) && NULL == recv_msg->ext) {
         /* recv_buf too small, reallocate */
         /* sometimes - like in case of component message, we may need to
          * do reallocation 2 times. This should be fixed in backend */
@@ -518,12 +726,33 @@ core_handle_act_msg (gcs_core_t*          core,
 
     assert (GCS_MSG_ACTION == msg->type);
 
-    if ((CORE_PRIMARY == core->state) || my_msg){//should always handle own msgs
+    if (core->recv_aggr_left > 0) {
+        /* next action from aggregated message */
+        ret = gcs_act_proto_aggr_read (&frg, core->recv_aggr,
+                                       core->recv_aggr_left);
+        if (gu_unlikely(ret < 0)) {
+            gu_fatal ("Error parsing aggregated action header: %zd (%s).",
+                      ret, strerror (-ret));
+            core->recv_aggr_left = 0;
+            assert (0);
+            return -ENOTRECOVERABLE;
+        }
 
-        if (gu_unlikely(gcs_act_proto_ver(msg->buf) !=
+        frg.act_id            = core->recv_aggr_id++;
+        frg.proto_ver         = core->recv_aggr_ver;
+        core->recv_aggr      += ret;
+        core->recv_aggr_left -= ret;
+
+        commonly_supported_version =
+            (frg.proto_ver == gcs_core_group_protocol_version(core));
+    }
+    else if ((CORE_PRIMARY == core->state) || my_msg) {
+        const void* const buf(gcs_recv_msg_data(msg));
+
+        if (gu_unlikely(gcs_act_proto_ver(buf) !=
                         gcs_core_group_protocol_version(core))) {
             gu_info ("Message with protocol version %d != highest commonly supported: %d. ",
-                     gcs_act_proto_ver(msg->buf),
+                     gcs_act_proto_ver(buf),
                      gcs_core_group_protocol_version(core));
             commonly_supported_version = false;
             if (!my_msg) {
@@ -536,7 +765,7 @@ core_handle_act_msg (gcs_core_t*          core,
             }
         }
 
-        ret = gcs_act_proto_read (&frg, msg->buf, msg->size);
+        ret = gcs_act_proto_read (&frg, buf, msg->size);
 
         if (gu_unlikely(ret)) {
             gu_fatal ("Error parsing action fragment header: %zd (%s).",
@@ -545,6 +774,21 @@ core_handle_act_msg (gcs_core_t*          core,
             return -ENOTRECOVERABLE;
         }
 
+        if (frg.aggr) {
+            /* split aggregated message into actions with consecutive ids,
+             * the rest of them is handled by the following calls */
+            core->recv_aggr      = (const uint8_t*)frg.frag;
+            core->recv_aggr_left = frg.frag_len;
+            core->recv_aggr_id   = frg.act_id;
+            core->recv_aggr_ver  = frg.proto_ver;
+            return core_handle_act_msg (core, msg, act);
+        }
+
+        if (my_msg) core_frag_rcvd (core, frg);
+    }
+
+    if ((CORE_PRIMARY == core->state) || my_msg) {
+
         ret = gcs_group_handle_act_msg (group, &frg, msg, act,
                                         commonly_supported_version);
 
@@ -991,6 +1235,7 @@ core_msg_to_action (gcs_core_t*          core,
 
         switch (msg->type) {
         case GCS_MSG_FLOW: // most frequent
+            gcs_group_handle_flow_msg (group, msg);
             ret = 1;
             act_type = GCS_ACT_FLOW;
             break;
@@ -1099,6 +1344,14 @@ ssize_t gcs_core_recv (gcs_core_t*          conn,
         assert (recv_act->id          == GCS_SEQNO_ILL);
         assert (recv_act->sender_idx  == -1);
 
+        if (gu_unlikely(conn->recv_aggr_left > 0)) {
+            /* actions left in aggregated message, don't receive a new one */
+            assert (GCS_MSG_ACTION == recv_msg->type);
+            ret = core_handle_act_msg(conn, recv_msg, recv_act);
+            assert (ret == recv_act->act.buf_len || ret <= 0);
+            continue;
+        }
+
         ret = core_msg_recv (&conn->backend, recv_msg, timeout);
         if (gu_unlikely (ret <= 0)) {
             goto out; /* backend error while receiving message */
@@ -1312,6 +1565,17 @@ gcs_core_set_pkt_size (gcs_core_t* core, int const pkt_size)
     return ret;
 }
 
+void
+gcs_core_set_frag_time (gcs_core_t* core, long long const frag_time)
+{
+    if (gu_mutex_lock (&core->send_lock)) abort();
+
+    core->frag_time = frag_time;
+    core->send_rate = 0; // start measuring anew
+
+    gu_mutex_unlock (&core->send_lock);
+}
+
 static inline long
 core_send_seqno (gcs_core_t* core, gcs_seqno_t seqno, gcs_msg_type_t msg_type)
 {
@@ -1420,6 +1684,24 @@ void gcs_core_get_status(gcs_core_t* core, gu::Status& status)
     {
         gcs_group_get_status(&core->group, status);
         core->backend.status_get(&core->backend, status);
+
+        std::ostringstream os;
+        for (int i(0); i < CORE_FRAG_HIST_LEN; ++i)
+        {
+            if (i > 0) os << ", ";
+            if (i < CORE_FRAG_HIST_LEN - 1)
+                os << (1 << i) << "K:";
+            else
+                os << "inf:";
+            os << core->frag_hist[i];
+        }
+        status.insert("gcs_frag_sizes", os.str());
+
+        if (core->frag_time)
+        {
+            long long const rate(core->send_rate);
+            status.insert("gcs_send_rate", gu::to_string(rate));
+        }
     }
     gu_mutex_unlock(&core->send_lock);
 }
@@ -105,6 +105,40 @@ gcs_core_send (gcs_core_t*          core,
                size_t               act_size,
                gcs_act_type_t       act_type);
 
+/* An action to be sent with gcs_core_send_aggr() */
+typedef struct gcs_core_act
+{
+    const struct gu_buf* act;
+    size_t               act_size;
+    gcs_act_type_t       act_type;
+}
+gcs_core_act_t;
+
+/*
+ * gcs_core_send_aggr() atomically sends several actions packed in a single
+ * message. Actions are received as separate ones, each with its own seqno.
+ *
+ * NOT THREAD SAFE! Access should be serialized.
+ *
+ * Return values:
+ * non-negative - total amount of action bytes sent (sans headers)
+ * negative     - error code, none of the actions was sent, as in
+ *                gcs_core_send(), and also
+ *                -EPROTONOSUPPORT - group protocol does not support
+ *                                   aggregation any more
+ *                -EMSGSIZE        - actions don't fit in a single message
+ */
+extern ssize_t
+gcs_core_send_aggr (gcs_core_t*           core,
+                    const gcs_core_act_t* acts,
+                    int                   acts_num);
+
+/* Returns the number of bytes available for actions in aggregated message
+ * (each action takes its size plus GCS_ACT_PROTO_AGGR_HDR_SIZE) or 0 if group
+ * protocol does not support aggregation. */
+extern long
+gcs_core_aggr_limit (const gcs_core_t* core);
+
 /*
  * gcs_core_recv() blocks until some action is received from group.
  *
@@ -138,6 +172,13 @@ gcs_core_group_protocol_version (const gcs_core_t* conn);
 extern int
 gcs_core_set_pkt_size (gcs_core_t* conn, int pkt_size);
 
+/* Enables adaptive fragmentation: actions that don't fit in a single message
+ * are split into fragments that take at most frag_time nanoseconds to deliver
+ * at the measured rate of own fragments delivery. 0 restores fixed size
+ * fragments. */
+extern void
+gcs_core_set_frag_time (gcs_core_t* conn, long long frag_time);
+
 /* sends this node's last applied value to group */
 extern long
 gcs_core_set_last_applied (gcs_core_t* core, gcs_seqno_t seqno);
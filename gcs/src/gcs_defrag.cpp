@@ -127,12 +127,11 @@ gcs_defrag_handle_frag (gcs_defrag_t*         df,
                 return 0;
             }
             else {
-                ((char*)frg->frag)[frg->frag_len - 1] = '\0';
                 gu_error ("Unordered fragment received. Protocol error.");
                 gu_error ("Expected: any:0(first), received: %lld:%ld",
                           frg->act_id, frg->frag_no);
-                gu_error ("Contents: '%s', local: %s, reset: %s",
-                          (char*)frg->frag, local ? "yes" : "no",
+                gu_error ("Contents: '%.*s', local: %s, reset: %s",
+                          (int)frg->frag_len, (char*)frg->frag, local ? "yes" : "no",
                           df->reset ? "yes" : "no");
                 assert(0);
                 return -EPROTO;
@@ -204,3 +204,177 @@ gcs_fc_process (gcs_fc_t* fc, ssize_t act_size)
 }
 
 void gcs_fc_debug (gcs_fc_t* fc, long debug_level) { fc->debug = debug_level; }
+
+/*
+ * Rate-based flow control.
+ *
+ * Slave queue fill rate and drain capacity (actions applied per second of time
+ * the queue was not empty) are sampled every rate_sample seconds and smoothed.
+ * When the queue length, extrapolated one sample ahead by the difference of
+ * these rates, exceeds soft limit, every new action "costs" 1/desired_rate
+ * seconds, and if actions arrive faster than that, replication is paused for
+ * the difference. Desired rate goes linearly from the drain capacity at soft
+ * limit to a fraction of it at hard limit, so that the queue has a chance to
+ * shrink:
+ *
+ *   desired_rate = apply_rate * (1 - rate_drain * (len - soft)/(hard - soft))
+ *
+ * Thus instead of full speed - full stop oscillation between queue limits
+ * the group is paced with pauses of a few milliseconds each.
+ */
+
+static double    const rate_sample    = 0.1;  //! rate sample period (s)
+static long long const rate_sample_ns = rate_sample * 1000000000LL;
+static double    const rate_weight    = 0.5;  //! weight of a new sample
+static double    const rate_drain     = 0.5;  //! throttle at hard limit
+static double    const max_pause      = rate_sample; //! longest pause (s)
+
+void
+gcs_fc_rate_init (gcs_fc_rate_t* const fc,
+                  long const soft_limit, long const hard_limit,
+                  long long const now)
+{
+    assert (fc);
+
+    memset (fc, 0, sizeof(*fc));
+
+    fc->apply_rate   = -1.0;
+    fc->recv_rate    = -1.0;
+    fc->sample_start = now;
+    fc->busy_start   = -1;
+    fc->pace_start   = now;
+
+    gcs_fc_rate_limits (fc, soft_limit, hard_limit);
+}
+
+void
+gcs_fc_rate_limits (gcs_fc_rate_t* const fc,
+                    long const soft_limit, long const hard_limit)
+{
+    assert (soft_limit >= 0);
+    assert (hard_limit >= soft_limit);
+
+    fc->soft_limit = soft_limit;
+    fc->hard_limit = hard_limit;
+}
+
+static inline double
+fc_rate_smooth (double const old_rate, double const new_rate)
+{
+    return (old_rate < 0.0 ? new_rate :
+            old_rate + (new_rate - old_rate) * rate_weight);
+}
+
+static void
+fc_rate_sample (gcs_fc_rate_t* const fc, long long const now)
+{
+    long long const interval(now - fc->sample_start);
+
+    if (interval < rate_sample_ns) return;
+
+    if (fc->busy_start >= 0) {
+        fc->busy      += now - fc->busy_start;
+        fc->busy_start = now;
+    }
+
+    fc->recv_rate = fc_rate_smooth(fc->recv_rate,
+                                   fc->recvd / (interval * 1.0e-9));
+
+    /* queue that was mostly empty says little about how fast it can be
+     * drained */
+    if (fc->applied > 0 && fc->busy > interval / 100) {
+        fc->apply_rate = fc_rate_smooth(fc->apply_rate,
+                                        fc->applied / (fc->busy * 1.0e-9));
+    }
+
+    fc->sample_start = now;
+    fc->recvd        = 0;
+    fc->applied      = 0;
+    fc->busy         = 0;
+}
+
+void
+gcs_fc_rate_applied (gcs_fc_rate_t* const fc, long const queue_len,
+                     long long const now)
+{
+    fc->applied++;
+
+    if (0 == queue_len) {
+        if (fc->busy_start >= 0) {
+            fc->busy      += now - fc->busy_start;
+            fc->busy_start = -1;
+        }
+        /* applier is starving, whatever pause is in effect must end */
+        fc->pace_start = now;
+        fc->paced      = 0;
+    }
+
+    fc_rate_sample (fc, now);
+}
+
+long long
+gcs_fc_rate_process (gcs_fc_rate_t* const fc, long const queue_len,
+                     long long const now)
+{
+    fc->recvd++;
+    fc->paced++;
+    fc->act_count++;
+
+    if (fc->busy_start < 0) fc->busy_start = now;
+
+    fc_rate_sample (fc, now);
+
+    /* predicted queue length by the end of the next sample */
+    double const trend((fc->recv_rate - fc->apply_rate) * rate_sample);
+    double const expected(queue_len + (trend > 0.0 ? trend : 0.0));
+
+    bool const print(fc->debug > 0 && !(fc->act_count % fc->debug));
+
+    if (fc->apply_rate <= 0.0 || expected <= fc->soft_limit) {
+        /* normal operation or nothing measured yet */
+        if (gu_unlikely(print)) {
+            gu_info ("FC: queue length: %ld, expected: %.1f, "
+                     "recv rate: %.1f act/s, apply rate: %.1f act/s",
+                     queue_len, expected, fc->recv_rate, fc->apply_rate);
+        }
+        fc->pace_start = now > fc->pace_start ? now : fc->pace_start;
+        fc->paced      = 0;
+        return 0;
+    }
+
+    double const range(fc->hard_limit - fc->soft_limit);
+    double excess(range > 0.0 ? (expected - fc->soft_limit) / range : 1.0);
+    if (excess > 1.0) excess = 1.0;
+
+    double const desired_rate(fc->apply_rate * (1.0 - rate_drain * excess));
+    double sleep(fc->paced / desired_rate - (now - fc->pace_start) * 1.0e-9);
+
+    if (gu_unlikely(print)) {
+        gu_info ("FC: queue length: %ld, expected: %.1f, "
+                 "recv rate: %.1f act/s, apply rate: %.1f act/s, "
+                 "desired rate: %.1f act/s, sleep: %5.4fs. "
+                 "Pauses initiated: %ld, for a total of %6.3fs",
+                 queue_len, expected, fc->recv_rate, fc->apply_rate,
+                 desired_rate, sleep, fc->pause_count, fc->pauses);
+        fc->pause_count = 0;
+        fc->pauses      = 0.0;
+    }
+
+    if (gu_likely(sleep < min_sleep)) return 0;
+
+    if (sleep > max_pause) sleep = max_pause;
+
+    long long const pause(1000000000LL * sleep);
+
+    fc->pace_start = now + pause;
+    fc->paced      = 0;
+    fc->pause_count++;
+    fc->pauses += sleep;
+
+    return pause;
+}
+
+void gcs_fc_rate_debug (gcs_fc_rate_t* fc, long debug_level)
+{
+    fc->debug = debug_level;
+}
@@ -56,4 +56,54 @@ gcs_fc_process (gcs_fc_t* fc, ssize_t act_size);
 extern void
 gcs_fc_debug (gcs_fc_t* fc, long debug_level);
 
+/*! Rate-based slave queue flow control. The same throttling idea as above
+ *  applied to the normal operation: instead of stopping replication when
+ *  slave queue length exceeds the upper limit and waiting for it to drain,
+ *  measure how fast the queue can be drained and how fast it is filled and,
+ *  as the queue is predicted to grow past soft limit, pace replication to the
+ *  drain rate with short pauses. */
+typedef struct gcs_fc_rate
+{
+    long      soft_limit;   // queue length after which pacing kicks in
+    long      hard_limit;   // queue length at which replication is stopped
+    double    apply_rate;   // measured queue drain capacity (act/s)
+    double    recv_rate;    // measured queue fill rate (act/s)
+    long long sample_start; // beginning of the current sample (nanosec)
+    long      recvd;        // actions added to queue in the current sample
+    long      applied;      // actions removed from queue in the current sample
+    long long busy;         // time queue was not empty in the current sample
+    long long busy_start;   // when queue became not empty, -1 if it is empty
+    long long pace_start;   // beginning of the current pacing interval
+    long      paced;        // actions received in the current pacing interval
+    long      act_count;    // action count
+    long      debug;        // how often to print debug messages, 0 - never
+    long      pause_count;
+    double    pauses;
+}
+gcs_fc_rate_t;
+
+/*! Initializes rate-based FC object, all measurements are discarded */
+extern void
+gcs_fc_rate_init (gcs_fc_rate_t* fc, long soft_limit, long hard_limit,
+                  long long now);
+
+/*! Changes queue limits, measurements are preserved */
+extern void
+gcs_fc_rate_limits (gcs_fc_rate_t* fc, long soft_limit, long hard_limit);
+
+/*! Accounts for an action removed from a slave queue.
+ *  @param queue_len queue length after the action was removed */
+extern void
+gcs_fc_rate_applied (gcs_fc_rate_t* fc, long queue_len, long long now);
+
+/*! Processes a new action added to a slave queue.
+ *  @param queue_len queue length including the new action
+ *  @return nanoseconds to pause replication for */
+extern long long
+gcs_fc_rate_process (gcs_fc_rate_t* fc, long queue_len, long long now);
+
+/*! Print debug info every debug_level'th call to gcs_fc_rate_process. */
+extern void
+gcs_fc_rate_debug (gcs_fc_rate_t* fc, long debug_level);
+
 #endif /* _gcs_fc_h_ */
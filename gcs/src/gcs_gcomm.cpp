@@ -91,7 +91,8 @@ private:
 
 public:
 
-    RecvBuf() : mutex_(), cond_(), queue_(), waiting_(false) { }
+    RecvBuf() : mutex_(), cond_(), queue_(), waiting_(false), held_(false)
+    { }
 
     void push_back(const RecvBufData& p)
     {
@@ -106,6 +107,13 @@ public:
     {
         Lock lock(mutex_);
 
+        if (held_)
+        {
+            assert(queue_.empty() == false);
+            queue_.pop_front();
+            held_ = false;
+        }
+
         while (queue_.empty())
         {
             Waiting w(waiting_);
@@ -130,12 +138,22 @@ public:
         queue_.pop_front();
     }
 
+    /* Keeps the front element in the queue until the next front() call so
+     * that its payload can be read in place by the caller. */
+    void hold_front()
+    {
+        Lock lock(mutex_);
+        assert(queue_.empty() == false);
+        held_ = true;
+    }
+
 private:
 
     Mutex mutex_;
     Cond cond_;
     RecvBufQueue queue_;
     bool waiting_;
+    bool held_;
 };
 
 class GCommConn : public Toplay
@@ -622,11 +640,18 @@ static GCS_BACKEND_RECV_FN(gcomm_recv)
             const ssize_t pload_len(gcomm::available(dg));
 
             msg->size = pload_len;
+            msg->type = static_cast<gcs_msg_type_t>(um.user_type());
 
-            if (gu_likely(pload_len <= msg->buf_len))
+            if (gu_likely(GCS_MSG_ACTION == msg->type))
+            {
+                /* action fragments are copied from the datagram straight
+                 * to their destination, datagram stays in the queue */
+                msg->ext = b;
+                recv_buf.hold_front();
+            }
+            else if (gu_likely(pload_len <= msg->buf_len))
             {
                 memcpy(msg->buf, b, pload_len);
-                msg->type = static_cast<gcs_msg_type_t>(um.user_type());
                 recv_buf.pop_front();
             }
             else
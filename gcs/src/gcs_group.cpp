@@ -338,6 +338,10 @@ group_post_state_exchange (gcs_group_t* group)
     // is it up to date, does it need SST and stuff
     for (i = 0; i < group->num; i++) {
         gcs_node_update_status (&group->nodes[i], quorum);
+        // load indicators are reset in a new configuration for all members
+        // to have the same view of them
+        group->nodes[i].fc_stop = false;
+        group->nodes[i].conf_last_applied = GCS_SEQNO_ILL;
     }
 
     if (quorum->primary) {
@@ -669,6 +673,7 @@ gcs_group_handle_last_msg (gcs_group_t* group, const gcs_recv_msg_t* msg)
     // assert (seqno >= group->last_applied);
 
     gcs_node_set_last_applied (&group->nodes[msg->sender_idx], seqno);
+    group->nodes[msg->sender_idx].conf_last_applied = seqno;
 
     if (msg->sender_idx == group->last_node && seqno > group->last_applied) {
         /* node that was responsible for the last value, has changed it.
@@ -869,6 +874,22 @@ gcs_group_handle_sync_msg  (gcs_group_t* group, const gcs_recv_msg_t* msg)
     }
 }
 
+void
+gcs_group_handle_flow_msg (gcs_group_t* group, const gcs_recv_msg_t* msg)
+{
+    if (gu_unlikely(msg->size != sizeof(struct gcs_fc_event))) return;
+
+    const struct gcs_fc_event* const fc =
+        static_cast<const struct gcs_fc_event*>(msg->buf);
+
+    if (gtohl(fc->conf_id) != (uint32_t)group->conf_id) {
+        // obsolete fc request
+        return;
+    }
+
+    group->nodes[msg->sender_idx].fc_stop = (fc->stop != 0);
+}
+
 static inline bool
 group_node_is_stateful (const gcs_group_t* group, const gcs_node_t* node)
 {
@@ -880,6 +901,34 @@ group_node_is_stateful (const gcs_group_t* group, const gcs_node_t* node)
     }
 }
 
+/*! Apply lag of the node as reported in current configuration,
+ *  unknown lag is considered the longest */
+static inline gcs_seqno_t
+group_node_lag (const gcs_group_t* const group, const gcs_node_t* const node)
+{
+    if (node->conf_last_applied < 0) return GU_LLONG_MAX;
+
+    return group->act_id_ - node->conf_last_applied;
+}
+
+/*! Compares load of potential donors. Nodes that hold the group in flow
+ *  control are the busiest, then the longer apply lag the busier the node.
+ *  Every node must make the same choice, so only the information delivered
+ *  in total order since the last configuration change is used.
+ *  @return true if node a is less loaded than node b */
+static inline bool
+group_node_less_loaded (const gcs_group_t* const group,
+                        const gcs_node_t*  const a,
+                        const gcs_node_t*  const b)
+{
+    if (group->quorum.gcs_proto_ver < GCS_ACT_PROTO_DONOR_LOAD_VER)
+        return false;
+
+    if (a->fc_stop != b->fc_stop) return b->fc_stop;
+
+    return (group_node_lag(group, a) < group_node_lag(group, b));
+}
+
 static int
 group_find_node_by_state (const gcs_group_t*     const group,
                           int              const joiner_idx,
@@ -888,6 +937,7 @@ group_find_node_by_state (const gcs_group_t*     const group,
     gcs_segment_t const segment = group->nodes[joiner_idx].segment;
     int  idx;
     int  donor = -1;
+    int  local_donor = -1;
     bool hnss = false; /* have nodes in the same segment */
 
     for (idx = 0; idx < group->num; idx++) {
@@ -896,16 +946,29 @@ group_find_node_by_state (const gcs_group_t*     const group,
 
         gcs_node_t* node = &group->nodes[idx];
 
-        if (node->status >= status && group_node_is_stateful (group, node))
-            donor = idx; /* potential donor */
-
-        if (segment == node->segment) {
-            if (donor == idx) return donor; /* found suitable donor in the
-                                             * same segment */
-            if (node->status >= GCS_NODE_STATE_JOINER) hnss = true;;
+        if (node->status >= status && group_node_is_stateful (group, node)) {
+            /* potential donor, prefer the least loaded one: the first of
+             * equally loaded in the same segment, the last one outside */
+            if (segment == node->segment) {
+                if (local_donor < 0 ||
+                    group_node_less_loaded (group, node,
+                                            &group->nodes[local_donor]))
+                    local_donor = idx;
+            }
+            else if (donor < 0 ||
+                     !group_node_less_loaded (group, &group->nodes[donor],
+                                              node)) {
+                donor = idx;
+            }
         }
+
+        if (segment == node->segment &&
+            node->status >= GCS_NODE_STATE_JOINER) hnss = true;
     }
 
+    /* found suitable donor in the same segment */
+    if (local_donor >= 0) return local_donor;
+
     /* Have not found suitable donor in the same segment. */
     if (!hnss && donor >= 0) {
         if (joiner_idx == group->my_idx) {
@@ -1120,8 +1183,8 @@ group_find_ist_donor_by_state (const gcs_group_t* const group,
     gcs_segment_t joiner_segment = joiner->segment;
 
     // find node who is ist potentially possible.
-    // first highest cached seqno local node.
-    // then highest cached seqno remote node.
+    // first least loaded local node, then least loaded remote node,
+    // highest cached seqno of equally loaded nodes.
     int idx = 0;
     int local_idx = -1;
     int remote_idx = -1;
@@ -1140,8 +1203,13 @@ group_find_ist_donor_by_state (const gcs_group_t* const group,
             int* const idx_ptr =
                 (joiner_segment == node->segment) ? &local_idx : &remote_idx;
 
-            if (*idx_ptr == -1 ||
-                node_cached >= gcs_node_cached(&group->nodes[*idx_ptr]))
+            const gcs_node_t* const best =
+                (*idx_ptr == -1) ? NULL : &group->nodes[*idx_ptr];
+
+            if (best == NULL ||
+                group_node_less_loaded(group, node, best) ||
+                (!group_node_less_loaded(group, best, node) &&
+                 node_cached >= gcs_node_cached(best)))
             {
                 *idx_ptr = idx;
             }
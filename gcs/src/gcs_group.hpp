@@ -143,6 +143,11 @@ gcs_group_handle_join_msg  (gcs_group_t* group, const gcs_recv_msg_t* msg);
 extern int
 gcs_group_handle_sync_msg  (gcs_group_t* group, const gcs_recv_msg_t* msg);
 
+/*! Records flow control state of the sender to account for it in
+ *  state transfer donor selection */
+extern void
+gcs_group_handle_flow_msg  (gcs_group_t* group, const gcs_recv_msg_t* msg);
+
 /*! @return 0 if request is ignored, request size if it should be passed up */
 extern int
 gcs_group_handle_state_request (gcs_group_t*         group,
@@ -36,6 +36,7 @@ gcs_node_init (gcs_node_t* const node,
     node->repl_proto_ver = repl_proto_ver;
     node->appl_proto_ver = appl_proto_ver;
     node->segment        = segment;
+    node->conf_last_applied = GCS_SEQNO_ILL;
 }
 
 /*! Move data from one node object to another */
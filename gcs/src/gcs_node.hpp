@@ -47,6 +47,8 @@ struct gcs_node
     gcs_segment_t    segment;
     bool             count_last_applied; // should it be counted
     bool             bootstrap; // is part of prim comp bootstrap process
+    bool             fc_stop;   // has requested flow control pause
+    gcs_seqno_t      conf_last_applied; // reported in this configuration
 };
 typedef struct gcs_node gcs_node_t;
 
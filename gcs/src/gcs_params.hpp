@@ -17,7 +17,11 @@ struct gcs_params
     long    fc_base_limit;
     long    max_packet_size;
     long    fc_debug;
+    long    aggregate_size;  // bytes
+    long    aggregate_delay; // microseconds
+    long    frag_time;       // microseconds
     bool    fc_master_slave;
+    bool    fc_rate;
     bool    sync_donor;
 };
 
@@ -25,11 +29,15 @@ extern const char* const GCS_PARAMS_FC_FACTOR;
 extern const char* const GCS_PARAMS_FC_LIMIT;
 extern const char* const GCS_PARAMS_FC_MASTER_SLAVE;
 extern const char* const GCS_PARAMS_FC_DEBUG;
+extern const char* const GCS_PARAMS_FC_RATE;
 extern const char* const GCS_PARAMS_SYNC_DONOR;
 extern const char* const GCS_PARAMS_MAX_PKT_SIZE;
 extern const char* const GCS_PARAMS_RECV_Q_HARD_LIMIT;
 extern const char* const GCS_PARAMS_RECV_Q_SOFT_LIMIT;
 extern const char* const GCS_PARAMS_MAX_THROTTLE;
+extern const char* const GCS_PARAMS_AGGREGATE_SIZE;
+extern const char* const GCS_PARAMS_AGGREGATE_DELAY;
+extern const char* const GCS_PARAMS_FRAG_TIME;
 #ifdef GCS_SM_DEBUG
 extern const char* const GCS_PARAMS_SM_DUMP;
 #endif /* GCS_SM_DEBUG */
@@ -15,4 +15,15 @@
 
 #define GCS_DESYNC_REQ "self-desync"
 
+static bool const GCS_FC_STOP = true;
+static bool const GCS_FC_CONT = false;
+
+/** Flow control message */
+struct gcs_fc_event
+{
+    uint32_t conf_id; // least significant part of configuraiton seqno
+    uint32_t stop;    // boolean value
+}
+__attribute__((__packed__));
+
 #endif /* _gcs_priv_h_ */
@@ -13,6 +13,8 @@
 
 #include "gcs_msg_type.hpp"
 
+#include <stddef.h>
+
 typedef struct gcs_recv_msg
 {
     void*          buf;
@@ -20,6 +22,8 @@ typedef struct gcs_recv_msg
     int            size;
     int            sender_idx;
     gcs_msg_type_t type;
+    const void*    ext;   // if not NULL, message payload in backend's own
+                          // buffer, valid until the next backend recv() call
 
     gcs_recv_msg() { }
     gcs_recv_msg(void* b, long bl, long sz, long si, gcs_msg_type_t t)
@@ -28,9 +32,17 @@ typedef struct gcs_recv_msg
         buf_len(bl),
         size(sz),
         sender_idx(si),
-        type(t)
+        type(t),
+        ext(NULL)
     { }
 }
 gcs_recv_msg_t;
 
+/*! Returns pointer to the received message payload */
+static inline const void*
+gcs_recv_msg_data (const gcs_recv_msg_t* const msg)
+{
+    return msg->ext ? msg->ext : msg->buf;
+}
+
 #endif /* _gcs_recv_msg_h_ */
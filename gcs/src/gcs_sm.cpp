@@ -62,6 +62,10 @@ gcs_sm_create (long len, long n)
 #endif /* GCS_SM_CONCURRENCY */
         sm->pause       = false;
         sm->wait_time   = gu::datetime::Sec;
+        sm->batch_size  = 0;
+        sm->batch_delay = 0;
+        gu_cond_init  (&sm->batch_cond, NULL);
+        sm->batch_wait  = false;
 
 #ifdef GCS_SM_DEBUG
         memset (&sm->history, 0, sizeof(sm->history));
@@ -135,6 +139,7 @@ gcs_sm_open (gcs_sm_t* sm)
 void
 gcs_sm_destroy (gcs_sm_t* sm)
 {
+    gu_cond_destroy (&sm->batch_cond);
     gu_mutex_destroy(&sm->lock);
     gu_free (sm);
 }
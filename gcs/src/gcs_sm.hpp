@@ -6,6 +6,14 @@
 
 /*!
  * @file GCS Send Monitor. To ensure fair (FIFO) access to gcs_core_send()
+ *
+ * Instead of handing the monitor over to every next waiter in turn, the user
+ * that is leaving the monitor may perform the jobs of the waiters queued
+ * behind it (see gcs_sm_job_t) and only wake them up when their jobs are done.
+ * This saves a context switch per handoff when there are many concurrent
+ * senders. Jobs that can be batched (gcs_sm_job_t::batch) are performed
+ * together, as a single call, up to the size set by gcs_sm_set_batch(). The
+ * leaving user may wait a little for more jobs to fill the batch.
  */
 
 #ifndef _gcs_sm_h_
@@ -21,10 +29,29 @@
 #define GCS_SM_CC 1
 #endif /* GCS_SM_CONCURRENCY */
 
+/*! Maximum number of queued jobs performed by a leaving user */
+#define GCS_SM_COMBINE_MAX 16
+
+/*! A job to be performed inside the monitor that may be done by another
+ *  user on behalf of the waiter */
+typedef struct gcs_sm_job
+{
+    long  (*fn)(void* ctx);
+    /* performs a batch of jobs setting their ret, may be NULL */
+    void  (*batch)(struct gcs_sm_job** jobs, long n);
+    void* ctx;
+    size_t size; // job size to account against batch size
+    long  ret;   // fn() return value
+    bool  taken; // job was taken by another user
+    bool  done;  // job was performed by another user
+}
+gcs_sm_job_t;
+
 typedef struct gcs_sm_user
 {
-    gu_cond_t* cond;
-    bool       wait;
+    gu_cond_t*    cond;
+    gcs_sm_job_t* job;
+    bool          wait;
 }
 gcs_sm_user_t;
 
@@ -61,6 +88,10 @@ typedef struct gcs_sm
 #endif /* GCS_SM_CONCURRENCY */
     bool          pause;
     gu::datetime::Period wait_time;
+    size_t        batch_size;  // max total size of job batch, 0 - no batching
+    long long     batch_delay; // nanoseconds to wait for batch to fill up
+    gu_cond_t     batch_cond;  // signaled when user is queued during the wait
+    bool          batch_wait;
 
 #ifdef GCS_SM_DEBUG
 #define GCS_SM_HIST_STR_LEN 128
@@ -210,12 +241,15 @@ _gcs_sm_leave_common (gcs_sm_t* sm)
 
 static inline int
 _gcs_sm_enqueue_common (gcs_sm_t* sm, gu_cond_t* cond, bool block,
-                        unsigned long tail)
+                        unsigned long tail, gcs_sm_job_t* job = NULL)
 {
     sm->wait_q[tail].cond = cond;
+    sm->wait_q[tail].job  = job;
     sm->wait_q[tail].wait = true;
     int ret;
 
+    if (gu_unlikely(sm->batch_wait)) gu_cond_signal (&sm->batch_cond);
+
     if (block == true)
     {
         GCS_SM_HIST_LOG("queueing at %lu", tail);
@@ -270,6 +304,7 @@ _gcs_sm_enqueue_common (gcs_sm_t* sm, gu_cond_t* cond, bool block,
     }
 
     sm->wait_q[tail].cond = NULL;
+    sm->wait_q[tail].job  = NULL;
     sm->wait_q[tail].wait = false;
 
     if (gu_unlikely(0 != ret)) GCS_SM_HIST_LOG("%ld wait failed: %d", tail, ret);
@@ -340,18 +375,25 @@ gcs_sm_schedule (gcs_sm_t* sm)
  * @param cond condition to signal to wake up thread in case of wait
  * @param block if true block until entered or send monitor is closed,
  *              if false enter wait times out eventually
+ * @param job  if not NULL, the job may be performed by the user ahead in the
+ *             queue, requires block to be true
  *
  * @retval -EAGAIN - out of space
  * @retval -EBADFD - monitor closed
  * @retval -EINTR  - was interrupted by another thread
  * @retval -ETIMEDOUT - timedout waiting for its turn
  * @retval 0 - successfully entered
+ * @retval 1 - job was performed by another user, its result is in job->ret,
+ *             monitor was not entered
  */
 static inline long
-gcs_sm_enter (gcs_sm_t* sm, gu_cond_t* cond, bool scheduled, bool block)
+gcs_sm_enter (gcs_sm_t* sm, gu_cond_t* cond, bool scheduled, bool block,
+              gcs_sm_job_t* job = NULL)
 {
     long ret = 0; /* if scheduled and no queue */
 
+    assert (NULL == job || block);
+
     if (gu_likely (scheduled || (ret = gcs_sm_schedule(sm)) >= 0)) {
         const unsigned long tail(sm->wait_q_tail);
 
@@ -360,7 +402,7 @@ gcs_sm_enter (gcs_sm_t* sm, gu_cond_t* cond, bool scheduled, bool block)
            was true) */
         bool wait = GCS_SM_HAS_TO_WAIT;
         while (wait && ret >= 0) {
-            ret = _gcs_sm_enqueue_common (sm, cond, block, tail);
+            ret = _gcs_sm_enqueue_common (sm, cond, block, tail, job);
             if (gu_likely((0 == ret))) {
                 ret = sm->ret;
                 /* weaken the condition, so that we do enter if there
@@ -369,6 +411,15 @@ gcs_sm_enter (gcs_sm_t* sm, gu_cond_t* cond, bool scheduled, bool block)
             }
         }
 
+        if (NULL != job && job->taken) {
+            /* the user ahead is doing our job, our place in the queue is
+             * taken care of */
+            while (!job->done) gu_cond_wait (cond, &sm->lock);
+            GCS_SM_HIST_LOG("%lu job done: %ld", tail, job->ret);
+            gu_mutex_unlock (&sm->lock);
+            return 1;
+        }
+
         assert (ret <= 0);
 
         if (gu_likely(0 == ret)) {
@@ -402,12 +453,159 @@ gcs_sm_enter (gcs_sm_t* sm, gu_cond_t* cond, bool scheduled, bool block)
     return ret;
 }
 
+/* Whether the waiters' jobs can be performed by the user in the monitor */
+static inline bool
+_gcs_sm_combinable (const gcs_sm_t* sm)
+{
+    return (1 == GCS_SM_CC && 1 == sm->entered && !sm->pause &&
+            0 == sm->ret && 0 == sm->cond_wait);
+}
+
+/* Returns the job of the next waiter or NULL if it can't be performed */
+static inline gcs_sm_job_t*
+_gcs_sm_next_job (const gcs_sm_t* sm)
+{
+    if (sm->users > 1 && _gcs_sm_combinable(sm)) {
+        unsigned long const next((sm->wait_q_head + 1) & sm->wait_q_mask);
+        const gcs_sm_user_t* const user(&sm->wait_q[next]);
+
+        if (user->wait) return user->job;
+    }
+
+    return NULL;
+}
+
+/* Takes the job of the next waiter, returns the waiter's condition */
+static inline gu_cond_t*
+_gcs_sm_take_next_job (gcs_sm_t* sm)
+{
+    unsigned long const next((sm->wait_q_head + 1) & sm->wait_q_mask);
+    gcs_sm_user_t* const user(&sm->wait_q[next]);
+    gu_cond_t*     const cond(user->cond);
+
+    /* the waiter can't be interrupted after that */
+    user->wait = false;
+    user->cond = NULL;
+    user->job->taken = true;
+    user->job  = NULL;
+
+    /* move queue head to the waiter as if it has entered */
+    sm->users--;
+    if (gu_unlikely(sm->users < sm->users_min)) {
+        sm->users_min = sm->users;
+    }
+    GCS_SM_INCREMENT(sm->wait_q_head);
+    GCS_SM_HIST_LOG("combining %lu", next);
+
+    return cond;
+}
+
+/* Takes a batch of up to max jobs starting with the next one. If the batch
+ * is not full, waits up to sm->batch_delay for more waiters.
+ * @return number of jobs taken */
+static inline long
+_gcs_sm_take_batch (gcs_sm_t* sm, gcs_sm_job_t** jobs, gu_cond_t** conds,
+                    long const max)
+{
+    long   n(0);
+    size_t size(0);
+    bool   expired(sm->batch_delay <= 0);
+    struct timespec deadline = { 0, 0 };
+
+    while (true) {
+        gcs_sm_job_t* job(NULL);
+
+        while (n < max && NULL != (job = _gcs_sm_next_job(sm)) &&
+               (0 == n || (job->batch == jobs[0]->batch &&
+                           size + job->size <= sm->batch_size))) {
+            conds[n] = _gcs_sm_take_next_job(sm);
+            jobs[n]  = job;
+            size    += job->size;
+            n++;
+        }
+
+        /* stop if the batch is full or the next job can't join it */
+        if (expired || n == max || size >= sm->batch_size || NULL != job ||
+            !_gcs_sm_combinable(sm)) break;
+
+        if (!sm->batch_wait) {
+            gu::datetime::Date const abstime(gu::datetime::Date::calendar() +
+                                             sm->batch_delay);
+            abstime._timespec(deadline);
+        }
+
+        sm->batch_wait = true;
+        expired = (ETIMEDOUT ==
+                   gu_cond_timedwait (&sm->batch_cond, &sm->lock, &deadline));
+    }
+
+    sm->batch_wait = false;
+
+    return n;
+}
+
+/* Performs the jobs of the waiters next in the queue while the monitor is
+ * still entered. Each waiter is woken up as soon as its job is done. */
+static inline void
+_gcs_sm_combine (gcs_sm_t* sm)
+{
+    long combined(0);
+    gcs_sm_job_t* job;
+
+    while (combined < GCS_SM_COMBINE_MAX && NULL != (job = _gcs_sm_next_job(sm)))
+    {
+        gcs_sm_job_t* jobs[GCS_SM_COMBINE_MAX];
+        gu_cond_t*    conds[GCS_SM_COMBINE_MAX];
+        long          n(1);
+
+        if (NULL != job->batch && sm->batch_size > 0) {
+            n = _gcs_sm_take_batch (sm, jobs, conds,
+                                    GCS_SM_COMBINE_MAX - combined);
+            assert (n > 0);
+        }
+        else {
+            conds[0] = _gcs_sm_take_next_job (sm);
+            jobs[0]  = job;
+        }
+
+        gu_mutex_unlock (&sm->lock);
+        if (n > 1) {
+            jobs[0]->batch (jobs, n);
+        }
+        else {
+            jobs[0]->ret = jobs[0]->fn(jobs[0]->ctx);
+        }
+        if (gu_unlikely(gu_mutex_lock (&sm->lock))) abort();
+
+        for (long i(0); i < n; ++i) {
+            jobs[i]->done = true;
+            gu_cond_signal (conds[i]);
+        }
+
+        combined += n;
+    }
+}
+
+/*!
+ * Sets the maximum total size of a batch of jobs and the time to wait for
+ * the batch to fill up (see gcs_sm_job_t). Zero size disables batching.
+ */
+static inline void
+gcs_sm_set_batch (gcs_sm_t* sm, size_t size, long long delay_ns)
+{
+    if (gu_unlikely(gu_mutex_lock (&sm->lock))) abort();
+    sm->batch_size  = size;
+    sm->batch_delay = delay_ns;
+    gu_mutex_unlock (&sm->lock);
+}
+
 static inline void
 gcs_sm_leave (gcs_sm_t* sm)
 {
     if (gu_unlikely(gu_mutex_lock (&sm->lock))) abort();
 
     GCS_SM_ASSERT(sm->entered > 0);
+    _gcs_sm_combine(sm);
     sm->entered--;
     GCS_SM_ASSERT(sm->entered < GCS_SM_CC);
 
@@ -48,6 +48,8 @@
 #include <errno.h>
 #include <stdlib.h>
 #include <check.h>
+#include <string>
+#include <vector>
 
 #include "gcs_core_test.hpp"
 
@@ -747,6 +749,7 @@ START_TEST (gcs_core_test_gh74)
     frg.act_id = 1;
     frg.act_size = act_size;
     frg.act_type = GCS_ACT_STATE_REQ;
+    frg.aggr = false;
     char msg_buf[1024];
     ck_assert(!gcs_act_proto_write(&frg, msg_buf, sizeof(msg_buf)));
     memcpy(const_cast<void*>(frg.frag), act_ptr, act_size);
@@ -942,6 +945,184 @@ START_TEST (gcs_core_test_gh74)
 END_TEST
 #endif /* GCS_ALLOW_GH74 */
 
+// several actions sent in one message are received as separate ones
+START_TEST (gcs_core_test_aggr)
+{
+    gu::Config config;
+    core_test_init (&config);
+
+    long ret;
+    gcs_core_send_lock_step (Core, false);
+
+    ck_assert_msg(gcs_core_aggr_limit(Core) == FRAG_SIZE,
+                  "aggr limit: %ld, expected %zd",
+                  gcs_core_aggr_limit(Core), FRAG_SIZE);
+
+    const gcs_core_act_t acts[3] = {
+        { act1, sizeof(act1_str), GCS_ACT_TORDERED },
+        { act2, sizeof(act2_str), GCS_ACT_TORDERED },
+        { act3, sizeof(act3_str), GCS_ACT_TORDERED }
+    };
+    const char* const strs[3] = { act1_str, act2_str, act3_str };
+    size_t const total(sizeof(act1_str) + sizeof(act2_str) + sizeof(act3_str));
+
+    // does not fit in a single message
+    ret = gcs_core_send_aggr (Core, acts, 3);
+    ck_assert_msg(-EMSGSIZE == ret, "Expected -EMSGSIZE, got %ld (%s)",
+                  ret, strerror(-ret));
+
+    ck_assert(0 == core_test_set_payload_size (64));
+    ck_assert(64 == gcs_core_aggr_limit(Core));
+
+    ret = gcs_core_send_aggr (Core, acts, 3);
+    ck_assert_msg(ret == (long)total, "Expected %zu, got %ld (%s)",
+                  total, ret, strerror(-ret));
+
+    for (int i(0); i < 3; ++i) {
+        action_t act_r(acts[i].act, NULL, NULL, -1, (gcs_act_type_t)-1, -1,
+                       (gu_thread_t)-1);
+        ck_assert(!CORE_RECV_ACT (&act_r, strs[i], acts[i].act_size,
+                                  GCS_ACT_TORDERED));
+    }
+
+    // regular actions are not affected
+    ret = gcs_core_send (Core, act1, sizeof(act1_str), GCS_ACT_TORDERED);
+    ck_assert(ret == sizeof(act1_str));
+    action_t act_r(act1, NULL, NULL, -1, (gcs_act_type_t)-1, -1,
+                   (gu_thread_t)-1);
+    ck_assert(!CORE_RECV_ACT(&act_r, act1_str, sizeof(act1_str),
+                             GCS_ACT_TORDERED));
+
+    gcs_core_send_lock_step (Core, true);
+    core_test_cleanup ();
+}
+END_TEST
+
+static std::string
+core_test_status (const char* const key)
+{
+    gu::Status status;
+    gcs_core_get_status (Core, status);
+
+    for (gu::Status::const_iterator i(status.begin()); i != status.end(); ++i)
+    {
+        if (i->first == key) return i->second;
+    }
+
+    return "";
+}
+
+// with adaptive fragmentation action is split in equal fragments
+START_TEST (gcs_core_test_frag)
+{
+    gu::Config config;
+    core_test_init (&config);
+
+    long ret;
+    gcs_core_send_lock_step (Core, false);
+
+    ck_assert(0 == core_test_set_payload_size (3000));
+
+    std::vector<char> act_str(4000);
+    for (size_t i(0); i < act_str.size(); ++i) act_str[i] = i;
+    const struct gu_buf act[1] = { { &act_str[0], ssize_t(act_str.size()) } };
+
+    // one action fragment was sent by core_test_init()
+    std::string sizes(core_test_status("gcs_frag_sizes"));
+    ck_assert_msg(0 == sizes.find("1K:1, 2K:0, 4K:0,"), "%s", sizes.c_str());
+
+    // fixed fragments: 3000 + 1000
+    ret = gcs_core_send (Core, act, act_str.size(), GCS_ACT_TORDERED);
+    ck_assert_msg(ret == 4000, "Expected 4000, got %ld (%s)",
+                  ret, strerror(-ret));
+    action_t act_r(act, NULL, NULL, -1, (gcs_act_type_t)-1, -1,
+                   (gu_thread_t)-1);
+    ck_assert(!CORE_RECV_ACT(&act_r, &act_str[0], act_str.size(),
+                             GCS_ACT_TORDERED));
+
+    sizes = core_test_status("gcs_frag_sizes");
+    ck_assert_msg(0 == sizes.find("1K:2, 2K:0, 4K:1,"), "%s", sizes.c_str());
+
+    // adaptive fragments: 2000 + 2000
+    gcs_core_set_frag_time (Core, 1000000);
+
+    ret = gcs_core_send (Core, act, act_str.size(), GCS_ACT_TORDERED);
+    ck_assert_msg(ret == 4000, "Expected 4000, got %ld (%s)",
+                  ret, strerror(-ret));
+    ck_assert(!CORE_RECV_ACT(&act_r, &act_str[0], act_str.size(),
+                             GCS_ACT_TORDERED));
+
+    sizes = core_test_status("gcs_frag_sizes");
+    ck_assert_msg(0 == sizes.find("1K:2, 2K:2, 4K:1,"), "%s", sizes.c_str());
+
+    // action that fits in a single message is not split
+    ret = gcs_core_send (Core, act, 2500, GCS_ACT_TORDERED);
+    ck_assert(ret == 2500);
+    ck_assert(!CORE_RECV_ACT(&act_r, &act_str[0], 2500, GCS_ACT_TORDERED));
+
+    sizes = core_test_status("gcs_frag_sizes");
+    ck_assert_msg(0 == sizes.find("1K:2, 2K:2, 4K:2,"), "%s", sizes.c_str());
+
+    gcs_core_send_lock_step (Core, true);
+    core_test_cleanup ();
+}
+END_TEST
+
+// adaptive fragments shrink when own fragments are delivered slowly
+START_TEST (gcs_core_test_frag_rate)
+{
+    gu::Config config;
+    core_test_init (&config);
+
+    long   const tout(100); // 100 ms timeout
+    size_t const frag_size(3072);
+    long   ret;
+    long   frags;
+
+    ck_assert(0 == core_test_set_payload_size (frag_size));
+    gcs_core_set_frag_time (Core, 5000000); // 5 ms
+
+    std::vector<char> act_str(4 * frag_size);
+    for (size_t i(0); i < act_str.size(); ++i) act_str[i] = i;
+    const struct gu_buf act[1] = { { &act_str[0], ssize_t(act_str.size()) } };
+
+    action_t act_s(act, NULL, NULL, act_str.size(), GCS_ACT_TORDERED, -1,
+                   (gu_thread_t)-1);
+    action_t act_r(act, NULL, NULL, -1, (gcs_act_type_t)-1, -1,
+                   (gu_thread_t)-1);
+
+    // no rate measured yet: full size fragments, deliver one per 20 ms,
+    // that is at ~150Kb/s
+    ck_assert(!CORE_RECV_START (&act_r));
+    ck_assert(!CORE_SEND_START (&act_s));
+    for (frags = 0; (ret = gcs_core_send_step (Core, 3*tout)) > 0; frags++) {
+        usleep (20000);
+    }
+    ck_assert_msg(ret == 0, "gcs_core_send_step() returned: %ld (%s)",
+                  ret, strerror(-ret));
+    ck_assert_msg(4 == frags, "frags: %ld", frags);
+    ck_assert(!CORE_SEND_END (&act_s, act_str.size()));
+    ck_assert(!CORE_RECV_END (&act_r, &act_str[0], act_str.size(),
+                              GCS_ACT_TORDERED));
+
+    long long const rate(atoll(core_test_status("gcs_send_rate").c_str()));
+    ck_assert_msg(rate > 0 && rate < (long long)frag_size * 1000 / 5,
+                  "gcs_send_rate: %lld", rate);
+
+    // at that rate 5 ms is worth ~768 bytes (CORE_FRAG_MIN is 512 in tests)
+    ck_assert(!CORE_RECV_START (&act_r));
+    ck_assert(!CORE_SEND_START (&act_s));
+    for (frags = 0; (ret = gcs_core_send_step (Core, 3*tout)) > 0; frags++) {}
+    ck_assert_msg(ret == 0, "gcs_core_send_step() returned: %ld (%s)",
+                  ret, strerror(-ret));
+    ck_assert_msg(frags >= 8 && frags <= 24, "frags: %ld", frags);
+    ck_assert(!CORE_SEND_END (&act_s, act_str.size()));
+    ck_assert(!CORE_RECV_END (&act_r, &act_str[0], act_str.size(),
+                              GCS_ACT_TORDERED));
+
+    core_test_cleanup ();
+}
+END_TEST
 
 #if 0 // requires multinode support from gcs_dummy
 START_TEST (gcs_core_test_foreign)
@@ -971,6 +1152,9 @@ Suite *gcs_core_suite(void)
   if (skip == false) {
       tcase_add_test  (tcase, gcs_core_test_api);
       tcase_add_test  (tcase, gcs_core_test_own);
+      tcase_add_test  (tcase, gcs_core_test_aggr);
+      tcase_add_test  (tcase, gcs_core_test_frag);
+      tcase_add_test  (tcase, gcs_core_test_frag_rate);
 #ifdef GCS_ALLOW_GH74
       tcase_add_test  (tcase, gcs_core_test_gh74);
 #endif /* GCS_ALLOW_GH74 */
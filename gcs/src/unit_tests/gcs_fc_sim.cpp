@@ -0,0 +1,247 @@
+/*
+ * Copyright (C) 2021 Codership Oy <info@codership.com>
+ */
+
+/**
+ * Flow control simulation. Models a group where writesets from a number of
+ * closed-loop clients are ordered at the group rate and delivered to a slave
+ * whose apply rate oscillates between fast and slow. Compares commit latency
+ * distribution and throughput of the slave queue length STOP/CONT flow control
+ * with the rate-based one (gcs.fc_rate). FC messages take effect after a
+ * group round trip.
+ *
+ * Usage: gcs_fc_sim [clients [fc_limit [fc_factor [fc_delay_us
+ *                   [fast_rate [slow_rate [period_ms [duration_s]]]]]]]]
+ */
+
+#include "../gcs_fc.hpp"
+
+#include <galerautils.h>
+
+#include <algorithm>
+#include <deque>
+#include <iostream>
+#include <iomanip>
+#include <utility>
+#include <vector>
+#include <cstdlib>
+
+struct SimParams
+{
+    long      clients;
+    long      fc_limit;
+    double    fc_factor;
+    long long fc_delay;   // ns
+    double    group_rate; // act/s the group can order
+    double    fast_rate;  // act/s slave applies in fast phase
+    double    slow_rate;  // act/s slave applies in slow phase
+    long long period;     // ns, slave oscillation period
+    long long duration;   // ns
+};
+
+static long long const TICK(10000); // 10 us
+
+class FlowControlSim
+{
+public:
+
+    FlowControlSim(const SimParams& p, bool const rate)
+        :
+        p_         (p),
+        rate_      (rate),
+        upper_     (p.fc_limit),
+        lower_     (p.fc_limit * p.fc_factor + .5),
+        fc_        (),
+        fc_events_ (),
+        send_q_    (),
+        lat_       (),
+        now_       (0),
+        queue_len_ (0),
+        stop_count_(0),
+        stop_sent_ (false),
+        pulse_     (false),
+        pulse_end_ (0),
+        paused_    (0),
+        stops_     (0)
+    {
+        gcs_fc_rate_init(&fc_, lower_ < upper_ ? lower_ : upper_ / 2, upper_,
+                         now_);
+    }
+
+    void run()
+    {
+        double order_budget(0.0);
+        double apply_budget(0.0);
+
+        for (long i(0); i < p_.clients; ++i) send_q_.push_back(now_);
+
+        for (; now_ < p_.duration; now_ += TICK)
+        {
+            /* FC messages delivered in total order */
+            while (!fc_events_.empty() && fc_events_.front().first <= now_)
+            {
+                stop_count_ += fc_events_.front().second ? 1 : -1;
+                fc_events_.pop_front();
+            }
+
+            if (rate_ && pulse_ && now_ >= pulse_end_)
+            {
+                pulse_ = false;
+                if (queue_len_ <= upper_) send_fc(false);
+            }
+
+            /* ordering, paused while there are outstanding STOPs */
+            if (stop_count_ <= 0)
+            {
+                order_budget += p_.group_rate * TICK * 1.0e-9;
+
+                while (order_budget >= 1.0 && !send_q_.empty())
+                {
+                    order_budget -= 1.0;
+                    lat_.push_back(now_ - send_q_.front());
+                    send_q_.pop_front();
+                    send_q_.push_back(now_); // client issues next writeset
+                    enqueue();
+                }
+
+                if (send_q_.empty()) order_budget = 0.0;
+            }
+            else
+            {
+                paused_ += TICK;
+            }
+
+            /* applying */
+            bool const fast((now_ % p_.period) < p_.period / 2);
+            apply_budget += (fast ? p_.fast_rate : p_.slow_rate) *
+                TICK * 1.0e-9;
+
+            while (apply_budget >= 1.0 && queue_len_ > 0)
+            {
+                apply_budget -= 1.0;
+                dequeue();
+            }
+
+            if (0 == queue_len_ && apply_budget > 1.0) apply_budget = 1.0;
+        }
+    }
+
+    void print() const
+    {
+        std::vector<long long> lat(lat_);
+        std::sort(lat.begin(), lat.end());
+
+        size_t const n(lat.size());
+
+        std::cout << std::setw(6) << (rate_ ? "rate" : "queue")
+                  << ": " << std::fixed << std::setprecision(1)
+                  << n / (p_.duration * 1.0e-9) << " trx/s"
+                  << ", paused: " << paused_ * 100.0 / p_.duration << '%'
+                  << ", STOPs: " << stops_
+                  << ", latency (ms) p50: " << lat[n * 50 / 100] * 1.0e-6
+                  << ", p99: "   << lat[n * 99 / 100] * 1.0e-6
+                  << ", p99.9: " << lat[n * 999 / 1000] * 1.0e-6
+                  << ", max: "   << lat[n - 1] * 1.0e-6
+                  << std::endl;
+    }
+
+private:
+
+    void send_fc(bool const stop)
+    {
+        stop_sent_ = stop;
+        stops_    += stop;
+        fc_events_.push_back(std::make_pair(now_ + p_.fc_delay, stop));
+    }
+
+    void enqueue()
+    {
+        ++queue_len_;
+
+        if (queue_len_ > upper_ && !stop_sent_)
+        {
+            send_fc(true);
+        }
+        else if (rate_)
+        {
+            long long const pause(gcs_fc_rate_process(&fc_, queue_len_, now_));
+
+            if (pause > 0 && (!stop_sent_ || pulse_))
+            {
+                if (!stop_sent_) send_fc(true);
+                pulse_     = true;
+                pulse_end_ = std::max(pulse_end_, now_ + pause);
+            }
+        }
+    }
+
+    void dequeue()
+    {
+        --queue_len_;
+
+        gcs_fc_rate_applied(&fc_, queue_len_, now_);
+
+        if (pulse_ && 0 == queue_len_) pulse_ = false;
+
+        if (stop_sent_ && !pulse_ && queue_len_ <= lower_) send_fc(false);
+    }
+
+    FlowControlSim(const FlowControlSim&);
+    FlowControlSim& operator=(const FlowControlSim&);
+
+    const SimParams&                         p_;
+    bool const                               rate_;
+    long const                               upper_;
+    long const                               lower_;
+    gcs_fc_rate_t                            fc_;
+    std::deque<std::pair<long long, bool> >  fc_events_;
+    std::deque<long long>                    send_q_;
+    std::vector<long long>                   lat_;
+    long long                                now_;
+    long                                     queue_len_;
+    long                                     stop_count_;
+    bool                                     stop_sent_;
+    bool                                     pulse_;
+    long long                                pulse_end_;
+    long long                                paused_;
+    long                                     stops_;
+};
+
+int main(int argc, char* argv[])
+{
+    SimParams p;
+
+    p.clients    = argc > 1 ? ::atol(argv[1]) : 64;
+    p.fc_limit   = argc > 2 ? ::atol(argv[2]) : 16;
+    p.fc_factor  = argc > 3 ? ::atof(argv[3]) : 0.5;
+    p.fc_delay   = (argc > 4 ? ::atoll(argv[4]) : 500) * 1000;
+    p.fast_rate  = argc > 5 ? ::atof(argv[5]) : 20000.0;
+    p.slow_rate  = argc > 6 ? ::atof(argv[6]) : 2000.0;
+    p.period     = (argc > 7 ? ::atoll(argv[7]) : 1000) * 1000000;
+    p.duration   = (argc > 8 ? ::atoll(argv[8]) : 60) * 1000000000LL;
+    p.group_rate = 50000.0;
+
+    if (p.clients < 1 || p.fc_limit < 1 || p.fc_factor < 0.0 ||
+        p.fc_factor > 1.0 || p.fc_delay < 0 || p.slow_rate <= 0.0 ||
+        p.fast_rate <= 0.0 || p.period < TICK || p.duration < p.period)
+    {
+        std::cerr << "Bad simulation parameters" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Clients: " << p.clients << ", fc_limit: " << p.fc_limit
+              << ", fc_factor: " << p.fc_factor
+              << ", FC delay: " << p.fc_delay / 1000 << " us"
+              << ", slave apply rate: " << p.fast_rate << '/' << p.slow_rate
+              << " act/s every " << p.period / 2000000 << " ms" << std::endl;
+
+    FlowControlSim queue(p, false);
+    queue.run();
+    queue.print();
+
+    FlowControlSim rate(p, true);
+    rate.run();
+    rate.print();
+
+    return EXIT_SUCCESS;
+}
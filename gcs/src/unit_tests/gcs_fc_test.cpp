@@ -121,6 +121,61 @@ START_TEST(gcs_fc_test_precise)
 }
 END_TEST
 
+START_TEST(gcs_fc_test_rate)
+{
+    gcs_fc_rate_t fc;
+    long long now(0);
+    long long paused_until(0);
+    long      queue_len(4);
+    long      pauses(0);
+    long      max_len(0);
+    long      received(0);
+
+    gcs_fc_rate_init (&fc, 8, 16, now);
+
+    /* slave applies 1 action per ms. For the first 500 ms actions arrive at
+     * the same rate, then twice as fast unless replication is paused */
+    for (long ms(0); ms < 3000; ++ms, now += 1000000)
+    {
+        if (queue_len > 0)
+        {
+            --queue_len;
+            gcs_fc_rate_applied (&fc, queue_len, now);
+        }
+
+        int const arrivals(ms < 500 ? 1 : 2);
+
+        for (int i(0); i < arrivals && now >= paused_until; ++i)
+        {
+            ++queue_len;
+            ++received;
+
+            long long const pause(gcs_fc_rate_process(&fc, queue_len, now));
+
+            ck_assert_msg(pause >= 0 && pause <= 100000000,
+                          "Unexpected pause: %lld", pause);
+
+            if (pause > 0)
+            {
+                ck_assert_msg(ms >= 500, "Pause at %ld ms, queue length %ld",
+                              ms, queue_len);
+                paused_until = now + pause;
+                ++pauses;
+            }
+        }
+
+        if (queue_len > max_len) max_len = queue_len;
+    }
+
+    ck_assert(pauses > 0);
+    /* queue does not reach hard limit */
+    ck_assert_msg(max_len < 16, "Max queue length: %ld", max_len);
+    /* and replication rate is paced to apply rate */
+    ck_assert_msg(received > 2800 && received < 3100,
+                  "Actions received: %ld", received);
+}
+END_TEST
+
 Suite *gcs_fc_suite(void)
 {
     Suite *s  = suite_create("GCS state transfer FC");
@@ -130,6 +185,7 @@ Suite *gcs_fc_suite(void)
     tcase_add_test  (tc, gcs_fc_test_limits);
     tcase_add_test  (tc, gcs_fc_test_basic);
     tcase_add_test  (tc, gcs_fc_test_precise);
+    tcase_add_test  (tc, gcs_fc_test_rate);
 
     return s;
 }
@@ -570,6 +570,32 @@ START_TEST(test_gcs_group_find_donor)
                                  &empty_uuid, GCS_SEQNO_ILL);
     ck_assert(donor == 0);
 
+    // least loaded node is preferred: not in flow control, shortest lag
+    group.act_id_ = 100;
+    nodes[0].fc_stop = true;
+    donor = gcs_group_find_donor(&group, sv, joiner, SARGS(""),
+                                 &empty_uuid, GCS_SEQNO_ILL);
+    ck_assert(donor == 0); // not supported by the group protocol
+    group.quorum.gcs_proto_ver = GCS_ACT_PROTO_DONOR_LOAD_VER;
+    donor = gcs_group_find_donor(&group, sv, joiner, SARGS(""),
+                                 &empty_uuid, GCS_SEQNO_ILL);
+    ck_assert(donor == 1);
+    nodes[2].conf_last_applied = 50;
+    donor = gcs_group_find_donor(&group, sv, joiner, SARGS(""),
+                                 &empty_uuid, GCS_SEQNO_ILL);
+    ck_assert(donor == 2);
+    nodes[0].conf_last_applied = 90;
+    donor = gcs_group_find_donor(&group, sv, joiner, SARGS(""),
+                                 &empty_uuid, GCS_SEQNO_ILL);
+    ck_assert(donor == 2);
+    nodes[0].fc_stop = false;
+    donor = gcs_group_find_donor(&group, sv, joiner, SARGS(""),
+                                 &empty_uuid, GCS_SEQNO_ILL);
+    ck_assert(donor == 0);
+    nodes[0].conf_last_applied = GCS_SEQNO_ILL;
+    nodes[2].conf_last_applied = GCS_SEQNO_ILL;
+    group.act_id_ = 0;
+
     // ========== ist ==========
     // by name.
     donor = gcs_group_find_donor(&group, sv, joiner, SARGS("home0,home1,home2"),
@@ -586,6 +612,12 @@ START_TEST(test_gcs_group_find_donor)
                                  group_uuid, ist_seqno);
     ck_assert(donor == 1);
 
+    nodes[1].fc_stop = true; // in segment, least loaded.
+    donor = gcs_group_find_donor(&group, sv, joiner, SARGS("home2"),
+                                 group_uuid, ist_seqno);
+    ck_assert(donor == 0);
+    nodes[1].fc_stop = false;
+
     group.quorum.act_id = 1497; // in safe range. cross segment.
     nodes[0].status = GCS_NODE_STATE_JOINER;
     nodes[1].status = GCS_NODE_STATE_JOINER;
@@ -530,6 +530,203 @@ START_TEST (gcs_sm_test_interrupt)
 END_TEST
 
 
+static gu_thread_t combine_order[3];
+static volatile int combine_count;
+
+static long combine_job(void* arg)
+{
+    combine_order[combine_count++] = *(gu_thread_t*)arg;
+    return 42;
+}
+
+static long combine_batches;
+
+static void combine_batch(gcs_sm_job_t** jobs, long n)
+{
+    combine_batches++;
+    for (long i(0); i < n; ++i) {
+        combine_order[combine_count++] = *(gu_thread_t*)jobs[i]->ctx;
+        jobs[i]->ret = n;
+    }
+}
+
+struct combine_arg
+{
+    gcs_sm_t*   sm;
+    gu_thread_t self;
+    long        ret;
+    bool        batch;
+};
+
+static void* combine_thread(void* arg)
+{
+    struct combine_arg* const a = (struct combine_arg*)arg;
+
+    gu_cond_t cond;
+    gu_cond_init (&cond, NULL);
+
+    a->self = gu_thread_self();
+
+    gcs_sm_job_t job = { combine_job, a->batch ? combine_batch : NULL,
+                         &a->self, 40, 0, false, false };
+
+    a->ret = gcs_sm_enter (a->sm, &cond, false, true, &job);
+
+    if (0 == a->ret) {
+        a->ret = combine_job(&a->self);
+        gcs_sm_leave (a->sm);
+    }
+    else if (1 == a->ret) {
+        a->ret = job.ret;
+    }
+
+    gu_cond_destroy (&cond);
+
+    return NULL;
+}
+
+START_TEST (gcs_sm_test_combine)
+{
+    gcs_sm_t* sm = gcs_sm_create(4, 1);
+    ck_assert(sm != NULL);
+
+    gu_cond_t cond;
+    gu_cond_init (&cond, NULL);
+
+    combine_count = 0;
+
+    long ret = gcs_sm_enter (sm, &cond, false, true);
+    ck_assert(0 == ret);
+
+    gu_thread_t t1, t2;
+    struct combine_arg a1 = { sm, gu_thread_t(), -1, false };
+    struct combine_arg a2 = { sm, gu_thread_t(), -1, false };
+
+    gu_thread_create (&t1, NULL, combine_thread, &a1);
+    WAIT_FOR(2 == sm->users);
+    gu_thread_create (&t2, NULL, combine_thread, &a2);
+    WAIT_FOR(3 == sm->users);
+    ck_assert_msg(3 == sm->users, "users = %ld, expected 3", sm->users);
+
+    /* both queued jobs must be performed right here in FIFO order */
+    gcs_sm_leave (sm);
+
+    ck_assert_msg(2 == combine_count, "combined %d jobs, expected 2",
+                  combine_count);
+    ck_assert(gu_thread_equal(combine_order[0], a1.self));
+    ck_assert(gu_thread_equal(combine_order[1], a2.self));
+    ck_assert(0 == sm->users);
+    ck_assert(0 == sm->entered);
+
+    gu_thread_join (t1, NULL);
+    gu_thread_join (t2, NULL);
+    ck_assert_msg(42 == a1.ret, "a1.ret = %ld", a1.ret);
+    ck_assert_msg(42 == a2.ret, "a2.ret = %ld", a2.ret);
+
+    /* paused monitor hands over to the waiter instead */
+    ret = gcs_sm_enter (sm, &cond, false, true);
+    ck_assert(0 == ret);
+
+    gcs_sm_pause (sm);
+    gu_thread_create (&t1, NULL, combine_thread, &a1);
+    WAIT_FOR(2 == sm->users);
+    gcs_sm_leave (sm);
+    ck_assert(2 == combine_count);
+
+    gcs_sm_continue (sm);
+    gu_thread_join (t1, NULL);
+    ck_assert(3 == combine_count);
+    ck_assert(gu_thread_equal(combine_order[2], a1.self));
+    ck_assert_msg(42 == a1.ret, "a1.ret = %ld", a1.ret);
+
+    ret = gcs_sm_close(sm);
+    ck_assert(0 == ret);
+
+    gcs_sm_destroy(sm);
+    gu_cond_destroy(&cond);
+}
+END_TEST
+
+START_TEST (gcs_sm_test_batch)
+{
+    gcs_sm_t* sm = gcs_sm_create(8, 1);
+    ck_assert(sm != NULL);
+
+    gcs_sm_set_batch (sm, 100, 0); // fits two jobs of 40
+
+    gu_cond_t cond;
+    gu_cond_init (&cond, NULL);
+
+    combine_count   = 0;
+    combine_batches = 0;
+
+    long ret = gcs_sm_enter (sm, &cond, false, true);
+    ck_assert(0 == ret);
+
+    gu_thread_t t[3];
+    struct combine_arg a[3];
+
+    for (int i(0); i < 3; ++i) {
+        a[i].sm    = sm;
+        a[i].ret   = -1;
+        a[i].batch = true;
+        gu_thread_create (&t[i], NULL, combine_thread, &a[i]);
+        WAIT_FOR(i + 2 == sm->users);
+        ck_assert_msg(i + 2 == sm->users, "users = %ld, expected %d",
+                      sm->users, i + 2);
+    }
+
+    gcs_sm_leave (sm);
+
+    /* first two jobs are done in a batch, the third one alone */
+    ck_assert_msg(3 == combine_count, "performed %d jobs, expected 3",
+                  combine_count);
+    ck_assert_msg(1 == combine_batches, "batches: %ld, expected 1",
+                  combine_batches);
+    ck_assert(0 == sm->users);
+
+    for (int i(0); i < 3; ++i) {
+        gu_thread_join (t[i], NULL);
+        ck_assert(gu_thread_equal(combine_order[i], a[i].self));
+    }
+
+    ck_assert_msg(2 == a[0].ret, "a[0].ret = %ld", a[0].ret);
+    ck_assert_msg(2 == a[1].ret, "a[1].ret = %ld", a[1].ret);
+    ck_assert_msg(42 == a[2].ret, "a[2].ret = %ld", a[2].ret);
+
+    /* the batch waits for a job queued during the delay until it is full */
+    gcs_sm_set_batch (sm, 80, 5000000000LL); // 5 sec
+    combine_count   = 0;
+    combine_batches = 0;
+
+    ret = gcs_sm_enter (sm, &cond, false, true);
+    ck_assert(0 == ret);
+
+    gu_thread_create (&t[0], NULL, combine_thread, &a[0]);
+    WAIT_FOR(2 == sm->users);
+    gu_thread_create (&t[1], NULL, combine_thread, &a[1]);
+
+    long long const start(gu_time_monotonic());
+    gcs_sm_leave (sm);
+    long long const took(gu_time_monotonic() - start);
+
+    ck_assert_msg(1 == combine_batches, "batches: %ld, expected 1",
+                  combine_batches);
+    ck_assert_msg(took < 4000000000LL, "waited for %lld ns", took);
+
+    gu_thread_join (t[0], NULL);
+    gu_thread_join (t[1], NULL);
+    ck_assert_msg(2 == a[0].ret, "a[0].ret = %ld", a[0].ret);
+    ck_assert_msg(2 == a[1].ret, "a[1].ret = %ld", a[1].ret);
+
+    ret = gcs_sm_close(sm);
+    ck_assert(0 == ret);
+
+    gcs_sm_destroy(sm);
+    gu_cond_destroy(&cond);
+}
+END_TEST
+
 Suite *gcs_send_monitor_suite(void)
 {
   Suite *s  = suite_create("GCS send monitor");
@@ -541,6 +738,8 @@ Suite *gcs_send_monitor_suite(void)
   tcase_add_test  (tc, gcs_sm_test_close);
   tcase_add_test  (tc, gcs_sm_test_pause);
   tcase_add_test  (tc, gcs_sm_test_interrupt);
+  tcase_add_test  (tc, gcs_sm_test_combine);
+  tcase_add_test  (tc, gcs_sm_test_batch);
   return s;
 }
 